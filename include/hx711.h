@@ -23,10 +23,18 @@
 #ifndef HX711_H_0ED0E077_8980_484C_BB94_AF52973CDC09
 #define HX711_H_0ED0E077_8980_484C_BB94_AF52973CDC09
 
+#include <limits.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "hardware/pio.h"
 #include "pico/mutex.h"
+#include "hx711_calib.h"
+#include "hx711_decode.h"
+#include "hx711_glitch.h"
+#include "hx711_notch.h"
+#include "hx711_stability.h"
+#include "hx711_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,8 +57,24 @@ extern "C" {
 #define HX711_READ_BITS                 UINT8_C(24)
 #define HX711_POWER_DOWN_TIMEOUT        UINT8_C(60) //microseconds
 
-#define HX711_MIN_VALUE                 INT32_C(-0x800000) //−8,388,608
-#define HX711_MAX_VALUE                 INT32_C(0x7fffff) //8,388,607
+#define HX711_MIN_VALUE                 HX711_DECODE_MIN_VALUE //−8,388,608
+#define HX711_MAX_VALUE                 HX711_DECODE_MAX_VALUE //8,388,607
+
+/**
+ * @brief Maximum number of samples hx711_get_value_median and
+ * hx711_multi_get_values_median can take. Samples are kept on
+ * the stack (one int32_t per sample, per chip for
+ * hx711_multi_t), so keep this small.
+ */
+#ifndef HX711_MEDIAN_MAX_SAMPLES
+    #define HX711_MEDIAN_MAX_SAMPLES    UINT8_C(7)
+#endif
+
+/**
+ * @brief Value of rate_pin when the HX711's RATE pin is not
+ * connected to a GPIO (ie. the rate is fixed in hardware).
+ */
+#define HX711_NO_RATE_PIN               UINT_MAX
 
 #define HX711_PIO_MIN_GAIN              UINT8_C(0)
 #define HX711_PIO_MAX_GAIN              UINT8_C(2)
@@ -81,10 +105,22 @@ typedef struct {
     uint _reader_sm;
     uint _reader_offset;
 
+    uint _rate_pin;
+    hx711_rate_t _rate;
+    hx711_rate_t _auto_rate;
+    hx711_stability_t* _stability;
+
+    hx711_glitch_t* _glitch;
+    hx711_notch_t* _notch;
+
 #ifndef HX711_NO_MUTEX
     mutex_t _mut;
 #endif
 
+#ifdef HX711_STATS
+    hx711_stats_t _stats;
+#endif
+
 } hx711_t;
 
 typedef void (*hx711_pio_init_t)(hx711_t* const);
@@ -95,6 +131,13 @@ typedef struct {
     uint clock_pin;
     uint data_pin;
 
+    /**
+     * @brief GPIO connected to the RATE pin, or
+     * HX711_NO_RATE_PIN. When connected, the chip starts at
+     * hx711_rate_10.
+     */
+    uint rate_pin;
+
     PIO pio;
     hx711_pio_init_t pio_init;
 
@@ -126,12 +169,29 @@ void hx711_set_gain(
 
 /**
  * @brief Convert a raw value from the HX711 to a 32-bit signed int.
+ * Only the lower 24 bits of raw are used; bits above them are
+ * ignored.
  * 
  * @param raw 
  * @return int32_t 
  */
 int32_t hx711_get_twos_comp(const uint32_t raw);
 
+/**
+ * @brief Convert an array of raw values from the HX711 to
+ * 32-bit signed ints. Bits above the lower 24 are ignored, as
+ * with hx711_get_twos_comp. hx711_get_value_median uses this
+ * on its samples.
+ * 
+ * @param raw 
+ * @param out may be the same memory as raw
+ * @param n number of values to convert
+ */
+void hx711_get_twos_comp_batch(
+    const uint32_t* const raw,
+    int32_t* const out,
+    const size_t n);
+
 /**
  * @brief Returns true if the HX711 is saturated at its
  * minimum level.
@@ -214,6 +274,166 @@ bool hx711_get_value_noblock(
     hx711_t* const hx,
     int32_t* const val);
 
+/**
+ * @brief Change the sample rate using the RATE pin, then wait
+ * for the HX711's settling time at the new rate and discard
+ * any values obtained in the meantime. An attached notch
+ * filter is initialised again for the new rate and its mains
+ * setting, and an attached glitch filter is reset. Requires
+ * rate_pin to be configured.
+ * 
+ * @param hx 
+ * @param rate 
+ */
+void hx711_set_rate(
+    hx711_t* const hx,
+    const hx711_rate_t rate);
+
+/**
+ * @brief Returns the current sample rate. Without a rate pin
+ * this is always hx711_rate_10.
+ * 
+ * @param hx 
+ * @return hx711_rate_t 
+ */
+hx711_rate_t hx711_get_rate(hx711_t* const hx);
+
+/**
+ * @brief Switch rate automatically based on a stability
+ * detector fed with every value obtained from now on. While
+ * the load is changing the rate is 80 SPS for a fast
+ * response, and once stable it drops to 10 SPS for lower
+ * noise. The detector is seeded from the current rate, so it
+ * starts out stable at 10 SPS.
+ * 
+ * A switch waits out the settling time (see hx711_set_rate),
+ * so it is only made by the blocking reads (hx711_get_value,
+ * hx711_get_value_avg and hx711_get_value_median) or by
+ * hx711_apply_auto_rate. hx711_get_value_timeout and
+ * hx711_get_value_noblock only record that one is due.
+ * Requires rate_pin to be configured.
+ * 
+ * @param hx 
+ * @param s initialised detector, or NULL to stop switching
+ */
+void hx711_set_auto_rate(
+    hx711_t* const hx,
+    hx711_stability_t* const s);
+
+/**
+ * @brief Make a rate switch which the auto rate detector has
+ * asked for since the last one, waiting out the settling
+ * time. Does nothing if none is due.
+ * 
+ * @param hx 
+ * @return true if the rate was changed
+ * @return false 
+ */
+bool hx711_apply_auto_rate(hx711_t* const hx);
+
+/**
+ * @brief Pass every value obtained from now on through a
+ * glitch filter. Read functions then return the filtered
+ * value, and hx711_glitch_get_quality gives its quality.
+ * 
+ * @param hx 
+ * @param g initialised filter, or NULL to stop filtering
+ */
+void hx711_set_glitch_filter(
+    hx711_t* const hx,
+    hx711_glitch_t* const g);
+
+/**
+ * @brief Pass every value obtained from now on through a
+ * mains hum filter, after any glitch filter.
+ * 
+ * @param hx 
+ * @param n initialised filter, or NULL to stop filtering
+ */
+void hx711_set_notch_filter(
+    hx711_t* const hx,
+    hx711_notch_t* const n);
+
+/**
+ * @brief Obtain the mean of n values. The mutex is held for
+ * the duration so the values are consecutive, and only a
+ * running sum is kept.
+ * 
+ * @param hx 
+ * @param n number of values, at least 1
+ * @return int32_t 
+ */
+int32_t hx711_get_value_avg(
+    hx711_t* const hx,
+    const uint n);
+
+/**
+ * @brief Obtain the median of n values. The mutex is held for
+ * the duration so the values are consecutive. Each value is
+ * inserted into a sorted buffer as it arrives.
+ * 
+ * @param hx 
+ * @param n number of values, between 1 and
+ * HX711_MEDIAN_MAX_SAMPLES
+ * @return int32_t 
+ */
+int32_t hx711_get_value_median(
+    hx711_t* const hx,
+    const uint n);
+
+/**
+ * @brief Average samples values with no load applied and use
+ * the result as the calibration offset. The scale and
+ * timestamp of calib are left unchanged.
+ * 
+ * @param hx 
+ * @param samples number of values to average, at least 1
+ * @param calib 
+ */
+void hx711_tare(
+    hx711_t* const hx,
+    const uint samples,
+    hx711_calib_t* const calib);
+
+/**
+ * @brief Average samples values with a known mass applied and
+ * derive the calibration scale from the existing offset, so
+ * hx711_tare must be called first. The timestamp of calib is
+ * left unchanged.
+ * 
+ * @param hx 
+ * @param samples number of values to average, at least 1
+ * @param known_mass mass applied, in the unit readings should
+ * be converted to; must be greater than 0
+ * @param calib 
+ * @return true if the scale was updated
+ * @return false if the mass made no difference to the value
+ */
+bool hx711_calibrate(
+    hx711_t* const hx,
+    const uint samples,
+    const float known_mass,
+    hx711_calib_t* const calib);
+
+#ifdef HX711_STATS
+/**
+ * @brief Copy the current read counters into stats.
+ * 
+ * @param hx 
+ * @param stats 
+ */
+void hx711_get_stats(
+    hx711_t* const hx,
+    hx711_stats_t* const stats);
+
+/**
+ * @brief Reset all read counters to 0.
+ * 
+ * @param hx 
+ */
+void hx711_reset_stats(hx711_t* const hx);
+#endif
+
 /**
  * @brief Check whether the hx struct has been initalised.
  * 
@@ -334,6 +554,52 @@ static bool hx711__try_get_value(
     const uint sm,
     uint32_t* const val);
 
+/**
+ * @brief Change the rate without taking the mutex.
+ * 
+ * @param hx 
+ * @param rate 
+ */
+static void hx711__set_rate(
+    hx711_t* const hx,
+    const hx711_rate_t rate);
+
+/**
+ * @brief Run a value which has just been obtained through
+ * the read counters and any filters attached to hx, and feed
+ * it to the auto rate detector. This never blocks; a rate
+ * switch is only recorded in _auto_rate.
+ * 
+ * @param hx 
+ * @param val 
+ */
+static void hx711__process_value(
+    hx711_t* const hx,
+    int32_t* const val);
+
+/**
+ * @brief Switch to _auto_rate if it differs from the current
+ * rate, without taking the mutex.
+ * 
+ * @param hx 
+ * @return true if the rate was changed
+ * @return false 
+ */
+static bool hx711__apply_auto_rate(hx711_t* const hx);
+
+#ifdef HX711_STATS
+/**
+ * @brief Update the read counters with a value which has
+ * just been obtained.
+ * 
+ * @param hx 
+ * @param val 
+ */
+static void hx711__stats_record(
+    hx711_t* const hx,
+    const int32_t val);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,177 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_ALARM_H_A09F9EC8_781A_4F6E_BF26_C4985A9C19A7
+#define HX711_ALARM_H_A09F9EC8_781A_4F6E_BF26_C4985A9C19A7
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HX711_ALARM_NO_PIN UINT_MAX
+
+#define HX711_ALARM_STATE_NONE  UINT8_C(0)
+#define HX711_ALARM_STATE_HIGH  UINT8_C(1)
+#define HX711_ALARM_STATE_LOW   UINT8_C(2)
+
+typedef struct {
+
+    /**
+     * @brief Raw value at or above which the high alarm trips.
+     * HX711_MAX_VALUE + 1 (or more) disables it.
+     */
+    int32_t high;
+
+    /**
+     * @brief Raw value at or below which the low alarm trips.
+     * HX711_MIN_VALUE - 1 (or less) disables it.
+     */
+    int32_t low;
+
+    /**
+     * @brief How far back past its threshold a value must go
+     * before an alarm clears.
+     */
+    int32_t hysteresis;
+
+    /**
+     * @brief GPIO driven while the alarm is tripped, or
+     * HX711_ALARM_NO_PIN.
+     */
+    uint pin;
+
+    /**
+     * @brief Whether pin is driven high (true) or low (false)
+     * while tripped.
+     */
+    bool active_high;
+
+} hx711_alarm_config_t;
+
+/**
+ * @brief High/low threshold alarm on raw values with
+ * hysteresis.
+ * 
+ * Attached to a hx711_multi_t (see hx711_multi_set_alarms),
+ * alarms are checked from the DMA IRQ handler as soon as a
+ * frame arrives, so the pin changes within microseconds of
+ * the conversion finishing rather than whenever the
+ * application next reads a value.
+ */
+typedef struct {
+    int32_t _high;
+    int32_t _low;
+    int32_t _hysteresis;
+    uint _pin;
+    bool _active_high;
+    volatile uint8_t _state;
+    volatile uint32_t _trips;
+} hx711_alarm_t;
+
+/**
+ * @brief Fill config with defaults: both alarms disabled, a
+ * hysteresis of 1000, no pin and active high.
+ * 
+ * @param config 
+ */
+void hx711_alarm_get_default_config(hx711_alarm_config_t* const config);
+
+/**
+ * @brief Initialise an alarm. If a pin is given it is set up
+ * as an output in its inactive state.
+ * 
+ * @param a 
+ * @param config 
+ */
+void hx711_alarm_init(
+    hx711_alarm_t* const a,
+    const hx711_alarm_config_t* const config);
+
+/**
+ * @brief Clear the alarm and its trip count and drive the pin
+ * inactive.
+ * 
+ * @param a 
+ */
+void hx711_alarm_reset(hx711_alarm_t* const a);
+
+/**
+ * @brief Check a value against the alarm, updating its state
+ * and pin.
+ * 
+ * @param a 
+ * @param val 
+ * @return uint8_t HX711_ALARM_STATE_*
+ */
+uint8_t hx711_alarm_update(
+    hx711_alarm_t* const a,
+    const int32_t val);
+
+/**
+ * @brief hx711_alarm_update for one alarm per value.
+ * 
+ * @param as 
+ * @param values 
+ * @param len 
+ * @return true if any alarm is tripped
+ * @return false 
+ */
+bool hx711_alarm_update_multi(
+    hx711_alarm_t* const as,
+    const int32_t* const values,
+    const size_t len);
+
+/**
+ * @brief Returns the state as of the last value.
+ * 
+ * @param a 
+ * @return uint8_t HX711_ALARM_STATE_*
+ */
+uint8_t hx711_alarm_get_state(const hx711_alarm_t* const a);
+
+/**
+ * @brief Number of times the alarm has tripped since it was
+ * initialised or reset.
+ * 
+ * @param a 
+ * @return uint32_t 
+ */
+uint32_t hx711_alarm_get_trips(const hx711_alarm_t* const a);
+
+/**
+ * @brief Drive the pin (if any) to match the state.
+ * 
+ * @param a 
+ */
+static void hx711_alarm__drive(const hx711_alarm_t* const a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,240 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_CALIB_H_21570754_B038_4F5C_9171_47205BD45EB6
+#define HX711_CALIB_H_21570754_B038_4F5C_9171_47205BD45EB6
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hx711_flash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of chips a calibration store can hold
+ * a record for. Chip indices are [0, HX711_CALIB_MAX_CHIPS).
+ */
+#define HX711_CALIB_MAX_CHIPS           UINT8_C(32)
+
+/**
+ * @brief Identifies a valid slot in flash ("HXCL").
+ */
+#define HX711_CALIB_MAGIC               UINT32_C(0x4c435848)
+
+/**
+ * @brief Calibration for a single chip. A reading in the
+ * chosen unit of mass is (raw - offset) / scale.
+ */
+typedef struct {
+
+    /**
+     * @brief Raw value with no load applied.
+     */
+    int32_t offset;
+
+    /**
+     * @brief Raw counts per unit of mass.
+     */
+    float scale;
+
+    /**
+     * @brief Set by the application when calibrating (eg.
+     * seconds since the epoch). Stored but not interpreted.
+     */
+    uint32_t timestamp;
+
+} hx711_calib_t;
+
+/**
+ * @brief On-flash layout of a calibration record (little
+ * endian, 32 bytes). crc covers every preceding byte.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint8_t chip;
+    uint8_t reserved[3];
+    int32_t offset;
+    float scale;
+    uint32_t timestamp;
+    uint32_t reserved2;
+    uint32_t crc;
+} hx711_calib_record_t;
+
+/**
+ * @brief Calibration records in two flash sectors.
+ * 
+ * Each save appends a record to the active sector. When it
+ * is full, the latest record for each chip is copied to the
+ * other sector, which then becomes active. Loading takes the
+ * record with the highest sequence number for a chip across
+ * both sectors, so an interrupted save or copy never loses
+ * the previous calibration.
+ */
+typedef struct {
+    hx711_flash_t* _flash;
+    size_t _offset;
+    uint32_t _seq;
+    uint8_t _active;
+    size_t _next;
+} hx711_calib_store_t;
+
+/**
+ * @brief Convert a raw value using a calibration.
+ * 
+ * @param calib 
+ * @param raw 
+ * @return float 
+ */
+float hx711_calib_apply(
+    const hx711_calib_t* const calib,
+    const int32_t raw);
+
+/**
+ * @brief Convert len raw values, each with its own
+ * calibration, eg. the output of hx711_multi_get_values.
+ * 
+ * @param calibs 
+ * @param raw 
+ * @param out 
+ * @param len 
+ */
+void hx711_calib_apply_multi(
+    const hx711_calib_t* const calibs,
+    const int32_t* const raw,
+    float* const out,
+    const size_t len);
+
+/**
+ * @brief Open a store in the two consecutive sectors
+ * beginning at offset, which must be sector aligned. Existing
+ * records are scanned to find where to continue appending.
+ * 
+ * @param store 
+ * @param flash 
+ * @param offset 
+ * @return true if the flash could be read
+ * @return false 
+ */
+bool hx711_calib_store_init(
+    hx711_calib_store_t* const store,
+    hx711_flash_t* const flash,
+    const size_t offset);
+
+/**
+ * @brief Load the latest calibration for a chip.
+ * 
+ * @param store 
+ * @param chip 
+ * @param calib 
+ * @return true if a valid record was found
+ * @return false 
+ */
+bool hx711_calib_store_load(
+    hx711_calib_store_t* const store,
+    const uint8_t chip,
+    hx711_calib_t* const calib);
+
+/**
+ * @brief Append a calibration for a chip.
+ * 
+ * @param store 
+ * @param chip 
+ * @param calib 
+ * @return true if the record was written and read back
+ * @return false 
+ */
+bool hx711_calib_store_save(
+    hx711_calib_store_t* const store,
+    const uint8_t chip,
+    const hx711_calib_t* const calib);
+
+/**
+ * @brief Offset of the nth slot of a sector.
+ * 
+ * @param store 
+ * @param sector 
+ * @param slot 
+ * @return size_t 
+ */
+static size_t hx711_calib__slot_offset(
+    const hx711_calib_store_t* const store,
+    const uint8_t sector,
+    const size_t slot);
+
+/**
+ * @brief Check whether a slot has never been programmed.
+ * 
+ * @param rec 
+ * @return true 
+ * @return false 
+ */
+static bool hx711_calib__is_blank(const hx711_calib_record_t* const rec);
+
+/**
+ * @brief Read a slot and check its magic and CRC.
+ * 
+ * @param store 
+ * @param sector 
+ * @param slot 
+ * @param rec 
+ * @return true if the slot holds a valid record
+ * @return false 
+ */
+static bool hx711_calib__read_slot(
+    const hx711_calib_store_t* const store,
+    const uint8_t sector,
+    const size_t slot,
+    hx711_calib_record_t* const rec);
+
+/**
+ * @brief Copy the latest record for each chip to the inactive
+ * sector and make it active.
+ * 
+ * @param store 
+ * @return true 
+ * @return false 
+ */
+static bool hx711_calib__compact(hx711_calib_store_t* const store);
+
+/**
+ * @brief Write a record to the next slot of the active sector.
+ * 
+ * @param store 
+ * @param chip 
+ * @param calib 
+ * @return true 
+ * @return false 
+ */
+static bool hx711_calib__append(
+    hx711_calib_store_t* const store,
+    const uint8_t chip,
+    const hx711_calib_t* const calib);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,246 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_CAPTURE_H_9F194CA1_085B_4A34_9906_C3F9A40F3DEC
+#define HX711_CAPTURE_H_9F194CA1_085B_4A34_9906_C3F9A40F3DEC
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hx711_multi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HX711_CAPTURE_STATE_IDLE = 0,
+    HX711_CAPTURE_STATE_ARMED,
+    HX711_CAPTURE_STATE_TRIGGERED,
+    HX711_CAPTURE_STATE_DONE
+} hx711_capture_state_t;
+
+typedef enum {
+
+    /**
+     * @brief Trigger when the value crosses level.
+     */
+    hx711_capture_trigger_level = 0,
+
+    /**
+     * @brief Trigger when the value changes by at least level
+     * from one frame to the next.
+     */
+    hx711_capture_trigger_slope
+
+} hx711_capture_trigger_t;
+
+typedef enum {
+    hx711_capture_edge_rising = 0,
+    hx711_capture_edge_falling
+} hx711_capture_edge_t;
+
+typedef enum {
+
+    /**
+     * @brief Trigger on any chip meeting the condition.
+     */
+    hx711_capture_source_any = 0,
+
+    /**
+     * @brief Trigger on the sum of all chips.
+     */
+    hx711_capture_source_sum,
+
+    /**
+     * @brief Trigger on a single chip.
+     */
+    hx711_capture_source_chip
+
+} hx711_capture_source_t;
+
+typedef struct {
+
+    hx711_capture_trigger_t trigger;
+    hx711_capture_edge_t edge;
+    hx711_capture_source_t source;
+
+    /**
+     * @brief Chip index when source is hx711_capture_source_chip.
+     */
+    uint chip;
+
+    /**
+     * @brief Crossing level, or minimum change per frame for a
+     * slope trigger (always positive; edge gives the
+     * direction).
+     */
+    int32_t level;
+
+    /**
+     * @brief Number of frames to keep from before the trigger.
+     */
+    size_t pre_frames;
+
+    /**
+     * @brief Number of frames to keep from the trigger onwards,
+     * at least 1 (the triggering frame).
+     */
+    size_t post_frames;
+
+} hx711_capture_config_t;
+
+/**
+ * @brief Oscilloscope-style capture of hx711_multi_t frames.
+ * 
+ * Runs a continuous read, decoding each frame into a ring
+ * buffer of pre_frames + post_frames frames from the DMA IRQ
+ * handler and checking the trigger there, so no frame is
+ * missed. Once post_frames frames have been captured after
+ * the trigger the read stops and the buffer is frozen.
+ */
+typedef struct {
+    hx711_multi_t* _hxm;
+    hx711_capture_config_t _config;
+    int32_t* _buffer;
+    size_t _frames_len;
+    size_t _head;
+    size_t _seen;
+    size_t _post;
+    size_t _pre_count;
+    volatile hx711_capture_state_t _state;
+} hx711_capture_t;
+
+/**
+ * @brief Fill config with defaults: a rising level trigger at
+ * 0 on any chip, with 16 frames either side.
+ * 
+ * @param config 
+ */
+void hx711_capture_get_default_config(hx711_capture_config_t* const config);
+
+/**
+ * @brief Set up a capture.
+ * 
+ * @param cap 
+ * @param hxm initialised hx711_multi_t with its chips powered up
+ * @param config 
+ * @param buffer space for (pre_frames + post_frames) * chips_len
+ * values
+ * @param len number of values buffer can hold
+ */
+void hx711_capture_init(
+    hx711_capture_t* const cap,
+    hx711_multi_t* const hxm,
+    const hx711_capture_config_t* const config,
+    int32_t* const buffer,
+    const size_t len);
+
+/**
+ * @brief Arm the trigger and start reading. hxm is unavailable
+ * for other reads until the capture is done or stopped.
+ * 
+ * @param cap 
+ */
+void hx711_capture_start(hx711_capture_t* const cap);
+
+/**
+ * @brief Stop reading without waiting for a trigger.
+ * 
+ * @param cap 
+ */
+void hx711_capture_stop(hx711_capture_t* const cap);
+
+/**
+ * @brief Returns the current state.
+ * 
+ * @param cap 
+ * @return hx711_capture_state_t 
+ */
+hx711_capture_state_t hx711_capture_get_state(const hx711_capture_t* const cap);
+
+/**
+ * @brief Number of frames held by a finished capture. This is
+ * less than pre_frames + post_frames if the trigger came
+ * before pre_frames frames had been read.
+ * 
+ * @param cap 
+ * @return size_t 
+ */
+size_t hx711_capture_get_frames_len(const hx711_capture_t* const cap);
+
+/**
+ * @brief Index of the triggering frame.
+ * 
+ * @param cap 
+ * @return size_t 
+ */
+size_t hx711_capture_get_trigger_index(const hx711_capture_t* const cap);
+
+/**
+ * @brief Values of the nth frame of a finished capture in
+ * order of arrival; one per chip.
+ * 
+ * @param cap 
+ * @param n less than hx711_capture_get_frames_len
+ * @return const int32_t* 
+ */
+const int32_t* hx711_capture_get_frame(
+    const hx711_capture_t* const cap,
+    const size_t n);
+
+/**
+ * @brief Frame callback run from the DMA IRQ handler.
+ * 
+ * @param hxm 
+ * @param frame 
+ * @param values 
+ * @param ctx the hx711_capture_t
+ * @return true 
+ * @return false 
+ */
+static bool hx711_capture__on_frame(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx);
+
+/**
+ * @brief Check the trigger condition between two consecutive
+ * frames.
+ * 
+ * @param cap 
+ * @param prev 
+ * @param cur 
+ * @return true 
+ * @return false 
+ */
+static bool hx711_capture__is_triggered(
+    const hx711_capture_t* const cap,
+    const int32_t* const prev,
+    const int32_t* const cur);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
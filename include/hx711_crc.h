@@ -0,0 +1,69 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_CRC_H_15B3DE02_2954_4722_90D7_E42750ECD77F
+#define HX711_CRC_H_15B3DE02_2954_4722_90D7_E42750ECD77F
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initial value to pass to hx711_crc32_update.
+ */
+#define HX711_CRC32_INIT                UINT32_C(0xffffffff)
+
+/**
+ * @brief Continue a CRC-32 (IEEE 802.3, reflected) over len
+ * bytes. Start with HX711_CRC32_INIT and finish by inverting
+ * the result, or use hx711_crc32 for a single buffer.
+ * 
+ * @param crc 
+ * @param data 
+ * @param len 
+ * @return uint32_t 
+ */
+uint32_t hx711_crc32_update(
+    uint32_t crc,
+    const void* const data,
+    const size_t len);
+
+/**
+ * @brief CRC-32 of a single buffer. This is the same CRC used
+ * by zlib, so it can be checked on a host with standard tools.
+ * 
+ * @param data 
+ * @param len 
+ * @return uint32_t 
+ */
+uint32_t hx711_crc32(
+    const void* const data,
+    const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_DECODE_H_FE32676A_A545_451F_A4DE_3653F0C3D5B8
+#define HX711_DECODE_H_FE32676A_A545_451F_A4DE_3653F0C3D5B8
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The decode hot path with no Pico SDK dependencies, so the
+ * exact code the library runs can also be built and timed on
+ * a PC (see tools/hx711_decode_bench.c). Use
+ * hx711_get_twos_comp, hx711_get_twos_comp_batch,
+ * hx711_multi_pinvals_to_values or HX711_MULTI_PINVALS_TO_VALUES
+ * in applications.
+ */
+
+/**
+ * @brief Same as HX711_READ_BITS.
+ */
+#define HX711_DECODE_BITS               UINT8_C(24)
+
+/**
+ * @brief Same as HX711_MIN_VALUE and HX711_MAX_VALUE, for
+ * modules which build without the Pico SDK.
+ */
+#define HX711_DECODE_MIN_VALUE          INT32_C(-0x800000) //−8,388,608
+#define HX711_DECODE_MAX_VALUE          INT32_C(0x7fffff) //8,388,607
+
+/**
+ * @brief Sign-extend the lower 24 bits of a raw HX711 value to
+ * an int32_t. Bits above the 24th are ignored. This relies on
+ * right shifts of negative values being arithmetic, which GCC
+ * guarantees.
+ */
+#define HX711_SIGN_EXTEND(raw) \
+    ((int32_t)((uint32_t)(raw) << (32 - HX711_DECODE_BITS)) >> (32 - HX711_DECODE_BITS))
+
+#if defined(__GNUC__)
+    #define HX711_DECODE_INLINE static inline __attribute__((always_inline))
+#else
+    #define HX711_DECODE_INLINE static inline
+#endif
+
+/**
+ * @brief Body of hx711_get_twos_comp_batch.
+ * 
+ * @param raw 
+ * @param out 
+ * @param n 
+ */
+HX711_DECODE_INLINE void hx711_decode_twos_comp_batch(
+    const uint32_t* const raw,
+    int32_t* const out,
+    const size_t n) {
+
+        //two shifts per value and no branches; reading and
+        //writing through the same index keeps in-place
+        //conversion safe
+        for(size_t i = 0; i < n; ++i) {
+            out[i] = HX711_SIGN_EXTEND(raw[i]);
+        }
+
+}
+
+/**
+ * @brief Body of hx711_multi_pinvals_to_values and the fixed
+ * chip count decoders. When len is a compile-time constant
+ * both loops are fully unrolled.
+ * 
+ * @param pinvals 
+ * @param values 
+ * @param len 
+ */
+HX711_DECODE_INLINE void hx711_decode_pinvals(
+    const uint32_t* const pinvals,
+    int32_t* const values,
+    const size_t len) {
+
+        _Pragma("GCC unroll 32")
+        for(size_t chipNum = 0; chipNum < len; ++chipNum) {
+
+            uint32_t rawVal = 0;
+
+            //pinvals[0] holds the MSB for every chip
+            _Pragma("GCC unroll 24")
+            for(size_t bitPos = 0; bitPos < HX711_DECODE_BITS; ++bitPos) {
+                rawVal = (rawVal << 1) | ((pinvals[bitPos] >> chipNum) & 1);
+            }
+
+            //same conversion as hx711_get_twos_comp_batch,
+            //but without the call
+            values[chipNum] = HX711_SIGN_EXTEND(rawVal);
+
+        }
+
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
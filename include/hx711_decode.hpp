@@ -0,0 +1,72 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_DECODE_HPP_65BC88C3_B572_458F_84D0_94C05A1DF0E7
+#define HX711_DECODE_HPP_65BC88C3_B572_458F_84D0_94C05A1DF0E7
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "hx711_decode.h"
+
+namespace hx711 {
+
+/**
+ * @brief Words in a raw hx711_multi_t frame; one per bit of a
+ * conversion, most significant first.
+ */
+inline constexpr std::size_t frame_words = HX711_DECODE_BITS;
+
+/**
+ * @brief Values of N chips, one per chip.
+ */
+template<std::size_t N>
+using Frame = std::array<std::int32_t, N>;
+
+/**
+ * @brief A raw frame as the PIO and DMA produce it.
+ */
+using RawFrame = std::span<const std::uint32_t, frame_words>;
+
+/**
+ * @brief Decode a raw frame of N chips. N is a compile-time
+ * constant, so this is the fully unrolled decoder of
+ * HX711_MULTI_DEFINE_PINVALS_TO_VALUES(N), inlined into the
+ * caller. No Pico SDK headers are needed, so it can be built
+ * on a PC.
+ * 
+ * @tparam N number of chips
+ * @param pinvals 
+ * @return Frame<N> 
+ */
+template<std::size_t N>
+[[gnu::always_inline]] inline Frame<N> decode(const RawFrame pinvals) noexcept {
+    static_assert(N >= 1 && N <= 32, "chip count out of range");
+    Frame<N> values;
+    hx711_decode_pinvals(pinvals.data(), values.data(), N);
+    return values;
+}
+
+}
+
+#endif
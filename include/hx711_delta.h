@@ -0,0 +1,202 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_DELTA_H_76D6F356_7E73_488E_AD88_C6AE6919A5D4
+#define HX711_DELTA_H_76D6F356_7E73_488E_AD88_C6AE6919A5D4
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most values per frame.
+ */
+#define HX711_DELTA_MAX_CHIPS           UINT8_C(32)
+
+/**
+ * @brief First byte of a frame holding whole values, which
+ * can be decoded without any earlier frame.
+ */
+#define HX711_DELTA_FRAME_KEY           UINT8_C(0x4b)
+
+/**
+ * @brief First byte of a frame holding differences from the
+ * previous frame.
+ */
+#define HX711_DELTA_FRAME_DIFF          UINT8_C(0x44)
+
+/**
+ * @brief Most bytes an encoded frame of len values can take:
+ * the type byte, the sequence byte and a varint of up to 5
+ * bytes per value.
+ */
+#define HX711_DELTA_ENCODED_MAX(len)    (2 + 5 * (len))
+
+/**
+ * @brief Frame-to-frame compressor for the values of one or
+ * more chips.
+ * 
+ * Each value is stored as the difference from the same chip's
+ * value in the previous frame, zig-zag mapped so small
+ * negative differences are small numbers too, then written as
+ * a varint (7 bits per byte, least significant first, top bit
+ * set on all but the last byte). A steady load with a few
+ * counts of noise needs one byte per value rather than three.
+ * 
+ * Every resync_interval frames (and the first) is a key frame
+ * holding whole values instead, so a reader can start, or
+ * recover from a lost frame, without the whole history.
+ * 
+ * Each frame carries a 1 byte sequence number after the type
+ * byte. A difference frame only applies to the frame before
+ * it, so if the decoder sees a gap it drops sync and skips
+ * difference frames until the next key frame rather than
+ * adding them to the wrong base.
+ * 
+ * Frames are not self-delimiting beyond their length; carry
+ * them in something which is (eg. hx711_stream_t or a log
+ * record) or decode them back to back with the same chip
+ * count.
+ */
+typedef struct {
+    size_t _len;
+    uint32_t _resync_interval;
+    uint32_t _count;
+    uint8_t _seq;
+    int32_t _prev[HX711_DELTA_MAX_CHIPS];
+} hx711_delta_enc_t;
+
+typedef struct {
+    size_t _len;
+    bool _synced;
+    uint8_t _seq;
+    uint32_t _gaps;
+    int32_t _prev[HX711_DELTA_MAX_CHIPS];
+} hx711_delta_dec_t;
+
+/**
+ * @brief Map a signed value to an unsigned one so that values
+ * near zero, either side, stay small: 0, -1, 1, -2, 2, ...
+ * become 0, 1, 2, 3, 4, ...
+ * 
+ * @param v 
+ * @return uint32_t 
+ */
+static inline uint32_t hx711_delta_zigzag(const int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/**
+ * @brief Reverse of hx711_delta_zigzag.
+ * 
+ * @param u 
+ * @return int32_t 
+ */
+static inline int32_t hx711_delta_unzigzag(const uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+/**
+ * @brief Initialise an encoder.
+ * 
+ * @param enc 
+ * @param len values per frame, up to HX711_DELTA_MAX_CHIPS
+ * @param resync_interval frames between key frames; 1 makes
+ * every frame a key frame
+ */
+void hx711_delta_enc_init(
+    hx711_delta_enc_t* const enc,
+    const size_t len,
+    const uint32_t resync_interval);
+
+/**
+ * @brief Make the next frame a key frame, eg. after frames
+ * may have been lost downstream. The sequence number carries
+ * on.
+ * 
+ * @param enc 
+ */
+void hx711_delta_enc_reset(hx711_delta_enc_t* const enc);
+
+/**
+ * @brief Encode a frame.
+ * 
+ * @param enc 
+ * @param values 
+ * @param out must hold HX711_DELTA_ENCODED_MAX(len) bytes
+ * @return size_t bytes written
+ */
+size_t hx711_delta_encode(
+    hx711_delta_enc_t* const enc,
+    const int32_t* const values,
+    uint8_t* const out);
+
+/**
+ * @brief Initialise a decoder. It skips frames until a key
+ * frame arrives.
+ * 
+ * @param dec 
+ * @param len values per frame
+ */
+void hx711_delta_dec_init(
+    hx711_delta_dec_t* const dec,
+    const size_t len);
+
+/**
+ * @brief Decode one frame from the start of in.
+ * 
+ * @param dec 
+ * @param in 
+ * @param in_len 
+ * @param values 
+ * @param used bytes of in making up the frame; set whenever
+ * the frame is well formed, even if it cannot be decoded yet
+ * @return true if values were decoded
+ * @return false if the frame is malformed, or is a difference
+ * frame and no key frame has been seen since init (or since a
+ * malformed frame or a sequence gap)
+ */
+bool hx711_delta_decode(
+    hx711_delta_dec_t* const dec,
+    const uint8_t* const in,
+    const size_t in_len,
+    int32_t* const values,
+    size_t* const used);
+
+/**
+ * @brief Number of sequence gaps seen while synced, each of
+ * which dropped sync until the next key frame.
+ * 
+ * @param dec 
+ * @return uint32_t 
+ */
+uint32_t hx711_delta_dec_get_gaps(const hx711_delta_dec_t* const dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_FLASH_H_652EF5D6_24E0_426B_9EFD_9A34A63D80BE
+#define HX711_FLASH_H_652EF5D6_24E0_426B_9EFD_9A34A63D80BE
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Value of every byte in an erased sector.
+ */
+#define HX711_FLASH_ERASED_BYTE         UINT8_C(0xff)
+
+/**
+ * @brief Minimal NOR flash interface used for persistence.
+ * 
+ * Offsets are in bytes from the start of the device. Erase
+ * works on whole sectors and sets every byte to
+ * HX711_FLASH_ERASED_BYTE. Program can only clear bits, and
+ * must accept any offset and length within a sector (a
+ * backend with a larger program unit is expected to merge
+ * the data into the existing page itself).
+ * 
+ * This header has no SDK dependency so the same code can run
+ * on a host against a file-backed implementation.
+ */
+typedef struct {
+
+    size_t sector_size;
+    void* ctx;
+
+    bool (*read)(
+        void* ctx,
+        size_t offset,
+        void* buf,
+        size_t len);
+
+    bool (*erase)(
+        void* ctx,
+        size_t offset);
+
+    bool (*program)(
+        void* ctx,
+        size_t offset,
+        const void* buf,
+        size_t len);
+
+} hx711_flash_t;
+
+/**
+ * @brief Set up flash to use the RP2040's onboard QSPI flash.
+ * Reads go through XIP. Erase and program disable interrupts
+ * on the calling core and, if the other core has called
+ * multicore_lockout_victim_init, stop it with
+ * multicore_lockout_start_blocking until they return.
+ * 
+ * NOTE: if the other core is running but has not called
+ * multicore_lockout_victim_init it must not execute from flash
+ * or take interrupts while saving. Interrupts on both cores,
+ * including the hx711_multi_t DMA and PIO IRQs, are held off
+ * for the duration of each erase (tens of milliseconds) and
+ * page program.
+ * 
+ * @param flash 
+ */
+void hx711_flash_pico_init(hx711_flash_t* const flash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_GLITCH_H_89D9238E_0AB6_49F8_8083_83DF1D82BE80
+#define HX711_GLITCH_H_89D9238E_0AB6_49F8_8083_83DF1D82BE80
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Quality flags describing a value which has passed
+ * through a glitch filter. A value of 0 is a good value.
+ */
+#define HX711_QUALITY_OK                UINT8_C(0)
+#define HX711_QUALITY_GLITCH            UINT8_C(1 << 0) //too far from the estimate
+#define HX711_QUALITY_REPLACED          UINT8_C(1 << 1) //value was set to the estimate
+#define HX711_QUALITY_STEP              UINT8_C(1 << 2) //estimate was reset to the value
+#define HX711_QUALITY_SATURATED         UINT8_C(1 << 3) //value is the min or max code
+
+/**
+ * @brief Largest supported estimate smoothing shift.
+ */
+#define HX711_GLITCH_MAX_SHIFT          UINT8_C(7)
+
+/**
+ * @brief Number of consecutive values within max_delta of each
+ * other needed before a filter with max_rejects of 0 starts
+ * checking values.
+ */
+#ifndef HX711_GLITCH_PRIME_SAMPLES
+    #define HX711_GLITCH_PRIME_SAMPLES  UINT8_C(3)
+#endif
+
+typedef struct {
+
+    /**
+     * @brief A value further than this from the estimate is a
+     * glitch.
+     */
+    int32_t max_delta;
+
+    /**
+     * @brief The estimate moves 1/2^shift of the way towards
+     * each accepted value.
+     */
+    uint8_t shift;
+
+    /**
+     * @brief After this many consecutive glitches the value is
+     * taken to be a genuine step change (eg. a load being
+     * applied) and the estimate is reset to it. 0 never resets,
+     * in which case HX711_GLITCH_PRIME_SAMPLES agreeing values
+     * are needed to start the estimate.
+     */
+    uint8_t max_rejects;
+
+    /**
+     * @brief Whether a glitch is replaced by the estimate or
+     * only flagged.
+     */
+    bool replace;
+
+} hx711_glitch_config_t;
+
+/**
+ * @brief Per-chip max-delta glitch filter.
+ * 
+ * Each value is compared against an exponential moving
+ * average of previously accepted values. This is integer-only
+ * and O(1) per value, so it can run on every decoded frame.
+ */
+typedef struct {
+    int32_t _max_delta;
+    uint8_t _shift;
+    uint8_t _max_rejects;
+    bool _replace;
+    bool _primed;
+    uint8_t _rejects;
+    uint8_t _quality;
+    int32_t _acc;
+} hx711_glitch_t;
+
+/**
+ * @brief Fill config with defaults: a max delta of 2^20
+ * (1/8th of full scale), a shift of 2, resetting after 3
+ * glitches and replacing glitches.
+ * 
+ * @param config 
+ */
+void hx711_glitch_get_default_config(hx711_glitch_config_t* const config);
+
+/**
+ * @brief Initialise a filter. The first value it sees becomes
+ * the estimate, unless max_rejects is 0 (see
+ * HX711_GLITCH_PRIME_SAMPLES).
+ * 
+ * @param g 
+ * @param config 
+ */
+void hx711_glitch_init(
+    hx711_glitch_t* const g,
+    const hx711_glitch_config_t* const config);
+
+/**
+ * @brief Forget the estimate, eg. after changing gain.
+ * 
+ * @param g 
+ */
+void hx711_glitch_reset(hx711_glitch_t* const g);
+
+/**
+ * @brief Check a value, replacing it with the estimate if it
+ * is a glitch and the filter is set to replace.
+ * 
+ * @param g 
+ * @param val 
+ * @return uint8_t HX711_QUALITY_* flags
+ */
+uint8_t hx711_glitch_filter(
+    hx711_glitch_t* const g,
+    int32_t* const val);
+
+/**
+ * @brief Run hx711_glitch_filter over len values, one filter
+ * per value.
+ * 
+ * @param gs array of len filters
+ * @param values 
+ * @param len 
+ */
+void hx711_glitch_filter_multi(
+    hx711_glitch_t* const gs,
+    int32_t* const values,
+    const size_t len);
+
+/**
+ * @brief Quality flags of the last value filtered.
+ * 
+ * @param g 
+ * @return uint8_t 
+ */
+uint8_t hx711_glitch_get_quality(const hx711_glitch_t* const g);
+
+/**
+ * @brief Current estimate.
+ * 
+ * @param g 
+ * @return int32_t 
+ */
+int32_t hx711_glitch_get_estimate(const hx711_glitch_t* const g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_HIST_H_2019A98E_DB71_4504_98E0_FBC0391780A9
+#define HX711_HIST_H_2019A98E_DB71_4504_98E0_FBC0391780A9
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of histogram buckets. Bucket 0 counts values
+ * of 0 and bucket n counts values in the range [2^(n-1), 2^n).
+ */
+#define HX711_HIST_BUCKETS              UINT8_C(33)
+
+/**
+ * @brief Number of attempts hx711_hist_snapshot makes to get a
+ * consistent copy before giving up.
+ */
+#ifndef HX711_HIST_SNAPSHOT_TRIES
+    #define HX711_HIST_SNAPSHOT_TRIES   UINT16_C(1000)
+#endif
+
+/**
+ * @brief Log2 histogram of 32-bit values (eg. microseconds).
+ * 
+ * A histogram has a single writer which never blocks. Readers
+ * use hx711_hist_snapshot to obtain a consistent copy, which
+ * is retried if the writer updates the histogram in the
+ * meantime.
+ */
+typedef struct {
+    volatile uint32_t _seq;
+    volatile uint32_t _count;
+    volatile uint32_t _min;
+    volatile uint32_t _max;
+    volatile uint32_t _buckets[HX711_HIST_BUCKETS];
+} hx711_hist_t;
+
+/**
+ * @brief Consistent copy of a hx711_hist_t.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t buckets[HX711_HIST_BUCKETS];
+} hx711_hist_snapshot_t;
+
+/**
+ * @brief Reset a histogram to contain no values.
+ * 
+ * @param hist 
+ */
+void hx711_hist_init(hx711_hist_t* const hist);
+
+/**
+ * @brief Add a value to a histogram. Safe to call from an
+ * ISR, provided there is only one writer.
+ * 
+ * @param hist 
+ * @param val 
+ */
+void hx711_hist_record(
+    hx711_hist_t* const hist,
+    const uint32_t val);
+
+/**
+ * @brief Copy a histogram. The copy is retried while the
+ * writer is part way through an update, up to
+ * HX711_HIST_SNAPSHOT_TRIES times.
+ * 
+ * @note Do not call this from an ISR which can preempt the
+ * writer on the same core; the writer cannot finish until the
+ * ISR returns, so every attempt would fail.
+ * 
+ * @param hist 
+ * @param snap 
+ * @return true 
+ * @return false if no consistent copy was obtained; snap is
+ * not valid
+ */
+bool hx711_hist_snapshot(
+    const hx711_hist_t* const hist,
+    hx711_hist_snapshot_t* const snap);
+
+/**
+ * @brief Returns the bucket a value is counted in.
+ * 
+ * @param val 
+ * @return uint 
+ */
+uint hx711_hist_get_bucket(const uint32_t val);
+
+/**
+ * @brief Returns the largest value counted in a bucket.
+ * 
+ * @param bucket 
+ * @return uint32_t 
+ */
+uint32_t hx711_hist_get_bucket_max(const uint bucket);
+
+/**
+ * @brief Returns an upper bound of the given percentile of
+ * values in a histogram. ie. at least pct percent of values
+ * are less than or equal to the returned value.
+ * 
+ * @param snap 
+ * @param pct 0 to 100
+ * @return uint32_t 0 if the histogram is empty
+ */
+uint32_t hx711_hist_get_percentile(
+    const hx711_hist_snapshot_t* const snap,
+    const uint pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
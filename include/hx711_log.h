@@ -0,0 +1,263 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_LOG_H_7E6E3AB1_C7B9_42F5_AA69_4789E2CAD01C
+#define HX711_LOG_H_7E6E3AB1_C7B9_42F5_AA69_4789E2CAD01C
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hx711_flash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Identifies a written log page ("HXLG").
+ */
+#define HX711_LOG_MAGIC                 UINT32_C(0x474c5848)
+
+/**
+ * @brief Bytes per log page. Each page is programmed once, in
+ * one go. Must divide the flash sector size; the default is
+ * the RP2040's flash page size.
+ */
+#ifndef HX711_LOG_PAGE_LEN
+    #define HX711_LOG_PAGE_LEN          256
+#endif
+
+/**
+ * @brief Bytes of records a page can hold.
+ */
+#define HX711_LOG_PAYLOAD_LEN \
+    (HX711_LOG_PAGE_LEN - sizeof(hx711_log_page_header_t))
+
+/**
+ * @brief Longest record. Each record takes one more byte than
+ * its length, and records do not span pages.
+ */
+#define HX711_LOG_MAX_RECORD_LEN \
+    (HX711_LOG_PAYLOAD_LEN - 1 < 255 ? HX711_LOG_PAYLOAD_LEN - 1 : 255)
+
+/**
+ * @brief Start of every written page (little endian, 16
+ * bytes). crc covers the preceding header bytes and the used
+ * payload bytes.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint16_t used;
+    uint16_t reserved;
+    uint32_t crc;
+} hx711_log_page_header_t;
+
+/**
+ * @brief Log-structured ring of records in a reserved region
+ * of flash.
+ * 
+ * Records (eg. hx711_delta_encode frames) are collected in a
+ * page buffer in RAM, and each full page is programmed once
+ * with a header holding a sequence number one higher than the
+ * page before. When writing reaches a new sector, that sector
+ * is erased first, so the oldest sector's worth of records is
+ * dropped and every sector is erased equally often.
+ * 
+ * The erase can instead be done early, at a time of the
+ * caller's choosing, with hx711_log_erase_ahead.
+ * 
+ * On start up the first page of each sector is read to find
+ * the newest sector, then that sector alone is scanned to
+ * find where writing left off. A page which was being written
+ * when power failed fails its CRC and is skipped.
+ */
+typedef struct {
+    hx711_flash_t* _flash;
+    size_t _offset;
+    size_t _pages_per_sector;
+    size_t _pages;
+    size_t _next;
+    uint32_t _seq;
+    size_t _fill;
+    bool _erased_ahead;
+    uint8_t _page[HX711_LOG_PAGE_LEN];
+} hx711_log_t;
+
+/**
+ * @brief Reads the records of a log from oldest to newest.
+ */
+typedef struct {
+    const hx711_log_t* _log;
+    size_t _page;
+    size_t _remaining;
+    bool _started;
+    uint32_t _seq;
+    size_t _pos;
+    size_t _used;
+    uint8_t _buf[HX711_LOG_PAGE_LEN];
+} hx711_log_reader_t;
+
+/**
+ * @brief Open a log in the sectors sectors beginning at
+ * offset, which must be sector aligned, and find where to
+ * continue writing.
+ * 
+ * @param log 
+ * @param flash 
+ * @param offset 
+ * @param sectors at least 2
+ * @return true 
+ * @return false if the flash could not be read
+ */
+bool hx711_log_init(
+    hx711_log_t* const log,
+    hx711_flash_t* const flash,
+    const size_t offset,
+    const size_t sectors);
+
+/**
+ * @brief Add a record. It reaches flash when its page fills
+ * or on hx711_log_flush.
+ * 
+ * With hx711_flash_pico_init, writing a page disables
+ * interrupts on the calling core and locks out the other core
+ * (see hx711_flash_pico_init) for the duration, as XIP is
+ * unavailable meanwhile. Acquisition is suspended while this
+ * happens: the hx711_multi_t DMA IRQ is not serviced, so
+ * conversions which complete in that time are lost. A page
+ * program takes around a millisecond, but when the page
+ * starts a new sector the sector is erased first, which takes
+ * tens of milliseconds; several conversions at 80 SPS. Call
+ * hx711_log_erase_ahead at a time when acquisition can pause
+ * to keep the erase out of this call, and read any values
+ * needed before appending so a conversion is not missed while
+ * a page is written.
+ * 
+ * @param log 
+ * @param data 
+ * @param len 1 to HX711_LOG_MAX_RECORD_LEN
+ * @return true 
+ * @return false if a page had to be written and that failed
+ */
+bool hx711_log_append(
+    hx711_log_t* const log,
+    const void* const data,
+    const size_t len);
+
+/**
+ * @brief Write the partly full page to flash. The rest of the
+ * page is left unused, so only flush when needed (eg. before
+ * power down or reading back).
+ * 
+ * @param log 
+ * @return true 
+ * @return false 
+ */
+bool hx711_log_flush(hx711_log_t* const log);
+
+/**
+ * @brief Erase the sector the log will next move on to, if it
+ * has not been already, so that appending to it later only
+ * needs page programs. The oldest sector's records are
+ * dropped now rather than when writing reaches it.
+ * 
+ * The erase suspends acquisition in the same way as
+ * hx711_log_append (see there), so call this when that does
+ * not matter, eg. while the chips are powered down or between
+ * runs. Does nothing if the sector is already erased.
+ * 
+ * @param log 
+ * @return true 
+ * @return false if the erase failed
+ */
+bool hx711_log_erase_ahead(hx711_log_t* const log);
+
+/**
+ * @brief Start reading a log from its oldest record. Records
+ * not yet flushed are not included.
+ * 
+ * @param r 
+ * @param log 
+ */
+void hx711_log_reader_init(
+    hx711_log_reader_t* const r,
+    const hx711_log_t* const log);
+
+/**
+ * @brief Get the next record.
+ * 
+ * @param r 
+ * @param buf must hold HX711_LOG_MAX_RECORD_LEN bytes
+ * @param len 
+ * @return true 
+ * @return false if there are no more records
+ */
+bool hx711_log_reader_next(
+    hx711_log_reader_t* const r,
+    void* const buf,
+    size_t* const len);
+
+/**
+ * @brief Sequence number of the page the last record came
+ * from. Records from pages whose numbers are not consecutive
+ * have a gap between them (eg. a page lost to power failure).
+ * 
+ * @param r 
+ * @return uint32_t 
+ */
+uint32_t hx711_log_reader_get_seq(const hx711_log_reader_t* const r);
+
+/**
+ * @brief Offset in flash of a page.
+ * 
+ * @param log 
+ * @param page 
+ * @return size_t 
+ */
+static size_t hx711_log__page_offset(
+    const hx711_log_t* const log,
+    const size_t page);
+
+/**
+ * @brief Read a page and check its header and CRC.
+ * 
+ * @param log 
+ * @param page 
+ * @param buf HX711_LOG_PAGE_LEN bytes
+ * @param hdr copy of the page header
+ * @param valid set to whether the page holds records
+ * @return true 
+ * @return false if the flash could not be read
+ */
+static bool hx711_log__read_page(
+    const hx711_log_t* const log,
+    const size_t page,
+    uint8_t* const buf,
+    hx711_log_page_header_t* const hdr,
+    bool* const valid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
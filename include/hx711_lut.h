@@ -0,0 +1,120 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_LUT_H_FA040695_E983_49FA_8FE4_B3C678B4000C
+#define HX711_LUT_H_FA040695_E983_49FA_8FE4_B3C678B4000C
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most points a correction table can have.
+ */
+#ifndef HX711_LUT_MAX_POINTS
+    #define HX711_LUT_MAX_POINTS        UINT8_C(16)
+#endif
+
+/**
+ * @brief Fractional bits of segment slopes. Slopes must be
+ * less than 128 in magnitude.
+ */
+#define HX711_LUT_SLOPE_Q               24
+
+/**
+ * @brief A calibration point: the raw value read, and what it
+ * should have been (in counts, or any other integer unit).
+ */
+typedef struct {
+    int32_t raw;
+    int32_t value;
+} hx711_lut_point_t;
+
+/**
+ * @brief Piecewise-linear correction table.
+ * 
+ * Built from a handful of calibration points, it corrects
+ * curvature which a single offset and scale cannot. The
+ * segment is found by binary search and interpolated with one
+ * integer multiply and shift (the slopes are precomputed), so
+ * no division or floating point is needed per value. Values
+ * beyond the first or last point are extrapolated from the
+ * nearest segment.
+ */
+typedef struct {
+    size_t _len;
+    int32_t _raw[HX711_LUT_MAX_POINTS];
+    int32_t _value[HX711_LUT_MAX_POINTS];
+    int32_t _slope[HX711_LUT_MAX_POINTS - 1];
+} hx711_lut_t;
+
+/**
+ * @brief Build a table. The points need not be sorted.
+ * 
+ * @param lut 
+ * @param points 
+ * @param len at least 2 and at most HX711_LUT_MAX_POINTS
+ * @return true 
+ * @return false if two points have the same raw value or a
+ * segment is too steep
+ */
+bool hx711_lut_init(
+    hx711_lut_t* const lut,
+    const hx711_lut_point_t* const points,
+    const size_t len);
+
+/**
+ * @brief Correct a value.
+ * 
+ * @param lut 
+ * @param raw eg. from hx711_get_value
+ * @return int32_t 
+ */
+int32_t hx711_lut_apply(
+    const hx711_lut_t* const lut,
+    const int32_t raw);
+
+/**
+ * @brief Correct len values, each with its own table, eg. the
+ * output of hx711_multi_get_values. raw and out may be the
+ * same array.
+ * 
+ * @param luts 
+ * @param raw 
+ * @param out 
+ * @param len 
+ */
+void hx711_lut_apply_multi(
+    const hx711_lut_t* const luts,
+    const int32_t* const raw,
+    int32_t* const out,
+    const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,8 @@
 #include "pico/mutex.h"
 #include "pico/platform.h"
 #include "hx711.h"
+#include "hx711_alarm.h"
+#include "hx711_hist.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -79,6 +81,19 @@ extern "C" {
  */
 #define HX711_MULTI_MAX_CHIPS                   UINT8_C(MIN(NUM_BANK0_GPIOS, 32))
 
+/**
+ * @brief Maximum number of frames which can be given to a
+ * hx711_multi_t with hx711_multi_set_frame_pool.
+ */
+#define HX711_MULTI_MAX_POOL_FRAMES             UINT8_C(32)
+
+/**
+ * @brief A raw frame as written by DMA. Each element is the
+ * bitmask of all chips' data pins for one HX711 bit, MSB
+ * first. See hx711_multi_pinvals_to_values.
+ */
+typedef uint32_t hx711_multi_frame_t[HX711_READ_BITS];
+
 /**
  * @brief State of the read as it moves through the async process.
  */
@@ -89,7 +104,26 @@ typedef enum {
     HX711_MULTI_ASYNC_STATE_DONE
 } hx711_multi_async_state_t;
 
-typedef struct {
+typedef struct hx711_multi hx711_multi_t;
+
+/**
+ * @brief Called from the DMA IRQ handler each time a frame
+ * lands during a continuous read. frame is the raw frame and
+ * values is the same frame already decoded (one value per
+ * chip, before any glitch or notch filter). Both are only
+ * valid until the callback returns.
+ * 
+ * @return true to keep reading
+ * @return false to stop; the read then finishes as if
+ * hx711_multi_async_stop had been called
+ */
+typedef bool (*hx711_multi_frame_cb_t)(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx);
+
+struct hx711_multi {
 
     uint _clock_pin;
     uint _data_pin_base;
@@ -109,7 +143,33 @@ typedef struct {
 
     uint _dma_channel;
 
-    uint32_t _buffer[HX711_READ_BITS];
+    hx711_multi_frame_t _buffer;
+
+    hx711_multi_frame_t* _pool;
+    size_t _pool_len;
+    uint32_t _pool_free;
+    uint32_t* _frame;
+    bool _frame_taken;
+
+    //_frame has been given back with hx711_multi_release_frame
+    //and may be rewritten by the next read
+    bool _frame_released;
+
+    //_frame decoded by the DMA IRQ handler, when it needs it
+    int32_t _values[HX711_MULTI_MAX_CHIPS];
+    bool _values_valid;
+
+    hx711_multi_frame_cb_t _frame_cb;
+    void* _frame_cb_ctx;
+
+    uint _rate_pin;
+    hx711_rate_t _rate;
+    hx711_rate_t _auto_rate;
+    hx711_stability_t* _stability;
+
+    hx711_glitch_t* _glitch;
+    hx711_notch_t* _notch;
+    hx711_alarm_t* _alarms;
 
     uint _pio_irq_index;
     uint _dma_irq_index;
@@ -119,7 +179,22 @@ typedef struct {
     mutex_t _mut;
 #endif
 
-} hx711_multi_t;
+#ifdef HX711_STATS
+    hx711_stats_t _stats;
+
+    //when hx711_multi_async_get_frame was called, for
+    //decode_cycles
+    uint32_t _decode_start_cycles;
+#endif
+
+#ifdef HX711_HIST
+    hx711_hist_t _latency_hist;
+    hx711_hist_t _interval_hist;
+    uint32_t _frame_time;
+    bool _frame_time_valid;
+#endif
+
+};
 
 typedef void (*hx711_multi_pio_init_t)(hx711_multi_t* const);
 typedef void (*hx711_multi_program_init_t)(hx711_multi_t* const);
@@ -141,6 +216,13 @@ typedef struct {
      */
     size_t chips_len;
 
+    /**
+     * @brief GPIO connected to the RATE pin of all HX711 chips,
+     * or HX711_NO_RATE_PIN. When connected, the chips start at
+     * hx711_rate_10.
+     */
+    uint rate_pin;
+
 
     /**
      * @brief Which index to use for a PIO interrupt. Either 0 or 1.
@@ -272,6 +354,17 @@ static hx711_multi_t* const hx711_multi__async_get_pio_irq_request();
 static void hx711_multi__async_start_dma(
     hx711_multi_t* const hxm);
 
+/**
+ * @brief Wait for the next conversion, triggering DMA now if
+ * it is already done or listening for the PIO IRQ if not.
+ * The request state must be WAITING, and is READING on return
+ * if DMA was triggered.
+ * 
+ * @param hxm 
+ */
+static void hx711_multi__async_arm(
+    hx711_multi_t* const hxm);
+
 /**
  * @brief Check whether an async read is currently occurring.
  * 
@@ -294,12 +387,12 @@ static void hx711_multi__async_finish(
 /**
  * @brief ISR handler for PIO IRQs.
  */
-static void __isr __not_in_flash_func(hx711_multi__async_pio_irq_handler)();
+static void __isr hx711_multi__async_pio_irq_handler();
 
 /**
  * @brief ISR handler for DMA IRQs.
  */
-static void __isr __not_in_flash_func(hx711_multi__async_dma_irq_handler)();
+static void __isr hx711_multi__async_dma_irq_handler();
 
 /**
  * @brief Adds hxm to the array for ISR access. Returns false
@@ -320,6 +413,29 @@ static bool hx711_multi__async_add_reader(
 static void hx711_multi__async_remove_reader(
     const hx711_multi_t* const hxm);
 
+/**
+ * @brief Choose the frame the next DMA transfer writes to. The
+ * previous frame is returned to the pool unless it was taken
+ * by the application. If the pool is empty, the internal
+ * buffer is used.
+ * 
+ * @param hxm 
+ */
+static void hx711_multi__async_acquire_frame(
+    hx711_multi_t* const hxm);
+
+/**
+ * @brief Returns the index of a frame within the pool, or -1
+ * if it is not a pool frame.
+ * 
+ * @param hxm 
+ * @param frame 
+ * @return int 
+ */
+static int hx711_multi__get_pool_index(
+    const hx711_multi_t* const hxm,
+    const uint32_t* const frame);
+
 /**
  * @brief Check whether the hxm struct has been initialised.
  * 
@@ -340,6 +456,33 @@ static bool hx711_multi__is_initd(hx711_multi_t* const hxm);
 static bool hx711_multi__is_state_machines_enabled(
     hx711_multi_t* const hxm);
 
+/**
+ * @brief Count saturations and apply the glitch and notch
+ * filters to a decoded frame.
+ * 
+ * @param hxm 
+ * @param values 
+ */
+static void hx711_multi__process_values(
+    hx711_multi_t* const hxm,
+    int32_t* const values);
+
+/**
+ * @brief hx711_multi_frame_cb_t which folds each frame into
+ * a hx711_multi__samples_t for hx711_multi_get_values_avg and
+ * hx711_multi_get_values_median.
+ * 
+ * @param hxm 
+ * @param frame 
+ * @param ctx hx711_multi__samples_t
+ * @return true until every sample has been read
+ */
+static bool hx711_multi__on_sample_frame(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx);
+
 /**
  * @brief Convert an array of pinvals to regular HX711
  * values.
@@ -409,6 +552,30 @@ bool hx711_multi_get_values_timeout(
  */
 void hx711_multi_async_start(hx711_multi_t* const hxm);
 
+/**
+ * @brief Start reading every frame, calling cb from the DMA
+ * IRQ handler as each one lands and immediately waiting for
+ * the next, so no conversion is missed. The mutex is held
+ * until the read stops. Frames are always read into the
+ * internal buffer; the frame pool is not used.
+ * 
+ * @param hxm 
+ * @param cb 
+ * @param ctx passed to cb
+ */
+void hx711_multi_async_start_continuous(
+    hx711_multi_t* const hxm,
+    hx711_multi_frame_cb_t cb,
+    void* const ctx);
+
+/**
+ * @brief Stop a running asynchronous read, whether single or
+ * continuous. Does nothing if no read is running.
+ * 
+ * @param hxm 
+ */
+void hx711_multi_async_stop(hx711_multi_t* const hxm);
+
 /**
  * @brief Check whether an asynchronous read is complete.
  * This function is not mutex protected.
@@ -420,8 +587,10 @@ void hx711_multi_async_start(hx711_multi_t* const hxm);
 bool hx711_multi_async_done(hx711_multi_t* const hxm);
 
 /**
- * @brief Get the values from the last asynchronous read.
- * This function is not mutex protected.
+ * @brief Get the values from the last asynchronous read. Must
+ * not be called once its frame has been given back with
+ * hx711_multi_release_frame. This function is not mutex
+ * protected.
  * 
  * @param hxm 
  * @param values 
@@ -430,6 +599,80 @@ void hx711_multi_async_get_values(
     hx711_multi_t* const hxm,
     int32_t* const values);
 
+/**
+ * @brief First half of hx711_multi_async_get_values, for a
+ * caller with its own decoder (eg. hx711::async_get_values).
+ * Returns the raw frame of the last asynchronous read to
+ * decode into values. If the DMA IRQ handler has already
+ * decoded it, the values are copied into values instead and
+ * NULL is returned. Either way, pass values on to
+ * hx711_multi_async_process_values. This function is not mutex
+ * protected.
+ * 
+ * @param hxm 
+ * @param values 
+ * @return const uint32_t* frame to decode, or NULL
+ */
+const uint32_t* hx711_multi_async_get_frame(
+    hx711_multi_t* const hxm,
+    int32_t* const values);
+
+/**
+ * @brief Second half of hx711_multi_async_get_values: records
+ * the read's latency, counts saturations, applies the glitch
+ * and notch filters to the decoded values and adds the
+ * decode time to the statistics. This function is not mutex
+ * protected.
+ * 
+ * @param hxm 
+ * @param values 
+ */
+void hx711_multi_async_process_values(
+    hx711_multi_t* const hxm,
+    int32_t* const values);
+
+/**
+ * @brief Give the hxm a pool of application-owned frames for
+ * DMA to write into, instead of the internal buffer. Pass NULL
+ * and 0 to go back to using the internal buffer. Must not be
+ * called while an asynchronous read is running.
+ * 
+ * @param hxm 
+ * @param frames 
+ * @param len number of frames, up to HX711_MULTI_MAX_POOL_FRAMES
+ */
+void hx711_multi_set_frame_pool(
+    hx711_multi_t* const hxm,
+    hx711_multi_frame_t* const frames,
+    const size_t len);
+
+/**
+ * @brief Take ownership of the raw frame from the last
+ * asynchronous read. The frame will not be written to again
+ * until it is given back with hx711_multi_release_frame.
+ * hx711_multi_async_get_values may still be called until then.
+ * This function is not mutex protected.
+ * 
+ * @param hxm 
+ * @return const uint32_t* the frame, or NULL if no pool frame
+ * was free when the read started and the internal buffer was
+ * used instead
+ */
+const uint32_t* hx711_multi_async_take_frame(
+    hx711_multi_t* const hxm);
+
+/**
+ * @brief Give a frame obtained from hx711_multi_async_take_frame
+ * back to the pool. If it is the frame of the last read, that
+ * read's values can no longer be got.
+ * 
+ * @param hxm 
+ * @param frame 
+ */
+void hx711_multi_release_frame(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame);
+
 /**
  * @brief Power up each HX711 and start the internal read/write
  * functionality.
@@ -482,6 +725,246 @@ uint32_t hx711_multi_get_sync_state(
 bool hx711_multi_is_syncd(
     hx711_multi_t* const hxm);
 
+/**
+ * @brief Change the sample rate of all chips using the RATE
+ * pin, then wait for the HX711's settling time at the new
+ * rate. Attached notch filters are initialised again for the
+ * new rate and their mains setting, and attached glitch
+ * filters are reset. Requires rate_pin to be configured.
+ * 
+ * @param hxm 
+ * @param rate 
+ */
+void hx711_multi_set_rate(
+    hx711_multi_t* const hxm,
+    const hx711_rate_t rate);
+
+/**
+ * @brief Returns the current sample rate. Without a rate pin
+ * this is always hx711_rate_10.
+ * 
+ * @param hxm 
+ * @return hx711_rate_t 
+ */
+hx711_rate_t hx711_multi_get_rate(hx711_multi_t* const hxm);
+
+/**
+ * @brief Switch rate automatically based on one stability
+ * detector per chip. The rate is 80 SPS while any chip's load
+ * is changing and 10 SPS once all are stable. The detectors
+ * are seeded from the current rate, so they start out stable
+ * at 10 SPS.
+ * 
+ * Detectors are fed by hx711_multi_get_values,
+ * hx711_multi_get_values_timeout, hx711_multi_get_values_avg
+ * and hx711_multi_get_values_median; asynchronous readers can
+ * feed them with hx711_multi_update_auto_rate. A switch waits
+ * out the settling time, so only the blocking reads
+ * (hx711_multi_get_values, _avg and _median) make it, or
+ * hx711_multi_apply_auto_rate. Requires rate_pin to be
+ * configured.
+ * 
+ * @param hxm 
+ * @param ss array of initialised detectors, one per chip, or
+ * NULL to stop switching
+ */
+void hx711_multi_set_auto_rate(
+    hx711_multi_t* const hxm,
+    hx711_stability_t* const ss);
+
+/**
+ * @brief Feed a frame of values to the auto rate detectors and
+ * record whether a rate switch is due. This never blocks, so
+ * it may be called from a hx711_multi_frame_cb_t. Does nothing
+ * if auto rate is not set.
+ * 
+ * @param hxm 
+ * @param values 
+ */
+void hx711_multi_update_auto_rate(
+    hx711_multi_t* const hxm,
+    const int32_t* const values);
+
+/**
+ * @brief Make a rate switch which the auto rate detectors have
+ * asked for since the last one, waiting out the settling time.
+ * Does nothing if none is due. Must not be called while an
+ * asynchronous read is running.
+ * 
+ * @param hxm 
+ * @return true if the rate was changed
+ * @return false 
+ */
+bool hx711_multi_apply_auto_rate(hx711_multi_t* const hxm);
+
+/**
+ * @brief Pass every frame decoded from now on through one
+ * glitch filter per chip. Values are filtered as part of
+ * hx711_multi_async_get_values (and so every read function),
+ * and hx711_glitch_get_quality gives each chip's quality.
+ * 
+ * @param hxm 
+ * @param gs array of initialised filters, one per chip, or
+ * NULL to stop filtering
+ */
+void hx711_multi_set_glitch_filters(
+    hx711_multi_t* const hxm,
+    hx711_glitch_t* const gs);
+
+/**
+ * @brief Pass every frame decoded from now on through one
+ * mains hum filter per chip, after any glitch filters.
+ * 
+ * @param hxm 
+ * @param ns array of initialised filters, one per chip, or
+ * NULL to stop filtering
+ */
+void hx711_multi_set_notch_filters(
+    hx711_multi_t* const hxm,
+    hx711_notch_t* const ns);
+
+/**
+ * @brief Check every frame against one alarm per chip from
+ * the DMA IRQ handler, before the frame is handed to any
+ * application code. Alarms see the raw values, ahead of any
+ * glitch or mains hum filters.
+ * 
+ * @param hxm 
+ * @param as array of initialised alarms, one per chip, or
+ * NULL to stop checking
+ */
+void hx711_multi_set_alarms(
+    hx711_multi_t* const hxm,
+    hx711_alarm_t* const as);
+
+/**
+ * @brief Obtain the mean of n values from each chip. Only a
+ * running sum per chip is kept. The n frames are read as one
+ * continuous read, so the mutex is taken once and each
+ * conversion is armed as soon as the last one is read; the
+ * glitch and notch filters and the auto rate detectors run in
+ * the DMA IRQ handler. Any rate switch is made after the last
+ * frame.
+ * 
+ * @param hxm 
+ * @param n number of values, at least 1
+ * @param values array to hold the mean for each chip
+ */
+void hx711_multi_get_values_avg(
+    hx711_multi_t* const hxm,
+    const uint n,
+    int32_t* const values);
+
+/**
+ * @brief Obtain the median of n values from each chip. Each
+ * value is inserted into a sorted buffer for its chip as it
+ * arrives. Frames are read as with
+ * hx711_multi_get_values_avg.
+ * 
+ * @param hxm 
+ * @param n number of values, between 1 and
+ * HX711_MEDIAN_MAX_SAMPLES
+ * @param values array to hold the median for each chip
+ */
+void hx711_multi_get_values_median(
+    hx711_multi_t* const hxm,
+    const uint n,
+    int32_t* const values);
+
+/**
+ * @brief Average samples values from each chip with no load
+ * applied and use the results as the calibration offsets.
+ * The scale and timestamp of each calibration are left
+ * unchanged.
+ * 
+ * @param hxm 
+ * @param samples number of values to average, at least 1
+ * @param calibs array of calibrations, one per chip
+ */
+void hx711_multi_tare(
+    hx711_multi_t* const hxm,
+    const uint samples,
+    hx711_calib_t* const calibs);
+
+/**
+ * @brief Average samples values from one chip with a known
+ * mass applied to its load cell and derive the calibration
+ * scale from the existing offset, so hx711_multi_tare must
+ * be called first.
+ * 
+ * @param hxm 
+ * @param samples number of values to average, at least 1
+ * @param chip index of the chip to calibrate
+ * @param known_mass mass applied, in the unit readings should
+ * be converted to; must be greater than 0
+ * @param calibs array of calibrations, one per chip
+ * @return true if the scale was updated
+ * @return false if the mass made no difference to the value
+ */
+bool hx711_multi_calibrate(
+    hx711_multi_t* const hxm,
+    const uint samples,
+    const uint chip,
+    const float known_mass,
+    hx711_calib_t* const calibs);
+
+#ifdef HX711_STATS
+/**
+ * @brief Copy the current read counters into stats. This
+ * function is not mutex protected so that it can be called
+ * while an asynchronous read is running.
+ * 
+ * @param hxm 
+ * @param stats 
+ */
+void hx711_multi_get_stats(
+    hx711_multi_t* const hxm,
+    hx711_stats_t* const stats);
+
+/**
+ * @brief Reset all read counters to 0. This function is not
+ * mutex protected.
+ * 
+ * @param hxm 
+ */
+void hx711_multi_reset_stats(hx711_multi_t* const hxm);
+#endif
+
+#ifdef HX711_HIST
+/**
+ * @brief Copy the acquisition timing histograms. Values are in
+ * microseconds. This function is not mutex protected.
+ * 
+ * latency is the time from a frame landing in the buffer (the
+ * DMA IRQ) to the values being obtained with
+ * hx711_multi_async_get_values. The HX711 data ready edge
+ * precedes the DMA IRQ by the time taken to clock in 24 bits.
+ * 
+ * interval is the time between successive frames landing in
+ * the buffer.
+ * 
+ * Must not be called from an ISR (see hx711_hist_snapshot).
+ * 
+ * @param hxm 
+ * @param latency may be NULL
+ * @param interval may be NULL
+ * @return true 
+ * @return false if a consistent copy could not be obtained
+ */
+bool hx711_multi_get_hists(
+    hx711_multi_t* const hxm,
+    hx711_hist_snapshot_t* const latency,
+    hx711_hist_snapshot_t* const interval);
+
+/**
+ * @brief Reset the acquisition timing histograms. This
+ * function is not mutex protected.
+ * 
+ * @param hxm 
+ */
+void hx711_multi_reset_hists(hx711_multi_t* const hxm);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
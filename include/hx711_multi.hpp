@@ -0,0 +1,379 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_MULTI_HPP_CA0BFD33_04CA_4EE8_9EFD_D079498440E4
+#define HX711_MULTI_HPP_CA0BFD33_04CA_4EE8_9EFD_D079498440E4
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include "hardware/pio.h"
+#include "hardware/timer.h"
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "common.h"
+#include "hx711.h"
+#include "hx711_decode.hpp"
+#include "hx711_multi.h"
+#include "util.h"
+
+namespace hx711 {
+
+namespace detail {
+
+// None of these are constexpr. Reaching one while a Pins is
+// being built at compile time fails the build, and the error
+// names the problem.
+inline void clock_pin_out_of_range() {}
+inline void data_pins_out_of_range() {}
+inline void clock_pin_is_a_data_pin() {}
+inline void rate_pin_out_of_range() {}
+inline void rate_pin_is_in_use() {}
+inline void pio_irq_index_out_of_range() {}
+inline void dma_irq_index_out_of_range() {}
+
+struct Closer {
+    void operator()(hx711_multi_t* const hxm) const {
+        hx711_multi_close(hxm);
+        delete hxm;
+    }
+};
+
+}
+
+/**
+ * @brief Values of the frame an async read of N chips has just
+ * finished. Same as hx711_multi_async_get_values, except that
+ * the frame is decoded with decode<N> instead of the run-time
+ * length decoder. Everything after decoding is left to
+ * hx711_multi_async_process_values, as from C.
+ * 
+ * @tparam N number of chips; must match hxm
+ * @param hxm 
+ * @return Frame<N> 
+ */
+template<std::size_t N>
+Frame<N> async_get_values(hx711_multi_t* const hxm) {
+
+    assert(hxm != nullptr);
+    assert(hxm->_chips_len == N);
+    assert(hx711_multi_async_done(hxm));
+
+    Frame<N> values;
+
+    const std::uint32_t* const frame =
+        hx711_multi_async_get_frame(hxm, values.data());
+
+    if(frame != nullptr) {
+        values = decode<N>(RawFrame(frame, frame_words));
+    }
+
+    hx711_multi_async_process_values(hxm, values.data());
+
+    return values;
+
+}
+
+/**
+ * @brief hx711_multi_t for exactly N chips.
+ * 
+ * Constructing one initialises the chips' PIO, DMA and IRQs,
+ * and destroying it closes them, so hx711_multi_init and
+ * hx711_multi_close are always paired. It can be moved but
+ * not copied. The hx711_multi_t itself is registered with the
+ * IRQ handlers by address and holds a mutex, so it is kept on
+ * the heap and only ownership moves.
+ * 
+ * Values come back as Frame<N> instead of a VLA. The
+ * blocking reads and async_get run the same async start and
+ * done steps as the C functions, but decode with decode<N>
+ * (see async_get_values), so glitch
+ * rejection, the notch filter, alarms, statistics and
+ * automatic rate switching all behave as they do from C. The
+ * other calls forward to the C function of the same purpose.
+ * Use get() to reach the rest of the C API.
+ * 
+ * @example
+ * hx711::Multi<4> hxm({ 14, 2, 1, 1 });
+ * hxm.power_up(hx711_gain_128);
+ * hx711_wait_settle(hx711_rate_10);
+ * const auto values = hxm.read();
+ * 
+ * @tparam N number of chips
+ */
+template<std::size_t N>
+class Multi {
+
+    static_assert(
+        N >= HX711_MULTI_MIN_CHIPS && N <= HX711_MULTI_MAX_CHIPS,
+        "chip count out of range");
+
+public:
+
+    using frame_t = Frame<N>;
+
+    /**
+     * @brief Pins and IRQ indices, checked at compile time.
+     * The constructor is consteval, so the arguments must be
+     * constants and a bad combination does not build.
+     */
+    struct Pins {
+
+        uint clock_pin;
+        uint data_pin_base;
+        uint pio_irq_index;
+        uint dma_irq_index;
+        uint rate_pin;
+
+        /**
+         * @param clock GPIO connected to every chip's PD_SCK
+         * @param data_base lowest of N consecutive DOUT GPIOs
+         * @param pio_irq index of the PIO IRQ to use
+         * @param dma_irq index of the DMA IRQ to use
+         * @param rate GPIO connected to every chip's RATE pin,
+         * or HX711_NO_RATE_PIN
+         */
+        consteval Pins(
+            const uint clock,
+            const uint data_base,
+            const uint pio_irq = 0,
+            const uint dma_irq = 0,
+            const uint rate = HX711_NO_RATE_PIN)
+                :   clock_pin(clock),
+                    data_pin_base(data_base),
+                    pio_irq_index(pio_irq),
+                    dma_irq_index(dma_irq),
+                    rate_pin(rate) {
+
+                    if(clock >= NUM_BANK0_GPIOS) {
+                        detail::clock_pin_out_of_range();
+                    }
+
+                    if(data_base + N > NUM_BANK0_GPIOS) {
+                        detail::data_pins_out_of_range();
+                    }
+
+                    if(clock >= data_base && clock < data_base + N) {
+                        detail::clock_pin_is_a_data_pin();
+                    }
+
+                    if(rate != HX711_NO_RATE_PIN) {
+                        if(rate >= NUM_BANK0_GPIOS) {
+                            detail::rate_pin_out_of_range();
+                        }
+                        if(rate == clock || (rate >= data_base && rate < data_base + N)) {
+                            detail::rate_pin_is_in_use();
+                        }
+                    }
+
+                    if(pio_irq > UTIL_PIO_IRQ_INDEX_MAX) {
+                        detail::pio_irq_index_out_of_range();
+                    }
+
+                    if(dma_irq > UTIL_DMA_IRQ_INDEX_MAX) {
+                        detail::dma_irq_index_out_of_range();
+                    }
+
+        }
+
+    };
+
+    /**
+     * @brief Initialise the chips with the default
+     * configuration and the given pins.
+     * 
+     * @param pins 
+     * @param pio pio0 or pio1, or nullptr for the default
+     */
+    explicit Multi(
+        const Pins& pins,
+        const PIO pio = nullptr)
+            :   _hxm(new hx711_multi_t) {
+
+                hx711_multi_config_t cfg;
+                hx711_multi_get_default_config(&cfg);
+
+                cfg.clock_pin = pins.clock_pin;
+                cfg.data_pin_base = pins.data_pin_base;
+                cfg.chips_len = N;
+                cfg.rate_pin = pins.rate_pin;
+                cfg.pio_irq_index = pins.pio_irq_index;
+                cfg.dma_irq_index = pins.dma_irq_index;
+
+                if(pio != nullptr) {
+                    cfg.pio = pio;
+                }
+
+                hx711_multi_init(_hxm.get(), &cfg);
+
+    }
+
+    Multi(Multi&&) noexcept = default;
+    Multi& operator=(Multi&&) noexcept = default;
+    Multi(const Multi&) = delete;
+    Multi& operator=(const Multi&) = delete;
+
+    /**
+     * @brief Same as hx711_multi_power_up.
+     */
+    void power_up(const hx711_gain_t gain) {
+        hx711_multi_power_up(_hxm.get(), gain);
+    }
+
+    /**
+     * @brief Same as hx711_multi_power_down.
+     */
+    void power_down() {
+        hx711_multi_power_down(_hxm.get());
+    }
+
+    /**
+     * @brief Same as hx711_multi_set_gain.
+     */
+    void set_gain(const hx711_gain_t gain) {
+        hx711_multi_set_gain(_hxm.get(), gain);
+    }
+
+    /**
+     * @brief Block until a frame is read. Same as
+     * hx711_multi_get_values, with the unrolled decoder.
+     */
+    frame_t read() {
+        const frame_t values = wait();
+        hx711_multi_update_auto_rate(_hxm.get(), values.data());
+        hx711_multi_apply_auto_rate(_hxm.get());
+        return values;
+    }
+
+    /**
+     * @brief Same as hx711_multi_get_values_timeout.
+     * 
+     * @param values left unchanged on timeout
+     * @param timeout microseconds
+     * @return true 
+     * @return false if the timeout was reached
+     */
+    bool read(
+        frame_t& values,
+        const uint timeout) {
+            return hx711_multi_get_values_timeout(
+                _hxm.get(),
+                values.data(),
+                timeout);
+    }
+
+    /**
+     * @brief Fill frames with consecutive reads. A rate switch
+     * is applied after the last one, as with
+     * hx711_multi_get_values_avg.
+     * 
+     * @param frames 
+     */
+    void read(const std::span<frame_t> frames) {
+        for(frame_t& values : frames) {
+            values = wait();
+            hx711_multi_update_auto_rate(_hxm.get(), values.data());
+        }
+        hx711_multi_apply_auto_rate(_hxm.get());
+    }
+
+    /**
+     * @brief Same as hx711_multi_async_start.
+     */
+    void async_start() {
+        hx711_multi_async_start(_hxm.get());
+    }
+
+    /**
+     * @brief Same as hx711_multi_async_done.
+     */
+    bool async_done() {
+        return hx711_multi_async_done(_hxm.get());
+    }
+
+    /**
+     * @brief Same as hx711_multi_async_get_values, with the
+     * unrolled decoder.
+     */
+    frame_t async_get() {
+        return async_get_values<N>(_hxm.get());
+    }
+
+    /**
+     * @brief Decode a raw frame, eg. from
+     * hx711_multi_async_take_frame or a
+     * hx711_multi_frame_cb_t, with the unrolled decoder for
+     * N chips. No filters are applied.
+     * 
+     * @param pinvals 
+     * @return frame_t 
+     */
+    static frame_t decode(const RawFrame pinvals) {
+        return hx711::decode<N>(pinvals);
+    }
+
+    /**
+     * @brief The underlying hx711_multi_t, for the rest of the
+     * C API. It stays owned by this object.
+     */
+    hx711_multi_t* get() const noexcept {
+        return _hxm.get();
+    }
+
+private:
+
+    std::unique_ptr<hx711_multi_t, detail::Closer> _hxm;
+
+    /**
+     * @brief Start an async read, spin until it is done and
+     * return its values.
+     */
+    frame_t wait() {
+
+        hx711_multi_t* const hxm = _hxm.get();
+
+#ifdef HX711_STATS
+        const std::uint32_t spinStart = time_us_32();
+#endif
+
+        hx711_multi_async_start(hxm);
+        while(!hx711_multi_async_done(hxm)) {
+            tight_loop_contents();
+        }
+
+        HX711_STATS_ADD(
+            hxm->_stats,
+            spin_us,
+            time_us_32() - spinStart);
+
+        return async_get_values<N>(hxm);
+
+    }
+
+};
+
+}
+
+#endif
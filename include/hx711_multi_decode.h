@@ -0,0 +1,108 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_MULTI_DECODE_H_9215AE98_AADE_45FA_986A_C0C9F123A200
+#define HX711_MULTI_DECODE_H_9215AE98_AADE_45FA_986A_C0C9F123A200
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/platform.h"
+#include "hx711.h"
+#include "hx711_decode.h"
+#include "hx711_multi.h"
+#include "util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static_assert(
+    HX711_DECODE_BITS == HX711_READ_BITS,
+    "decode width does not match HX711_READ_BITS");
+
+/**
+ * @brief Decode body shared by hx711_multi_pinvals_to_values
+ * and the fixed chip count decoders. It is always inlined so
+ * that when len is a compile-time constant both loops are
+ * fully unrolled.
+ * 
+ * @param pinvals 
+ * @param values 
+ * @param len 
+ */
+static __force_inline void hx711_multi__pinvals_to_values_inline(
+    const uint32_t* const pinvals,
+    int32_t* const values,
+    const size_t len) {
+
+        hx711_decode_pinvals(pinvals, values, len);
+
+}
+
+/**
+ * @brief Declare hx711_multi_pinvals_to_values_N for a fixed
+ * number of chips N.
+ */
+#define HX711_MULTI_DECLARE_PINVALS_TO_VALUES(N) \
+    void hx711_multi_pinvals_to_values_ ## N( \
+        const uint32_t* const pinvals, \
+        int32_t* const values);
+
+/**
+ * @brief Define hx711_multi_pinvals_to_values_N for a fixed
+ * number of chips N. The function is fully unrolled and placed
+ * according to the hot path policy (SRAM by default; see
+ * UTIL_HOT_FUNC). Use this once, in one source file, for each chip
+ * count needed.
+ * 
+ * @example HX711_MULTI_DEFINE_PINVALS_TO_VALUES(4)
+ * //...
+ * hx711_multi_pinvals_to_values_4(frame, values);
+ */
+#define HX711_MULTI_DEFINE_PINVALS_TO_VALUES(N) \
+    static_assert( \
+        (N) >= HX711_MULTI_MIN_CHIPS && (N) <= HX711_MULTI_MAX_CHIPS, \
+        "chip count out of range"); \
+    void UTIL_HOT_FUNC(hx711_multi_pinvals_to_values_ ## N)( \
+        const uint32_t* const pinvals, \
+        int32_t* const values) { \
+            assert(pinvals != NULL); \
+            assert(values != NULL); \
+            hx711_multi__pinvals_to_values_inline(pinvals, values, (N)); \
+    }
+
+/**
+ * @brief Convert pinvals to values, using the unrolled decoder
+ * when len is a compile-time constant and
+ * hx711_multi_pinvals_to_values otherwise.
+ */
+#define HX711_MULTI_PINVALS_TO_VALUES(pinvals, values, len) \
+    (__builtin_constant_p(len) \
+        ? hx711_multi__pinvals_to_values_inline((pinvals), (values), (len)) \
+        : hx711_multi_pinvals_to_values((pinvals), (values), (len)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -17,7 +17,7 @@
 
 #define hx711_multi_reader_HZ 10000000
 
-#define hx711_multi_reader_offset_bitloop_in_pins_bit_count 9u
+#define hx711_multi_reader_offset_bitloop_in_pins_bit_count 8u
 
 static const uint16_t hx711_multi_reader_program_instructions[] = {
     0xe020, //  0: set    x, 0                       
@@ -25,19 +25,19 @@ static const uint16_t hx711_multi_reader_program_instructions[] = {
     0x6020, //  2: out    x, 32                      
             //     .wrap_target
     0xe057, //  3: set    y, 23                      
-    0x4060, //  4: in     null, 32                   
-    0x8000, //  5: push   noblock                    
-    0x20c4, //  6: wait   1 irq, 4                   
-    0xc040, //  7: irq    clear 0                    
-    0xe001, //  8: set    pins, 1                    
-    0x4001, //  9: in     pins, 1                    
-    0x8000, // 10: push   noblock                    
-    0x1088, // 11: jmp    y--, 8          side 0     
-    0xc000, // 12: irq    nowait 0                   
-    0x9880, // 13: pull   noblock         side 1     
-    0x6020, // 14: out    x, 32                      
-    0x1023, // 15: jmp    !x, 3           side 0     
-    0xa041, // 16: mov    y, x                       
+    0xa0c3, //  4: mov    isr, null                  
+    0x20c4, //  5: wait   1 irq, 4                   
+    0xc040, //  6: irq    clear 0                    
+    0xe001, //  7: set    pins, 1                    
+    0x4001, //  8: in     pins, 1                    
+    0x8000, //  9: push   noblock                    
+    0x1087, // 10: jmp    y--, 7          side 0     
+    0xc000, // 11: irq    nowait 0                   
+    0x9880, // 12: pull   noblock         side 1     
+    0x6020, // 13: out    x, 32                      
+    0x1023, // 14: jmp    !x, 3           side 0     
+    0xa041, // 15: mov    y, x                       
+    0x0091, // 16: jmp    y--, 17                    
     0xe101, // 17: set    pins, 1                [1] 
     0x1191, // 18: jmp    y--, 17         side 0 [1] 
             //     .wrap
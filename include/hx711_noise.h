@@ -0,0 +1,138 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_NOISE_H_BE7FDEA0_8761_4D28_94BB_A8920F5F2B32
+#define HX711_NOISE_H_BE7FDEA0_8761_4D28_94BB_A8920F5F2B32
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Running statistics of the values from one chip, for
+ * measuring noise.
+ * 
+ * The sum and sum of squares of each value's difference from
+ * the first value (the shifted-data method) are accumulated
+ * as exact integers, so there is no floating point or
+ * rounding error until a report is made, and the shift keeps
+ * the variance from cancelling when the values sit far from
+ * zero. Updating is O(1) and needs no buffer.
+ */
+typedef struct {
+    int32_t _ref;
+    uint32_t _count;
+    int64_t _sum;
+    uint64_t _sum_sq;
+    int32_t _min;
+    int32_t _max;
+    bool _overflow;
+} hx711_noise_t;
+
+typedef struct {
+
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+    float mean;
+    float variance;
+
+    /**
+     * @brief Standard deviation, in counts.
+     */
+    float rms;
+
+    /**
+     * @brief max - min, in counts.
+     */
+    uint32_t peak_to_peak;
+
+    /**
+     * @brief log2(2^24 / rms); effective resolution.
+     */
+    float effective_bits;
+
+    /**
+     * @brief log2(2^24 / peak_to_peak); noise-free resolution.
+     */
+    float noise_free_bits;
+
+    /**
+     * @brief True if values stopped being accumulated because
+     * the sums would have overflowed. The report then covers
+     * the first count values.
+     */
+    bool overflow;
+
+} hx711_noise_report_t;
+
+/**
+ * @brief Clear a noise accumulator.
+ * 
+ * @param n 
+ */
+void hx711_noise_init(hx711_noise_t* const n);
+
+/**
+ * @brief Add a value.
+ * 
+ * @param n 
+ * @param val 
+ */
+void hx711_noise_add(
+    hx711_noise_t* const n,
+    const int32_t val);
+
+/**
+ * @brief Add a frame of values, one accumulator per chip, eg.
+ * straight after hx711_multi_get_values.
+ * 
+ * @param ns array of len accumulators
+ * @param values 
+ * @param len 
+ */
+void hx711_noise_add_multi(
+    hx711_noise_t* const ns,
+    const int32_t* const values,
+    const size_t len);
+
+/**
+ * @brief Compute statistics from the values added so far.
+ * 
+ * @param n 
+ * @param report 
+ * @return true if at least 2 values have been added
+ * @return false 
+ */
+bool hx711_noise_get_report(
+    const hx711_noise_t* const n,
+    hx711_noise_report_t* const report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,173 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_NOTCH_H_6B3EFEE2_927D_45E3_AD8F_98EC96D5908F
+#define HX711_NOTCH_H_6B3EFEE2_927D_45E3_AD8F_98EC96D5908F
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fractional bits of notch filter coefficients.
+ */
+#define HX711_NOTCH_COEFF_BITS          UINT8_C(28)
+
+/**
+ * @brief Number of samples averaged by the comb filter used
+ * at 10 SPS.
+ */
+#define HX711_NOTCH_COMB_LEN            UINT8_C(4)
+
+typedef enum {
+    hx711_mains_50 = 0,
+    hx711_mains_60
+} hx711_mains_t;
+
+/**
+ * @brief Biquad coefficients scaled by 2^HX711_NOTCH_COEFF_BITS.
+ * y[n] = b0x[n] + b1x[n-1] + b2x[n-2] - a1y[n-1] - a2y[n-2]
+ */
+typedef struct {
+    int32_t b0;
+    int32_t b1;
+    int32_t b2;
+    int32_t a1;
+    int32_t a2;
+} hx711_notch_coeffs_t;
+
+/**
+ * @brief Per-chip mains hum filter.
+ * 
+ * At 80 SPS, 50Hz aliases to 30Hz and 60Hz to 20Hz, so a
+ * biquad notch (Q = 2) is placed there. At 10 SPS both alias
+ * to DC, where the HX711's own filter already has its nulls;
+ * what remains is a slow beat which depends on the chip's
+ * oscillator, so a comb (moving average of
+ * HX711_NOTCH_COMB_LEN samples, with nulls at 2.5Hz and 5Hz)
+ * is used instead.
+ */
+typedef struct {
+    hx711_mains_t _mains;
+    bool _comb;
+    bool _primed;
+    hx711_notch_coeffs_t _coeffs;
+    int32_t _x1;
+    int32_t _x2;
+    int32_t _y1;
+    int32_t _y2;
+    int32_t _comb_buf[HX711_NOTCH_COMB_LEN];
+    int32_t _comb_sum;
+    uint8_t _comb_idx;
+} hx711_notch_t;
+
+/**
+ * @brief Precomputed notch coefficients at 80 SPS, indexed by
+ * hx711_mains_t.
+ */
+extern const hx711_notch_coeffs_t HX711_NOTCH_COEFFS_80[2];
+
+/**
+ * @brief Initialise a filter for one of the HX711's sample
+ * rates using precomputed coefficients.
+ * 
+ * @param n 
+ * @param sps 10 or 80, eg. from hx711_get_rate_sps
+ * @param mains 
+ */
+void hx711_notch_init(
+    hx711_notch_t* const n,
+    const uint8_t sps,
+    const hx711_mains_t mains);
+
+/**
+ * @brief Initialise a notch filter for a measured sample rate
+ * (eg. when the HX711 is clocked from an external crystal).
+ * Coefficients are computed once here using floating point;
+ * filtering remains integer-only. A rate switch through
+ * hx711_set_rate or hx711_multi_set_rate replaces the custom
+ * tuning with hx711_notch_init's.
+ * 
+ * @param n 
+ * @param sps measured samples per second
+ * @param hum_hz mains frequency
+ * @param q notch quality factor; higher is narrower
+ * @return true if the aliased hum frequency is far enough
+ * from DC to place a notch
+ * @return false if it is not (the filter is left as a comb)
+ */
+bool hx711_notch_init_custom(
+    hx711_notch_t* const n,
+    const float sps,
+    const float hum_hz,
+    const float q);
+
+/**
+ * @brief The mains setting the filter was initialised for, so
+ * it can be initialised again for another sample rate. For a
+ * custom filter this is the nearer of 50Hz and 60Hz.
+ * 
+ * @param n 
+ * @return hx711_mains_t 
+ */
+hx711_mains_t hx711_notch_get_mains(const hx711_notch_t* const n);
+
+/**
+ * @brief Clear the filter's history, eg. after changing gain.
+ * The next value primes the filter.
+ * 
+ * @param n 
+ */
+void hx711_notch_reset(hx711_notch_t* const n);
+
+/**
+ * @brief Filter a single value.
+ * 
+ * @param n 
+ * @param val 
+ * @return int32_t 
+ */
+int32_t hx711_notch_filter(
+    hx711_notch_t* const n,
+    const int32_t val);
+
+/**
+ * @brief Filter len values in place, one filter per value.
+ * 
+ * @param ns array of len filters
+ * @param values 
+ * @param len 
+ */
+void hx711_notch_filter_multi(
+    hx711_notch_t* const ns,
+    int32_t* const values,
+    const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,280 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_PLATFORM_H_A98F0A0F_4AA8_4E63_BF99_8581E0BA6DCA
+#define HX711_PLATFORM_H_A98F0A0F_4AA8_4E63_BF99_8581E0BA6DCA
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hx711_multi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most load cells a platform can have.
+ */
+#ifndef HX711_PLATFORM_MAX_CELLS
+    #define HX711_PLATFORM_MAX_CELLS    UINT8_C(8)
+#endif
+
+/**
+ * @brief Fractional bits of a cell trim. A trim of
+ * HX711_PLATFORM_TRIM_ONE leaves a cell unchanged.
+ */
+#define HX711_PLATFORM_TRIM_Q           16
+#define HX711_PLATFORM_TRIM_ONE         (INT32_C(1) << HX711_PLATFORM_TRIM_Q)
+
+/**
+ * @brief Where a cell sits on the platform, in any unit (eg.
+ * mm from the centre).
+ */
+typedef struct {
+    int32_t x;
+    int32_t y;
+} hx711_platform_pos_t;
+
+typedef struct {
+
+    /**
+     * @brief Position of each cell, in chip order.
+     */
+    const hx711_platform_pos_t* positions;
+
+    /**
+     * @brief Number of cells; the same as the number of chips
+     * of the hx711_multi_t the frames come from.
+     */
+    size_t len;
+
+    /**
+     * @brief Smallest magnitude of the total (in trimmed
+     * counts) for which a centre of gravity is calculated.
+     * Below this it is too noisy to mean anything. A negative
+     * total (eg. cells mounted in tension) counts by its
+     * magnitude.
+     */
+    int32_t cog_min_total;
+
+} hx711_platform_config_t;
+
+typedef struct {
+
+    /**
+     * @brief Sum of trimmed, tared cell values, in counts.
+     * See hx711_platform_get_mass.
+     */
+    int64_t total;
+
+    /**
+     * @brief Centre of gravity, in the unit of the cell
+     * positions. Only meaningful when cog_valid.
+     */
+    int32_t x;
+    int32_t y;
+
+    bool cog_valid;
+
+} hx711_platform_result_t;
+
+/**
+ * @brief Several load cells under one platform, read as one
+ * hx711_multi_t.
+ * 
+ * Each frame is decoded, tared, trimmed and summed in a
+ * single fixed-point pass, giving the total load and where on
+ * the platform it sits. The per-cell trims correct for
+ * corner-to-corner differences so the total does not depend
+ * on where the load is placed; hx711_platform_calibrate finds
+ * them from a few off-centre test loads.
+ */
+typedef struct {
+    size_t _len;
+    int32_t _cog_min_total;
+    hx711_platform_pos_t _pos[HX711_PLATFORM_MAX_CELLS];
+    int32_t _offset[HX711_PLATFORM_MAX_CELLS];
+    int32_t _trim[HX711_PLATFORM_MAX_CELLS];
+    float _scale;
+} hx711_platform_t;
+
+/**
+ * @brief Initialise a platform with zero offsets, unit trims
+ * and a scale of 1.
+ * 
+ * @param p 
+ * @param config 
+ */
+void hx711_platform_init(
+    hx711_platform_t* const p,
+    const hx711_platform_config_t* const config);
+
+/**
+ * @brief Set each cell's offset from raw values read with no
+ * load on the platform (eg. from hx711_multi_get_values_avg).
+ * 
+ * @param p 
+ * @param values one per cell
+ */
+void hx711_platform_tare(
+    hx711_platform_t* const p,
+    const int32_t* const values);
+
+/**
+ * @brief Set the cell trims and scale directly, eg. ones
+ * saved from an earlier hx711_platform_calibrate.
+ * 
+ * @param p 
+ * @param trims one per cell, HX711_PLATFORM_TRIM_Q fixed-point
+ * @param scale counts per unit of mass
+ */
+void hx711_platform_set_trims(
+    hx711_platform_t* const p,
+    const int32_t* const trims,
+    const float scale);
+
+/**
+ * @brief Get the cell trims and scale.
+ * 
+ * @param p 
+ * @param trims one per cell
+ * @param scale may be NULL
+ */
+void hx711_platform_get_trims(
+    const hx711_platform_t* const p,
+    int32_t* const trims,
+    float* const scale);
+
+/**
+ * @brief Work out the cell trims and scale by least squares
+ * from readings of known masses placed at different points on
+ * the platform. The platform must be tared first. There must
+ * be at least as many loads as cells, spread so each cell
+ * takes a different share (eg. one near each corner and one
+ * in the middle).
+ * 
+ * @param p 
+ * @param values loads_len rows of one raw value per cell,
+ * ideally each an average of several reads
+ * @param masses mass of each load
+ * @param loads_len 
+ * @return true if trims were found and applied
+ * @return false if the loads did not determine every trim,
+ * or the cells do not all read with the same sign under load
+ */
+bool hx711_platform_calibrate(
+    hx711_platform_t* const p,
+    const int32_t* const values,
+    const float* const masses,
+    const size_t loads_len);
+
+/**
+ * @brief Tare, trim and sum a frame of raw values.
+ * 
+ * @param p 
+ * @param values one per cell
+ * @param result 
+ */
+void hx711_platform_process_values(
+    const hx711_platform_t* const p,
+    const int32_t* const values,
+    hx711_platform_result_t* const result);
+
+/**
+ * @brief Decode a raw hx711_multi_t frame with the library's
+ * decoder, then tare, trim and sum it as
+ * hx711_platform_process_values does. Suitable for frames
+ * from hx711_multi_async_take_frame or a replay.
+ * 
+ * @param p 
+ * @param pinvals 
+ * @param result 
+ */
+void hx711_platform_process_frame(
+    const hx711_platform_t* const p,
+    const uint32_t* const pinvals,
+    hx711_platform_result_t* const result);
+
+/**
+ * @brief Read one frame from hxm and process it with
+ * hx711_platform_process_frame from the DMA IRQ handler.
+ * Blocks until done. Glitch and mains hum filters attached to
+ * hxm are not applied.
+ * 
+ * @param p 
+ * @param hxm 
+ * @param result 
+ */
+void hx711_platform_read(
+    const hx711_platform_t* const p,
+    hx711_multi_t* const hxm,
+    hx711_platform_result_t* const result);
+
+/**
+ * @brief Convert a total to a mass using the scale.
+ * 
+ * @param p 
+ * @param result 
+ * @return float 
+ */
+float hx711_platform_get_mass(
+    const hx711_platform_t* const p,
+    const hx711_platform_result_t* const result);
+
+/**
+ * @brief Fill in the centre of gravity from the weighted
+ * position sums.
+ * 
+ * @param p 
+ * @param total 
+ * @param sx 
+ * @param sy 
+ * @param result 
+ */
+static void hx711_platform__finish(
+    const hx711_platform_t* const p,
+    const int64_t total,
+    const int64_t sx,
+    const int64_t sy,
+    hx711_platform_result_t* const result);
+
+/**
+ * @brief Frame callback used by hx711_platform_read.
+ * 
+ * @param hxm 
+ * @param frame 
+ * @param values 
+ * @param ctx 
+ * @return false always; only one frame is needed
+ */
+static bool hx711_platform__on_frame(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
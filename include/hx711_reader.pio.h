@@ -13,7 +13,7 @@
 // ------------ //
 
 #define hx711_reader_wrap_target 3
-#define hx711_reader_wrap 13
+#define hx711_reader_wrap 14
 
 #define hx711_reader_HZ 10000000
 
@@ -31,15 +31,16 @@ static const uint16_t hx711_reader_program_instructions[] = {
     0x6020, //  9: out    x, 32                      
     0x1023, // 10: jmp    !x, 3           side 0     
     0xa041, // 11: mov    y, x                       
-    0xe101, // 12: set    pins, 1                [1] 
-    0x118c, // 13: jmp    y--, 12         side 0 [1] 
+    0x008d, // 12: jmp    y--, 13                    
+    0xe101, // 13: set    pins, 1                [1] 
+    0x118d, // 14: jmp    y--, 13         side 0 [1] 
             //     .wrap
 };
 
 #if !PICO_NO_HARDWARE
 static const struct pio_program hx711_reader_program = {
     .instructions = hx711_reader_program_instructions,
-    .length = 14,
+    .length = 15,
     .origin = -1,
 };
 
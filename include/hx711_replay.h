@@ -0,0 +1,227 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_REPLAY_H_C28EA96A_A252_4B98_A3B1_3AC63490D540
+#define HX711_REPLAY_H_C28EA96A_A252_4B98_A3B1_3AC63490D540
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Identifies a recording ("HXRP").
+ */
+#define HX711_REPLAY_MAGIC              UINT32_C(0x50525848)
+
+#define HX711_REPLAY_VERSION            UINT8_C(1)
+
+/**
+ * @brief Words in a raw hx711_multi_t frame; one per bit of a
+ * conversion, most significant first.
+ */
+#define HX711_REPLAY_FRAME_WORDS        UINT8_C(24)
+
+/**
+ * @brief A recording of raw hx711_multi_t frames (pinvals).
+ */
+#define HX711_REPLAY_KIND_MULTI         UINT8_C(1)
+
+/**
+ * @brief A recording of raw 24 bit words from a hx711_t.
+ */
+#define HX711_REPLAY_KIND_SINGLE        UINT8_C(2)
+
+/**
+ * @brief Start of a recording (little endian, 16 bytes).
+ * After it come the records: for HX711_REPLAY_KIND_MULTI a
+ * 32 bit timestamp followed by HX711_REPLAY_FRAME_WORDS 32
+ * bit words; for HX711_REPLAY_KIND_SINGLE a 32 bit timestamp
+ * followed by one 32 bit word.
+ */
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t kind;
+    uint8_t chips_len;
+    uint8_t reserved;
+    uint32_t reserved2[2];
+} hx711_replay_header_t;
+
+/**
+ * @brief Receives the bytes of a recording, eg. writing them
+ * to a file, a hx711_log_t or stdio.
+ */
+typedef bool (*hx711_replay_write_t)(
+    void* ctx,
+    const void* buf,
+    size_t len);
+
+/**
+ * @brief Records raw frames exactly as the PIO produced them,
+ * so decoding and any processing stages can be rerun later
+ * against real data (see hx711_replay_src_t).
+ */
+typedef struct {
+    hx711_replay_write_t _write;
+    void* _ctx;
+    uint8_t _kind;
+    uint8_t _chips_len;
+} hx711_replay_rec_t;
+
+/**
+ * @brief Plays back a recording held in memory (eg. a file
+ * read in on a host, or data in flash on the device).
+ */
+typedef struct {
+    const uint8_t* _data;
+    size_t _len;
+    size_t _pos;
+    uint8_t _kind;
+    uint8_t _chips_len;
+} hx711_replay_src_t;
+
+/**
+ * @brief Start a recording by writing its header.
+ * 
+ * @param rec 
+ * @param kind HX711_REPLAY_KIND_*
+ * @param chips_len number of chips for a multi recording; 1
+ * for a single recording
+ * @param write 
+ * @param ctx passed to write
+ * @return true 
+ * @return false if write failed
+ */
+bool hx711_replay_rec_init(
+    hx711_replay_rec_t* const rec,
+    const uint8_t kind,
+    const uint8_t chips_len,
+    hx711_replay_write_t write,
+    void* const ctx);
+
+/**
+ * @brief Record a raw hx711_multi_t frame, eg. from a frame
+ * callback or hx711_multi_async_take_frame.
+ * 
+ * @param rec 
+ * @param timestamp eg. time_us_32()
+ * @param pinvals HX711_REPLAY_FRAME_WORDS words
+ * @return true 
+ * @return false if write failed
+ */
+bool hx711_replay_rec_frame(
+    hx711_replay_rec_t* const rec,
+    const uint32_t timestamp,
+    const uint32_t* const pinvals);
+
+/**
+ * @brief Record a raw word from a hx711_t. A value from
+ * hx711_get_value can be recorded as
+ * (uint32_t)value & 0xffffff without losing anything.
+ * 
+ * @param rec 
+ * @param timestamp 
+ * @param raw 
+ * @return true 
+ * @return false if write failed
+ */
+bool hx711_replay_rec_raw(
+    hx711_replay_rec_t* const rec,
+    const uint32_t timestamp,
+    const uint32_t raw);
+
+/**
+ * @brief Open a recording.
+ * 
+ * @param src 
+ * @param data 
+ * @param len 
+ * @return true 
+ * @return false if the header is missing or not understood
+ */
+bool hx711_replay_src_init(
+    hx711_replay_src_t* const src,
+    const void* const data,
+    const size_t len);
+
+/**
+ * @brief Returns the kind of recording.
+ * 
+ * @param src 
+ * @return uint8_t HX711_REPLAY_KIND_*
+ */
+uint8_t hx711_replay_src_get_kind(const hx711_replay_src_t* const src);
+
+/**
+ * @brief Returns the number of chips recorded.
+ * 
+ * @param src 
+ * @return uint8_t 
+ */
+uint8_t hx711_replay_src_get_chips_len(const hx711_replay_src_t* const src);
+
+/**
+ * @brief Go back to the first record.
+ * 
+ * @param src 
+ */
+void hx711_replay_src_rewind(hx711_replay_src_t* const src);
+
+/**
+ * @brief Get the next frame of a multi recording. Pass the
+ * frame to hx711_multi_pinvals_to_values to decode it.
+ * 
+ * @param src 
+ * @param timestamp 
+ * @param pinvals HX711_REPLAY_FRAME_WORDS words
+ * @return true 
+ * @return false at the end of the recording
+ */
+bool hx711_replay_src_next_frame(
+    hx711_replay_src_t* const src,
+    uint32_t* const timestamp,
+    uint32_t* const pinvals);
+
+/**
+ * @brief Get the next word of a single recording. Pass it to
+ * hx711_get_twos_comp to decode it.
+ * 
+ * @param src 
+ * @param timestamp 
+ * @param raw 
+ * @return true 
+ * @return false at the end of the recording
+ */
+bool hx711_replay_src_next_raw(
+    hx711_replay_src_t* const src,
+    uint32_t* const timestamp,
+    uint32_t* const raw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_STABILITY_H_1FEDABA3_03BC_4DAA_9719_16F97EFB9535
+#define HX711_STABILITY_H_1FEDABA3_03BC_4DAA_9719_16F97EFB9535
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+
+    /**
+     * @brief Largest spread (max - min) of consecutive values
+     * which still counts as stable.
+     */
+    int32_t threshold;
+
+    /**
+     * @brief Number of consecutive values within threshold of
+     * each other before the load is considered stable.
+     */
+    uint16_t stable_count;
+
+} hx711_stability_config_t;
+
+/**
+ * @brief Incremental motion/stability detector.
+ * 
+ * Tracks the min and max of the current run of values. When a
+ * value widens the spread beyond the threshold a new run
+ * starts at that value. The load is stable once a run reaches
+ * stable_count values. This is O(1) per value and needs no
+ * buffer.
+ */
+typedef struct {
+    int32_t _threshold;
+    uint16_t _stable_count;
+    uint16_t _run;
+    bool _started;
+    int32_t _min;
+    int32_t _max;
+} hx711_stability_t;
+
+/**
+ * @brief Fill config with defaults: a threshold of 1000 and
+ * 8 values.
+ * 
+ * @param config 
+ */
+void hx711_stability_get_default_config(hx711_stability_config_t* const config);
+
+/**
+ * @brief Initialise a detector. It starts out unstable.
+ * 
+ * @param s 
+ * @param config 
+ */
+void hx711_stability_init(
+    hx711_stability_t* const s,
+    const hx711_stability_config_t* const config);
+
+/**
+ * @brief Forget the current run.
+ * 
+ * @param s 
+ */
+void hx711_stability_reset(hx711_stability_t* const s);
+
+/**
+ * @brief Forget the current run and start out stable or
+ * unstable. A detector seeded stable stays stable until a
+ * value moves more than threshold from the first one it sees
+ * after this.
+ * 
+ * @param s 
+ * @param stable 
+ */
+void hx711_stability_seed(
+    hx711_stability_t* const s,
+    const bool stable);
+
+/**
+ * @brief Add a value.
+ * 
+ * @param s 
+ * @param val 
+ * @return true if the load is now stable
+ * @return false 
+ */
+bool hx711_stability_update(
+    hx711_stability_t* const s,
+    const int32_t val);
+
+/**
+ * @brief Whether the load was stable as of the last value.
+ * 
+ * @param s 
+ * @return true 
+ * @return false 
+ */
+bool hx711_stability_is_stable(const hx711_stability_t* const s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_STATS_H_EA46E4F4_99E4_4C10_B323_33DD952B7E59
+#define HX711_STATS_H_EA46E4F4_99E4_4C10_B323_33DD952B7E59
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Counters describing the read path of a hx711_t or
+ * hx711_multi_t. Only compiled in when the HX711_STATS
+ * preprocessor flag is defined.
+ * 
+ * @note isr_cycles, isr_cycles_max and decode_cycles are
+ * measured with the SysTick counter of the core which handles
+ * the IRQs. isr_cycles, isr_cycles_max, spin_us and
+ * decode_cycles are always 0 for a hx711_t.
+ */
+typedef struct {
+
+    /**
+     * @brief Number of values (hx711_t) or frames
+     * (hx711_multi_t) successfully read.
+     */
+    uint32_t frames;
+
+    /**
+     * @brief Number of reads which did not complete within
+     * the given timeout.
+     */
+    uint32_t timeouts;
+
+    /**
+     * @brief Number of times the reader State Machine's RX
+     * FIFO was found to be full, meaning conversions were
+     * dropped before they could be read.
+     */
+    uint32_t overruns;
+
+    /**
+     * @brief Number of values at either the minimum or
+     * maximum HX711 value.
+     */
+    uint32_t saturations;
+
+    /**
+     * @brief Number of PIO and DMA IRQs handled.
+     */
+    uint32_t isr_count;
+
+    /**
+     * @brief Total processor cycles spent in the IRQ
+     * handlers.
+     */
+    uint32_t isr_cycles;
+
+    /**
+     * @brief Longest time spent in a single IRQ handler,
+     * in processor cycles.
+     */
+    uint32_t isr_cycles_max;
+
+    /**
+     * @brief Total time hx711_multi_get_values and
+     * hx711_multi_get_values_timeout spent busy-waiting for a
+     * frame, in microseconds. IRQ handlers which ran in the
+     * meantime on the same core are included.
+     */
+    uint32_t spin_us;
+
+    /**
+     * @brief Total processor cycles spent in
+     * hx711_multi_async_get_values converting and filtering
+     * frames.
+     */
+    uint32_t decode_cycles;
+
+} hx711_stats_t;
+
+#ifdef HX711_STATS
+    #define HX711_STATS_INC(stats, field) \
+        do { \
+            ++(stats).field; \
+        } while(0)
+
+    #define HX711_STATS_RECORD_VALUE(stats, val) \
+        do { \
+            ++(stats).frames; \
+            if((val) == HX711_MIN_VALUE || (val) == HX711_MAX_VALUE) { \
+                ++(stats).saturations; \
+            } \
+        } while(0)
+
+    #define HX711_STATS_ADD_ISR(stats, cycles) \
+        do { \
+            ++(stats).isr_count; \
+            (stats).isr_cycles += (cycles); \
+            if((cycles) > (stats).isr_cycles_max) { \
+                (stats).isr_cycles_max = (cycles); \
+            } \
+        } while(0)
+
+    #define HX711_STATS_ADD(stats, field, n) \
+        do { \
+            (stats).field += (n); \
+        } while(0)
+#else
+    #define HX711_STATS_INC(stats, field) \
+        do { \
+        } while(0)
+
+    #define HX711_STATS_RECORD_VALUE(stats, val) \
+        do { \
+        } while(0)
+
+    #define HX711_STATS_ADD_ISR(stats, cycles) \
+        do { \
+        } while(0)
+
+    #define HX711_STATS_ADD(stats, field, n) \
+        do { \
+        } while(0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
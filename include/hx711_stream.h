@@ -0,0 +1,271 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_STREAM_H_CBDF5D21_DFD7_4054_BB46_057BEDA4478B
+#define HX711_STREAM_H_CBDF5D21_DFD7_4054_BB46_057BEDA4478B
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief First byte of every frame. Changes if the layout
+ * does.
+ */
+#define HX711_STREAM_VERSION            UINT8_C(1)
+
+/**
+ * @brief Most values a frame can carry.
+ */
+#define HX711_STREAM_MAX_CHIPS          UINT8_C(32)
+
+/**
+ * @brief Bytes in a frame before COBS encoding: version,
+ * chip count, sequence number, timestamp, 3 bytes per value
+ * and the CRC.
+ */
+#define HX711_STREAM_FRAME_LEN(chips)   (1 + 1 + 4 + 4 + 3 * (chips) + 4)
+
+/**
+ * @brief Most bytes a frame takes on the wire, including the
+ * COBS overhead and the zero byte delimiting it.
+ */
+#define HX711_STREAM_ENCODED_MAX(chips) \
+    (HX711_STREAM_FRAME_LEN(chips) + (HX711_STREAM_FRAME_LEN(chips) / 254) + 2)
+
+/**
+ * @brief Size of each of the two buffers of a hx711_stream_t.
+ * Frames are written out whenever one fills, so a smaller
+ * buffer means less latency but more writes.
+ */
+#ifndef HX711_STREAM_BUF_LEN
+    #define HX711_STREAM_BUF_LEN        512
+#endif
+
+static_assert(HX711_STREAM_BUF_LEN >= HX711_STREAM_ENCODED_MAX(HX711_STREAM_MAX_CHIPS),
+    "HX711_STREAM_BUF_LEN must hold at least one frame");
+
+/**
+ * @brief Called with a full buffer to send. Only one write is
+ * ever in progress.
+ * 
+ * @return true if buf has been sent and may be reused
+ * @return false if the write carries on in the background (eg.
+ * by DMA); hx711_stream_write_done must then be called once it
+ * has finished
+ */
+typedef bool (*hx711_stream_write_t)(
+    void* ctx,
+    const uint8_t* buf,
+    size_t len);
+
+/**
+ * @brief Binary frame writer.
+ * 
+ * Each frame carries a sequence number, a timestamp and up to
+ * HX711_STREAM_MAX_CHIPS values packed into 3 bytes each,
+ * all little endian, followed by a CRC-32 (see hx711_crc32)
+ * of the preceding bytes. Frames are COBS encoded so they
+ * never contain a zero byte, and each is followed by a zero
+ * byte, so a reader can always find the start of the next
+ * frame after a lost or corrupted byte.
+ * 
+ * Frames are encoded straight into one of two buffers. When
+ * it fills it is handed to the write function and the other
+ * buffer is filled in the meantime. If that one fills too
+ * before the write has finished, frames are dropped (and
+ * counted) rather than overwriting the buffer being sent; the
+ * sequence number still counts them, so a reader sees the gap.
+ */
+typedef struct {
+    hx711_stream_write_t _write;
+    void* _ctx;
+    uint32_t _seq;
+    uint32_t _dropped;
+    volatile bool _busy;
+    uint8_t _active;
+    size_t _fill;
+    uint8_t _buf[2][HX711_STREAM_BUF_LEN];
+} hx711_stream_t;
+
+/**
+ * @brief COBS encode len bytes.
+ * 
+ * @param in 
+ * @param len 
+ * @param out must hold len + len / 254 + 1 bytes
+ * @return size_t bytes written, not including a delimiter
+ */
+size_t hx711_stream_cobs_encode(
+    const uint8_t* const in,
+    const size_t len,
+    uint8_t* const out);
+
+/**
+ * @brief COBS decode len bytes (without the delimiter).
+ * 
+ * @param in 
+ * @param len 
+ * @param out must hold len bytes
+ * @param out_len bytes written
+ * @return true 
+ * @return false if in is not valid COBS
+ */
+bool hx711_stream_cobs_decode(
+    const uint8_t* const in,
+    const size_t len,
+    uint8_t* const out,
+    size_t* const out_len);
+
+/**
+ * @brief Encode a frame, including its delimiter.
+ * 
+ * @param seq 
+ * @param timestamp eg. time_us_32()
+ * @param values 
+ * @param len number of values, up to HX711_STREAM_MAX_CHIPS
+ * @param out must hold HX711_STREAM_ENCODED_MAX(len) bytes
+ * @return size_t bytes written
+ */
+size_t hx711_stream_encode(
+    const uint32_t seq,
+    const uint32_t timestamp,
+    const int32_t* const values,
+    const size_t len,
+    uint8_t* const out);
+
+/**
+ * @brief Decode a frame.
+ * 
+ * @param in the bytes between two delimiters
+ * @param in_len 
+ * @param seq 
+ * @param timestamp 
+ * @param values must hold HX711_STREAM_MAX_CHIPS values
+ * @param len number of values decoded
+ * @return true 
+ * @return false if the frame is malformed or fails its CRC
+ */
+bool hx711_stream_decode(
+    const uint8_t* const in,
+    const size_t in_len,
+    uint32_t* const seq,
+    uint32_t* const timestamp,
+    int32_t* const values,
+    size_t* const len);
+
+/**
+ * @brief Initialise a writer.
+ * 
+ * @param s 
+ * @param write 
+ * @param ctx passed to write
+ */
+void hx711_stream_init(
+    hx711_stream_t* const s,
+    hx711_stream_write_t write,
+    void* const ctx);
+
+/**
+ * @brief Add a frame of values. The sequence number counts up
+ * from 0 with each frame. Only writes out if the current
+ * buffer is full. Never waits for a write to finish.
+ * 
+ * @param s 
+ * @param timestamp 
+ * @param values 
+ * @param len 
+ * @return true 
+ * @return false if the frame was dropped because the buffer
+ * is full and the previous write has not finished
+ */
+bool hx711_stream_write(
+    hx711_stream_t* const s,
+    const uint32_t timestamp,
+    const int32_t* const values,
+    const size_t len);
+
+/**
+ * @brief Write out whatever is buffered.
+ * 
+ * @param s 
+ * @return true if nothing was buffered or it has been handed
+ * to the write function
+ * @return false if the previous write has not finished yet;
+ * nothing is written
+ */
+bool hx711_stream_flush(hx711_stream_t* const s);
+
+/**
+ * @brief Tell the stream a write which returned false has
+ * finished, so its buffer can be reused. May be called from
+ * an interrupt handler.
+ * 
+ * @param s 
+ */
+void hx711_stream_write_done(hx711_stream_t* const s);
+
+/**
+ * @brief Whether a write is still in progress.
+ * 
+ * @param s 
+ * @return true 
+ * @return false 
+ */
+bool hx711_stream_is_busy(const hx711_stream_t* const s);
+
+/**
+ * @brief Number of frames dropped because both buffers were
+ * in use.
+ * 
+ * @param s 
+ * @return uint32_t 
+ */
+uint32_t hx711_stream_get_dropped(const hx711_stream_t* const s);
+
+/**
+ * @brief hx711_stream_write_t for the Pico SDK's stdio (USB
+ * CDC and/or UART). Bytes are written raw, without newline
+ * translation. This blocks until every byte is queued, so it
+ * always returns true; see hx711_stream_pico.h for a UART
+ * writer which does not block. ctx is unused.
+ * 
+ * @param ctx 
+ * @param buf 
+ * @param len 
+ * @return true 
+ */
+bool hx711_stream_pico_stdio_write(
+    void* ctx,
+    const uint8_t* buf,
+    size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
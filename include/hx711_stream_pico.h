@@ -0,0 +1,109 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_STREAM_PICO_H_7197E034_0D39_4320_966B_BDC23AD40358
+#define HX711_STREAM_PICO_H_7197E034_0D39_4320_966B_BDC23AD40358
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/uart.h"
+#include "pico/types.h"
+#include "hx711_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most UART DMA writers which can be open at once; one
+ * per UART.
+ */
+#define HX711_STREAM_PICO_UART_DMA_COUNT    NUM_UARTS
+
+/**
+ * @brief Non-blocking hx711_stream_t writer which sends each
+ * buffer to a UART by DMA. hx711_stream_write returns as soon
+ * as the transfer has started, and the DMA IRQ handler calls
+ * hx711_stream_write_done when the last byte is in the UART's
+ * TX FIFO.
+ */
+typedef struct {
+    uart_inst_t* _uart;
+    uint _dma_channel;
+    uint _dma_irq_index;
+    hx711_stream_t* _stream;
+} hx711_stream_pico_uart_dma_t;
+
+/**
+ * @brief Initialise s to write to an already initialised UART
+ * by DMA. A DMA channel is claimed, and a shared handler is
+ * added to the DMA IRQ given by dma_irq_index.
+ * 
+ * NOTE: hx711_multi_t installs an exclusive handler on its
+ * DMA IRQ, so use the other index (eg. 1 when hx711_multi_t
+ * uses the default of 0).
+ * 
+ * @param d 
+ * @param s stream to initialise
+ * @param uart 
+ * @param dma_irq_index 0 or 1
+ */
+void hx711_stream_pico_uart_dma_init(
+    hx711_stream_pico_uart_dma_t* const d,
+    hx711_stream_t* const s,
+    uart_inst_t* const uart,
+    const uint dma_irq_index);
+
+/**
+ * @brief Wait for any transfer to finish and release the DMA
+ * channel.
+ * 
+ * @param d 
+ */
+void hx711_stream_pico_uart_dma_close(hx711_stream_pico_uart_dma_t* const d);
+
+/**
+ * @brief hx711_stream_write_t which starts a DMA transfer to
+ * the UART.
+ * 
+ * @param ctx the hx711_stream_pico_uart_dma_t
+ * @param buf 
+ * @param len 
+ * @return false always; completion is signalled from the DMA
+ * IRQ handler
+ */
+bool hx711_stream_pico_uart_dma_write(
+    void* ctx,
+    const uint8_t* buf,
+    size_t len);
+
+/**
+ * @brief Shared DMA IRQ handler for UART DMA writers.
+ */
+static void hx711_stream_pico__uart_dma_irq_handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_TRACE_H_57B74974_5378_4C40_83E8_C8E19F254E15
+#define HX711_TRACE_H_57B74974_5378_4C40_83E8_C8E19F254E15
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of records held by the trace ring. Must be
+ * a power of 2. Once full, the oldest records are overwritten.
+ */
+#ifndef HX711_TRACE_LEN
+    #define HX711_TRACE_LEN                     UINT16_C(256)
+#endif
+
+/**
+ * @brief List of trace events as X(name, value) pairs. This
+ * list is shared with the host-side decoder, so values must
+ * never be reused.
+ */
+#define HX711_TRACE_EVENTS(X) \
+    X(NONE,         0) \
+    X(POWER_UP,     1) \
+    X(POWER_DOWN,   2) \
+    X(SET_GAIN,     3) \
+    X(ASYNC_START,  4) \
+    X(PIO_IRQ,      5) \
+    X(DMA_IRQ,      6) \
+    X(TIMEOUT,      7) \
+    X(SET_RATE,     8)
+
+#define HX711__TRACE_ENUM(name, value) HX711_TRACE_EVENT_ ## name = value,
+
+typedef enum {
+    HX711_TRACE_EVENTS(HX711__TRACE_ENUM)
+    HX711_TRACE_EVENT_COUNT
+} hx711_trace_event_t;
+
+#undef HX711__TRACE_ENUM
+
+/**
+ * @brief A single trace record. Records are stored and dumped
+ * as-is, so this layout is the binary format read by the
+ * host-side decoder (little endian, 8 bytes).
+ */
+typedef struct {
+
+    /**
+     * @brief Lower 32 bits of the microsecond timer.
+     */
+    uint32_t timestamp;
+
+    /**
+     * @brief hx711_trace_event_t
+     */
+    uint8_t event;
+
+    /**
+     * @brief Identifies the hx711_t or hx711_multi_t as
+     * (PIO index << 2) | reader State Machine.
+     */
+    uint8_t instance;
+
+    /**
+     * @brief Event-specific argument.
+     */
+    uint16_t arg;
+
+} hx711_trace_record_t;
+
+#define HX711_TRACE_INSTANCE(pio, sm) \
+    ((uint8_t)((pio_get_index(pio) << 2) | (sm)))
+
+#ifdef HX711_TRACE
+    #define HX711_TRACE_WRITE(event, instance, arg) \
+        hx711_trace_write( \
+            (event), \
+            (instance), \
+            (uint16_t)(arg))
+#else
+    #define HX711_TRACE_WRITE(event, instance, arg) \
+        do { \
+        } while(0)
+#endif
+
+/**
+ * @brief Claim a spin lock for the trace ring and clear it.
+ * Records written before this is called are discarded.
+ */
+void hx711_trace_init(void);
+
+/**
+ * @brief Remove all records from the trace ring.
+ */
+void hx711_trace_clear(void);
+
+/**
+ * @brief Add a record to the trace ring. Safe to call from
+ * either core and from ISRs.
+ * 
+ * @param event 
+ * @param instance 
+ * @param arg 
+ */
+void hx711_trace_write(
+    const hx711_trace_event_t event,
+    const uint8_t instance,
+    const uint16_t arg);
+
+/**
+ * @brief Copy records out of the trace ring, oldest first.
+ * The trace ring is not modified.
+ * 
+ * @param records 
+ * @param len maximum number of records to copy
+ * @return size_t number of records copied
+ */
+size_t hx711_trace_dump(
+    hx711_trace_record_t* const records,
+    const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
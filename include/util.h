@@ -23,11 +23,13 @@
 #ifndef UTIL_H_BC9FF78B_B978_444A_8AA1_FF169B09B09E
 #define UTIL_H_BC9FF78B_B978_444A_8AA1_FF169B09B09E
 
+#include <stddef.h>
 #include <stdint.h>
 #include "hardware/pio.h"
 #include "hardware/platform_defs.h"
 #include "hardware/sync.h"
 #include "pico/mutex.h"
+#include "pico/platform.h"
 #include "pico/types.h"
 
 #ifdef __cplusplus
@@ -79,6 +81,31 @@ extern "C" {
         restore_interrupts(interrupt_status_cb918069_eadf_49bc_9d8c_a8a4defad20c); \
     } while(0)
 
+/**
+ * @brief Place a function on the acquisition hot path. By
+ * default hot path functions are copied to SRAM so they never
+ * take an XIP cache miss in interrupt context. Define one of
+ * the following to change this:
+ * 
+ * HX711_HOT_PATH_SCRATCH_X: the 4kB SCRATCH_X bank
+ * HX711_HOT_PATH_SCRATCH_Y: the 4kB SCRATCH_Y bank (shared
+ * with core 0's stack)
+ * HX711_HOT_PATH_FLASH: leave in flash
+ * 
+ * @example void UTIL_HOT_FUNC(my_func)(void) { ... }
+ */
+#if defined(HX711_HOT_PATH_FLASH)
+    #define UTIL_HOT_FUNC(func_name) func_name
+#elif defined(HX711_HOT_PATH_SCRATCH_X)
+    #define UTIL_HOT_FUNC(func_name) \
+        __attribute__((section(".scratch_x.hx711." #func_name))) func_name
+#elif defined(HX711_HOT_PATH_SCRATCH_Y)
+    #define UTIL_HOT_FUNC(func_name) \
+        __attribute__((section(".scratch_y.hx711." #func_name))) func_name
+#else
+    #define UTIL_HOT_FUNC(func_name) __not_in_flash_func(func_name)
+#endif
+
 #define UTIL_DECL_IN_RANGE_FUNC(TYPE) \
     bool util_ ## TYPE ##_in_range( \
         const TYPE val, \
@@ -455,6 +482,75 @@ bool util_pio_sm_try_get(
     uint32_t* const word,
     const uint threshold);
 
+/**
+ * @brief Check whether a given state machine has stalled on
+ * a full RX FIFO since the last check, and clear the flag.
+ * 
+ * @param pio 
+ * @param sm 
+ * @return true if the RX FIFO was full when the state machine
+ * tried to push
+ * @return false 
+ */
+bool util_pio_sm_rx_stalled(
+    PIO const pio,
+    const uint sm);
+
+/**
+ * @brief Start the calling core's SysTick as a free-running
+ * processor cycle counter. If SysTick is already running, it
+ * is left as-is.
+ */
+void util_cycle_counter_init(void);
+
+/**
+ * @brief Get the current value of the calling core's SysTick
+ * counter.
+ * 
+ * @note SysTick counts down.
+ * @return uint32_t 
+ */
+uint32_t util_cycle_counter_get(void);
+
+/**
+ * @brief Number of processor cycles between two values
+ * obtained from util_cycle_counter_get, accounting for the
+ * counter wrapping once.
+ * 
+ * @param start 
+ * @param end 
+ * @return uint32_t 
+ */
+uint32_t util_cycle_counter_elapsed(
+    const uint32_t start,
+    const uint32_t end);
+
+/**
+ * @brief Insert val into the sorted (ascending) array arr
+ * which currently holds len values. arr must have room for
+ * len + 1 values.
+ * 
+ * @param arr 
+ * @param len 
+ * @param val 
+ */
+void util_sorted_insert_int32(
+    int32_t* const arr,
+    const size_t len,
+    const int32_t val);
+
+/**
+ * @brief Median of a sorted array of len values. For an even
+ * len this is the mean of the two middle values.
+ * 
+ * @param arr 
+ * @param len at least 1
+ * @return int32_t 
+ */
+int32_t util_sorted_median_int32(
+    const int32_t* const arr,
+    const size_t len);
+
 #undef UTIL_DECL_IN_RANGE_FUNC
 
 #ifdef __cplusplus
@@ -33,6 +33,7 @@
 const hx711_config_t HX711__DEFAULT_CONFIG = {
     .clock_pin = 0,
     .data_pin = 0,
+    .rate_pin = HX711_NO_RATE_PIN,
     .pio = pio0,
     .pio_init = hx711_reader_pio_init,
     .reader_prog = &hx711_reader_program,
@@ -43,6 +44,7 @@ const hx711_multi_config_t HX711__MULTI_DEFAULT_CONFIG = {
     .clock_pin = 0,
     .data_pin_base = 0,
     .chips_len = 0,
+    .rate_pin = HX711_NO_RATE_PIN,
     .pio_irq_index = HX711_MULTI_ASYNC_PIO_IRQ_IDX,
     .dma_irq_index = HX711_MULTI_ASYNC_DMA_IRQ_IDX,
     .pio = pio0,
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "hardware/gpio.h"
 #include "hardware/pio.h"
@@ -29,6 +30,7 @@
 #include "pico/mutex.h"
 #include "pico/time.h"
 #include "../include/hx711.h"
+#include "../include/hx711_trace.h"
 #include "../include/util.h"
 
 const unsigned short HX711_SETTLING_TIMES[] = {
@@ -66,6 +68,12 @@ void hx711_init(
         check_gpio_param(config->data_pin);
         assert(config->clock_pin != config->data_pin);
 
+        if(config->rate_pin != HX711_NO_RATE_PIN) {
+            check_gpio_param(config->rate_pin);
+            assert(config->rate_pin != config->clock_pin);
+            assert(config->rate_pin != config->data_pin);
+        }
+
 #ifndef HX711_NO_MUTEX
         mutex_init(&hx->_mut);
 #endif
@@ -76,9 +84,24 @@ void hx711_init(
             hx->_data_pin = config->data_pin;
             hx->_pio = config->pio;
             hx->_reader_prog = config->reader_prog;
+            hx->_rate_pin = config->rate_pin;
+            hx->_rate = hx711_rate_10;
+            hx->_auto_rate = hx711_rate_10;
+            hx->_stability = NULL;
+            hx->_glitch = NULL;
+            hx->_notch = NULL;
+
+#ifdef HX711_STATS
+            hx->_stats = (hx711_stats_t){ 0 };
+#endif
 
             util_gpio_set_output(hx->_clock_pin);
 
+            if(hx->_rate_pin != HX711_NO_RATE_PIN) {
+                util_gpio_set_output(hx->_rate_pin);
+                gpio_put(hx->_rate_pin, false);
+            }
+
             /**
              * There was originally a call here to gpio_put on the
              * clock pin to power up the HX711. I have decided to
@@ -174,6 +197,11 @@ void hx711_set_gain(hx711_t* const hx, const hx711_gain_t gain) {
             hx->_reader_sm,
             pioGain);
 
+        HX711_TRACE_WRITE(
+            HX711_TRACE_EVENT_SET_GAIN,
+            HX711_TRACE_INSTANCE(hx->_pio, hx->_reader_sm),
+            gain);
+
         /**
          * At this point the current value in the RX FIFO will
          * have been calculated based on whatever the previous
@@ -228,10 +256,20 @@ void hx711_set_gain(hx711_t* const hx, const hx711_gain_t gain) {
 
 }
 
-int32_t hx711_get_twos_comp(const uint32_t raw) {
-    return
-        (int32_t)(-(raw & +HX711_MIN_VALUE)) + 
-        (int32_t)(raw & HX711_MAX_VALUE);
+int32_t UTIL_HOT_FUNC(hx711_get_twos_comp)(const uint32_t raw) {
+    return HX711_SIGN_EXTEND(raw);
+}
+
+void UTIL_HOT_FUNC(hx711_get_twos_comp_batch)(
+    const uint32_t* const raw,
+    int32_t* const out,
+    const size_t n) {
+
+        assert(raw != NULL);
+        assert(out != NULL);
+
+        hx711_decode_twos_comp_batch(raw, out, n);
+
 }
 
 bool hx711_is_min_saturated(const int32_t val) {
@@ -266,7 +304,7 @@ int32_t hx711_get_value(hx711_t* const hx) {
 
     assert(hx711__is_state_machine_enabled(hx));
 
-    uint32_t rawVal;
+    int32_t val;
 
     HX711_MUTEX_BLOCK(hx->_mut, 
 
@@ -279,13 +317,16 @@ int32_t hx711_get_value(hx711_t* const hx) {
          * assured we'll be getting a new value each time,
          * even if the RX FIFO is currently empty.
          */
-        rawVal = pio_sm_get_blocking(
+        val = hx711_get_twos_comp(pio_sm_get_blocking(
             hx->_pio,
-            hx->_reader_sm);
+            hx->_reader_sm));
+
+        hx711__process_value(hx, &val);
+        hx711__apply_auto_rate(hx);
 
     );
 
-    return hx711_get_twos_comp(rawVal);
+    return val;
 
 }
 
@@ -309,11 +350,19 @@ bool hx711_get_value_timeout(
                     break;
                 }
             }
-        );
 
-        if(success) {
-            *val = hx711_get_twos_comp(tempVal);
-        }
+            if(success) {
+                *val = hx711_get_twos_comp(tempVal);
+                hx711__process_value(hx, val);
+            }
+            else {
+                HX711_STATS_INC(hx->_stats, timeouts);
+                HX711_TRACE_WRITE(
+                    HX711_TRACE_EVENT_TIMEOUT,
+                    HX711_TRACE_INSTANCE(hx->_pio, hx->_reader_sm),
+                    MIN(timeout / 1000, UINT16_MAX));
+            }
+        );
 
         return success;
 
@@ -334,16 +383,212 @@ bool hx711_get_value_noblock(
                 hx->_pio,
                 hx->_reader_sm,
                 &tempVal);
+
+            if(success) {
+                *val = hx711_get_twos_comp(tempVal);
+                hx711__process_value(hx, val);
+            }
+        );
+
+        return success;
+
+}
+
+void hx711_set_rate(
+    hx711_t* const hx,
+    const hx711_rate_t rate) {
+
+        assert(hx711__is_state_machine_enabled(hx));
+        assert(hx->_rate_pin != HX711_NO_RATE_PIN);
+        assert(hx711_is_rate_valid(rate));
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            hx711__set_rate(hx, rate);
+        );
+
+}
+
+hx711_rate_t hx711_get_rate(hx711_t* const hx) {
+    assert(hx711__is_initd(hx));
+    return hx->_rate;
+}
+
+void hx711_set_auto_rate(
+    hx711_t* const hx,
+    hx711_stability_t* const s) {
+
+        assert(hx711__is_initd(hx));
+        assert(s == NULL || hx->_rate_pin != HX711_NO_RATE_PIN);
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            hx->_stability = s;
+            hx->_auto_rate = hx->_rate;
+            if(s != NULL) {
+                hx711_stability_seed(s, hx->_rate == hx711_rate_10);
+            }
+        );
+
+}
+
+bool hx711_apply_auto_rate(hx711_t* const hx) {
+
+    assert(hx711__is_state_machine_enabled(hx));
+
+    bool changed;
+
+    HX711_MUTEX_BLOCK(hx->_mut, 
+        changed = hx711__apply_auto_rate(hx);
+    );
+
+    return changed;
+
+}
+
+void hx711_set_glitch_filter(
+    hx711_t* const hx,
+    hx711_glitch_t* const g) {
+
+        assert(hx711__is_initd(hx));
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            hx->_glitch = g;
+        );
+
+}
+
+void hx711_set_notch_filter(
+    hx711_t* const hx,
+    hx711_notch_t* const n) {
+
+        assert(hx711__is_initd(hx));
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            hx->_notch = n;
+        );
+
+}
+
+int32_t hx711_get_value_avg(
+    hx711_t* const hx,
+    const uint n) {
+
+        assert(hx711__is_state_machine_enabled(hx));
+        assert(n > 0);
+
+        int64_t sum = 0;
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            for(uint i = 0; i < n; ++i) {
+
+                int32_t val = hx711_get_twos_comp(
+                    pio_sm_get_blocking(hx->_pio, hx->_reader_sm));
+
+                hx711__process_value(hx, &val);
+
+                sum += val;
+
+            }
+
+            //every value is taken at the same rate
+            hx711__apply_auto_rate(hx);
+        );
+
+        return (int32_t)(sum / (int64_t)n);
+
+}
+
+int32_t hx711_get_value_median(
+    hx711_t* const hx,
+    const uint n) {
+
+        assert(hx711__is_state_machine_enabled(hx));
+        assert(n > 0);
+        assert(n <= HX711_MEDIAN_MAX_SAMPLES);
+
+        uint32_t raw[HX711_MEDIAN_MAX_SAMPLES];
+        int32_t* const vals = (int32_t*)raw;
+        int32_t sorted[HX711_MEDIAN_MAX_SAMPLES];
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            for(uint i = 0; i < n; ++i) {
+                raw[i] = pio_sm_get_blocking(hx->_pio, hx->_reader_sm);
+            }
+
+            hx711_get_twos_comp_batch(raw, vals, n);
+
+            for(uint i = 0; i < n; ++i) {
+                hx711__process_value(hx, &vals[i]);
+                util_sorted_insert_int32(sorted, i, vals[i]);
+            }
+
+            hx711__apply_auto_rate(hx);
         );
 
-        if(success) {
-            *val = hx711_get_twos_comp(tempVal);
+        return util_sorted_median_int32(sorted, n);
+
+}
+
+void hx711_tare(
+    hx711_t* const hx,
+    const uint samples,
+    hx711_calib_t* const calib) {
+
+        assert(hx711__is_state_machine_enabled(hx));
+        assert(samples > 0);
+        assert(calib != NULL);
+
+        calib->offset = hx711_get_value_avg(hx, samples);
+
+}
+
+bool hx711_calibrate(
+    hx711_t* const hx,
+    const uint samples,
+    const float known_mass,
+    hx711_calib_t* const calib) {
+
+        assert(hx711__is_state_machine_enabled(hx));
+        assert(samples > 0);
+        assert(known_mass > 0.0f);
+        assert(calib != NULL);
+
+        const int32_t diff = hx711_get_value_avg(hx, samples) - calib->offset;
+
+        if(diff == 0) {
+            return false;
         }
 
-        return success;
+        calib->scale = (float)diff / known_mass;
+
+        return true;
 
 }
 
+#ifdef HX711_STATS
+void hx711_get_stats(
+    hx711_t* const hx,
+    hx711_stats_t* const stats) {
+
+        assert(hx711__is_initd(hx));
+        assert(stats != NULL);
+
+        HX711_MUTEX_BLOCK(hx->_mut, 
+            *stats = hx->_stats;
+        );
+
+}
+
+void hx711_reset_stats(hx711_t* const hx) {
+
+    assert(hx711__is_initd(hx));
+
+    HX711_MUTEX_BLOCK(hx->_mut, 
+        hx->_stats = (hx711_stats_t){ 0 };
+    );
+
+}
+#endif
+
 bool hx711__is_initd(hx711_t* const hx) {
     return hx != NULL &&
         hx->_pio != NULL &&
@@ -418,9 +663,11 @@ void hx711_power_up(
              * going low. Which, in turn, is handled by the state
              * machine in waiting for the low signal.
              */
-            gpio_put(
-                hx->_clock_pin,
-                false);
+            pio_sm_set_pins_with_mask(
+                hx->_pio,
+                hx->_reader_sm,
+                0,
+                1u << hx->_clock_pin);
 
             //2. reset the state machine using the default config
             //obtained when init'ing.
@@ -448,6 +695,11 @@ void hx711_power_up(
                 hx->_reader_sm,
                 true);
 
+            HX711_TRACE_WRITE(
+                HX711_TRACE_EVENT_POWER_UP,
+                HX711_TRACE_INSTANCE(hx->_pio, hx->_reader_sm),
+                gain);
+
         );
 
 }
@@ -475,10 +727,21 @@ void hx711_power_down(hx711_t* const hx) {
          * 
          * hx711_power_down(&hx);
          * hx711_wait_power_down();
+         *
+         * The clock pin is muxed to the PIO, so gpio_put has
+         * no effect on it. Have the (stopped) state machine
+         * drive it instead.
          */
-        gpio_put(
-            hx->_clock_pin,
-            true);
+        pio_sm_set_pins_with_mask(
+            hx->_pio,
+            hx->_reader_sm,
+            1u << hx->_clock_pin,
+            1u << hx->_clock_pin);
+
+        HX711_TRACE_WRITE(
+            HX711_TRACE_EVENT_POWER_DOWN,
+            HX711_TRACE_INSTANCE(hx->_pio, hx->_reader_sm),
+            0);
 
     );
 
@@ -489,7 +752,9 @@ void hx711_wait_settle(const hx711_rate_t rate) {
 }
 
 void hx711_wait_power_down() {
-    sleep_us(HX711_POWER_DOWN_TIMEOUT);
+    //the clock pin must be held high for *more* than
+    //HX711_POWER_DOWN_TIMEOUT us
+    sleep_us(HX711_POWER_DOWN_TIMEOUT + 1);
 }
 
 uint32_t hx711_gain_to_pio_gain(const hx711_gain_t gain) {
@@ -523,12 +788,108 @@ bool hx711__try_get_value(
         assert(util_pio_sm_is_enabled(pio, sm));
         assert(val != NULL);
 
-        static const uint byteThreshold = HX711_READ_BITS / 8;
+        //each conversion is pushed as a single word, so one
+        //word in the RX FIFO is a complete value
+        static const uint wordThreshold = 1;
 
         return util_pio_sm_try_get(
             pio,
             sm,
             val,
-            byteThreshold);
+            wordThreshold);
+
+}
+
+void hx711__set_rate(
+    hx711_t* const hx,
+    const hx711_rate_t rate) {
+
+        gpio_put(hx->_rate_pin, rate == hx711_rate_80);
+        hx->_rate = rate;
+        hx->_auto_rate = rate;
+
+        HX711_TRACE_WRITE(
+            HX711_TRACE_EVENT_SET_RATE,
+            HX711_TRACE_INSTANCE(hx->_pio, hx->_reader_sm),
+            rate);
+
+        //the notch filter was tuned for the old rate, and both
+        //filters' history is from before the settling gap
+        if(hx->_notch != NULL) {
+            hx711_notch_init(
+                hx->_notch,
+                hx711_get_rate_sps(rate),
+                hx711_notch_get_mains(hx->_notch));
+        }
+
+        if(hx->_glitch != NULL) {
+            hx711_glitch_reset(hx->_glitch);
+        }
+
+        hx711_wait_settle(rate);
+
+        /**
+         * Values converted while settling are not usable. The
+         * reader may also be stalled on autopush with an old
+         * value in its ISR, which is pushed as soon as the FIFO
+         * is cleared, so discard one more value after that.
+         */
+        util_pio_sm_clear_rx_fifo(hx->_pio, hx->_reader_sm);
+        pio_sm_get_blocking(hx->_pio, hx->_reader_sm);
+
+}
+
+void hx711__process_value(
+    hx711_t* const hx,
+    int32_t* const val) {
+
+#ifdef HX711_STATS
+        hx711__stats_record(hx, *val);
+#endif
+
+        if(hx->_glitch != NULL) {
+            hx711_glitch_filter(hx->_glitch, val);
+        }
+
+        if(hx->_notch != NULL) {
+            *val = hx711_notch_filter(hx->_notch, *val);
+        }
+
+        if(hx->_stability != NULL) {
+            hx->_auto_rate = hx711_stability_update(hx->_stability, *val)
+                ? hx711_rate_10
+                : hx711_rate_80;
+        }
 
 }
+
+bool hx711__apply_auto_rate(hx711_t* const hx) {
+
+    if(hx->_stability == NULL || hx->_auto_rate == hx->_rate) {
+        return false;
+    }
+
+    hx711__set_rate(hx, hx->_auto_rate);
+
+    return true;
+
+}
+
+#ifdef HX711_STATS
+void hx711__stats_record(
+    hx711_t* const hx,
+    const int32_t val) {
+
+        /**
+         * The reader program autopushes, so a full RX FIFO
+         * stalls the State Machine and conversions are missed
+         * until the FIFO is read again.
+         */
+        if(util_pio_sm_rx_stalled(hx->_pio, hx->_reader_sm)) {
+            HX711_STATS_INC(hx->_stats, overruns);
+        }
+
+        HX711_STATS_RECORD_VALUE(hx->_stats, val);
+
+}
+#endif
@@ -0,0 +1,150 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/gpio.h"
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "../include/hx711_alarm.h"
+#include "../include/util.h"
+
+void hx711_alarm_get_default_config(hx711_alarm_config_t* const config) {
+    assert(config != NULL);
+    config->high = INT32_MAX;
+    config->low = INT32_MIN;
+    config->hysteresis = 1000;
+    config->pin = HX711_ALARM_NO_PIN;
+    config->active_high = true;
+}
+
+void hx711_alarm_init(
+    hx711_alarm_t* const a,
+    const hx711_alarm_config_t* const config) {
+
+        assert(a != NULL);
+        assert(config != NULL);
+        assert(config->hysteresis >= 0);
+        assert(config->low < config->high);
+
+        a->_high = config->high;
+        a->_low = config->low;
+        a->_hysteresis = config->hysteresis;
+        a->_pin = config->pin;
+        a->_active_high = config->active_high;
+
+        if(a->_pin != HX711_ALARM_NO_PIN) {
+            gpio_init(a->_pin);
+            gpio_set_dir(a->_pin, true);
+        }
+
+        hx711_alarm_reset(a);
+
+}
+
+void hx711_alarm_reset(hx711_alarm_t* const a) {
+    assert(a != NULL);
+    a->_state = HX711_ALARM_STATE_NONE;
+    a->_trips = 0;
+    hx711_alarm__drive(a);
+}
+
+uint8_t UTIL_HOT_FUNC(hx711_alarm_update)(
+    hx711_alarm_t* const a,
+    const int32_t val) {
+
+        assert(a != NULL);
+
+        const uint8_t prev = a->_state;
+        uint8_t state = prev;
+
+        //widen to avoid overflow when a threshold is near the
+        //limits of int32_t
+        if(prev == HX711_ALARM_STATE_HIGH) {
+            if((int64_t)val < (int64_t)a->_high - a->_hysteresis) {
+                state = HX711_ALARM_STATE_NONE;
+            }
+        }
+        else if(prev == HX711_ALARM_STATE_LOW) {
+            if((int64_t)val > (int64_t)a->_low + a->_hysteresis) {
+                state = HX711_ALARM_STATE_NONE;
+            }
+        }
+
+        if(state == HX711_ALARM_STATE_NONE) {
+            if(val >= a->_high) {
+                state = HX711_ALARM_STATE_HIGH;
+            }
+            else if(val <= a->_low) {
+                state = HX711_ALARM_STATE_LOW;
+            }
+        }
+
+        if(state != prev) {
+            a->_state = state;
+            if(state != HX711_ALARM_STATE_NONE) {
+                ++a->_trips;
+            }
+            hx711_alarm__drive(a);
+        }
+
+        return state;
+
+}
+
+bool UTIL_HOT_FUNC(hx711_alarm_update_multi)(
+    hx711_alarm_t* const as,
+    const int32_t* const values,
+    const size_t len) {
+
+        assert(as != NULL);
+        assert(values != NULL);
+
+        bool tripped = false;
+
+        for(size_t i = 0; i < len; ++i) {
+            tripped |= hx711_alarm_update(&as[i], values[i]) !=
+                HX711_ALARM_STATE_NONE;
+        }
+
+        return tripped;
+
+}
+
+uint8_t hx711_alarm_get_state(const hx711_alarm_t* const a) {
+    assert(a != NULL);
+    return a->_state;
+}
+
+uint32_t hx711_alarm_get_trips(const hx711_alarm_t* const a) {
+    assert(a != NULL);
+    return a->_trips;
+}
+
+void UTIL_HOT_FUNC(hx711_alarm__drive)(const hx711_alarm_t* const a) {
+    if(a->_pin != HX711_ALARM_NO_PIN) {
+        const bool active = a->_state != HX711_ALARM_STATE_NONE;
+        gpio_put(a->_pin, active == a->_active_high);
+    }
+}
@@ -0,0 +1,331 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/hx711_calib.h"
+#include "../include/hx711_crc.h"
+#include "../include/hx711_flash.h"
+
+static_assert(sizeof(hx711_calib_record_t) == 32,
+    "hx711_calib_record_t is stored in flash and must not change size");
+
+float hx711_calib_apply(
+    const hx711_calib_t* const calib,
+    const int32_t raw) {
+
+        assert(calib != NULL);
+        assert(isnormal(calib->scale));
+
+        return (float)(raw - calib->offset) / calib->scale;
+
+}
+
+void hx711_calib_apply_multi(
+    const hx711_calib_t* const calibs,
+    const int32_t* const raw,
+    float* const out,
+    const size_t len) {
+
+        assert(calibs != NULL);
+        assert(raw != NULL);
+        assert(out != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            out[i] = hx711_calib_apply(&calibs[i], raw[i]);
+        }
+
+}
+
+bool hx711_calib_store_init(
+    hx711_calib_store_t* const store,
+    hx711_flash_t* const flash,
+    const size_t offset) {
+
+        assert(store != NULL);
+        assert(flash != NULL);
+        assert(flash->read != NULL);
+        assert(flash->erase != NULL);
+        assert(flash->program != NULL);
+        assert(flash->sector_size % sizeof(hx711_calib_record_t) == 0);
+        assert(flash->sector_size / sizeof(hx711_calib_record_t) >
+            HX711_CALIB_MAX_CHIPS);
+        assert(offset % flash->sector_size == 0);
+
+        const size_t slots = flash->sector_size / sizeof(hx711_calib_record_t);
+        hx711_calib_record_t rec;
+        bool found = false;
+
+        store->_flash = flash;
+        store->_offset = offset;
+        store->_seq = 0;
+        store->_active = 0;
+        store->_next = 0;
+
+        //the active sector is the one holding the highest
+        //sequence number
+        for(uint8_t sector = 0; sector < 2; ++sector) {
+            for(size_t slot = 0; slot < slots; ++slot) {
+
+                if(!flash->read(
+                    flash->ctx,
+                    hx711_calib__slot_offset(store, sector, slot),
+                    &rec,
+                    sizeof(rec))) {
+                        return false;
+                }
+
+                if(rec.magic != HX711_CALIB_MAGIC ||
+                    rec.crc != hx711_crc32(&rec, offsetof(hx711_calib_record_t, crc))) {
+                        continue;
+                }
+
+                if(!found || rec.seq > store->_seq) {
+                    found = true;
+                    store->_seq = rec.seq;
+                    store->_active = sector;
+                }
+
+            }
+        }
+
+        //continue after the last programmed slot; a torn write
+        //leaves a slot which is neither valid nor blank, and it
+        //is skipped rather than written over
+        for(size_t slot = 0; slot < slots; ++slot) {
+
+            if(!flash->read(
+                flash->ctx,
+                hx711_calib__slot_offset(store, store->_active, slot),
+                &rec,
+                sizeof(rec))) {
+                    return false;
+            }
+
+            if(!hx711_calib__is_blank(&rec)) {
+                store->_next = slot + 1;
+            }
+
+        }
+
+        return true;
+
+}
+
+bool hx711_calib_store_load(
+    hx711_calib_store_t* const store,
+    const uint8_t chip,
+    hx711_calib_t* const calib) {
+
+        assert(store != NULL);
+        assert(store->_flash != NULL);
+        assert(chip < HX711_CALIB_MAX_CHIPS);
+        assert(calib != NULL);
+
+        const size_t slots = store->_flash->sector_size /
+            sizeof(hx711_calib_record_t);
+        hx711_calib_record_t rec;
+        uint32_t seq = 0;
+        bool found = false;
+
+        for(uint8_t sector = 0; sector < 2; ++sector) {
+            for(size_t slot = 0; slot < slots; ++slot) {
+
+                if(!hx711_calib__read_slot(store, sector, slot, &rec) ||
+                    rec.chip != chip) {
+                        continue;
+                }
+
+                if(!found || rec.seq > seq) {
+                    found = true;
+                    seq = rec.seq;
+                    calib->offset = rec.offset;
+                    calib->scale = rec.scale;
+                    calib->timestamp = rec.timestamp;
+                }
+
+            }
+        }
+
+        return found;
+
+}
+
+bool hx711_calib_store_save(
+    hx711_calib_store_t* const store,
+    const uint8_t chip,
+    const hx711_calib_t* const calib) {
+
+        assert(store != NULL);
+        assert(store->_flash != NULL);
+        assert(chip < HX711_CALIB_MAX_CHIPS);
+        assert(calib != NULL);
+
+        const size_t slots = store->_flash->sector_size /
+            sizeof(hx711_calib_record_t);
+
+        if(store->_next >= slots && !hx711_calib__compact(store)) {
+            return false;
+        }
+
+        return hx711_calib__append(store, chip, calib);
+
+}
+
+size_t hx711_calib__slot_offset(
+    const hx711_calib_store_t* const store,
+    const uint8_t sector,
+    const size_t slot) {
+        return store->_offset +
+            (sector * store->_flash->sector_size) +
+            (slot * sizeof(hx711_calib_record_t));
+}
+
+bool hx711_calib__is_blank(const hx711_calib_record_t* const rec) {
+
+    const uint8_t* const p = (const uint8_t*)rec;
+
+    for(size_t i = 0; i < sizeof(*rec); ++i) {
+        if(p[i] != HX711_FLASH_ERASED_BYTE) {
+            return false;
+        }
+    }
+
+    return true;
+
+}
+
+bool hx711_calib__read_slot(
+    const hx711_calib_store_t* const store,
+    const uint8_t sector,
+    const size_t slot,
+    hx711_calib_record_t* const rec) {
+
+        if(!store->_flash->read(
+            store->_flash->ctx,
+            hx711_calib__slot_offset(store, sector, slot),
+            rec,
+            sizeof(*rec))) {
+                return false;
+        }
+
+        return rec->magic == HX711_CALIB_MAGIC &&
+            rec->chip < HX711_CALIB_MAX_CHIPS &&
+            rec->crc == hx711_crc32(rec, offsetof(hx711_calib_record_t, crc));
+
+}
+
+bool hx711_calib__compact(hx711_calib_store_t* const store) {
+
+    const size_t slots = store->_flash->sector_size /
+        sizeof(hx711_calib_record_t);
+    const uint8_t dest = store->_active ^ 1;
+
+    hx711_calib_t latest[HX711_CALIB_MAX_CHIPS];
+    uint32_t seqs[HX711_CALIB_MAX_CHIPS];
+    uint32_t have = 0;
+    hx711_calib_record_t rec;
+
+    //gather from both sectors in case a previous copy was
+    //interrupted and the destination holds the only copy
+    //of a record
+    for(uint8_t sector = 0; sector < 2; ++sector) {
+        for(size_t slot = 0; slot < slots; ++slot) {
+
+            if(!hx711_calib__read_slot(store, sector, slot, &rec)) {
+                continue;
+            }
+
+            const uint32_t bit = UINT32_C(1) << rec.chip;
+
+            if(!(have & bit) || rec.seq > seqs[rec.chip]) {
+                have |= bit;
+                seqs[rec.chip] = rec.seq;
+                latest[rec.chip].offset = rec.offset;
+                latest[rec.chip].scale = rec.scale;
+                latest[rec.chip].timestamp = rec.timestamp;
+            }
+
+        }
+    }
+
+    if(!store->_flash->erase(
+        store->_flash->ctx,
+        hx711_calib__slot_offset(store, dest, 0))) {
+            return false;
+    }
+
+    store->_active = dest;
+    store->_next = 0;
+
+    for(uint8_t chip = 0; chip < HX711_CALIB_MAX_CHIPS; ++chip) {
+        if((have & (UINT32_C(1) << chip)) &&
+            !hx711_calib__append(store, chip, &latest[chip])) {
+                return false;
+        }
+    }
+
+    return true;
+
+}
+
+bool hx711_calib__append(
+    hx711_calib_store_t* const store,
+    const uint8_t chip,
+    const hx711_calib_t* const calib) {
+
+        hx711_calib_record_t rec;
+        hx711_calib_record_t check;
+
+        memset(&rec, 0, sizeof(rec));
+        rec.magic = HX711_CALIB_MAGIC;
+        rec.seq = store->_seq + 1;
+        rec.chip = chip;
+        rec.offset = calib->offset;
+        rec.scale = calib->scale;
+        rec.timestamp = calib->timestamp;
+        rec.crc = hx711_crc32(&rec, offsetof(hx711_calib_record_t, crc));
+
+        const size_t slot = store->_next;
+
+        //the slot is used up even if programming fails so a
+        //bad slot is never retried
+        ++store->_next;
+
+        if(!store->_flash->program(
+            store->_flash->ctx,
+            hx711_calib__slot_offset(store, store->_active, slot),
+            &rec,
+            sizeof(rec))) {
+                return false;
+        }
+
+        store->_seq = rec.seq;
+
+        return hx711_calib__read_slot(store, store->_active, slot, &check) &&
+            memcmp(&rec, &check, sizeof(rec)) == 0;
+
+}
@@ -0,0 +1,235 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "../include/hx711_capture.h"
+#include "../include/hx711_multi.h"
+#include "../include/util.h"
+
+void hx711_capture_get_default_config(hx711_capture_config_t* const config) {
+
+    assert(config != NULL);
+
+    config->trigger = hx711_capture_trigger_level;
+    config->edge = hx711_capture_edge_rising;
+    config->source = hx711_capture_source_any;
+    config->chip = 0;
+    config->level = 0;
+    config->pre_frames = 16;
+    config->post_frames = 16;
+
+}
+
+void hx711_capture_init(
+    hx711_capture_t* const cap,
+    hx711_multi_t* const hxm,
+    const hx711_capture_config_t* const config,
+    int32_t* const buffer,
+    const size_t len) {
+
+        assert(cap != NULL);
+        assert(hxm != NULL);
+        assert(config != NULL);
+        assert(buffer != NULL);
+        assert(config->post_frames > 0);
+        assert(config->source != hx711_capture_source_chip ||
+            config->chip < hxm->_chips_len);
+        assert(config->trigger != hx711_capture_trigger_slope ||
+            config->level > 0);
+
+        const size_t frames_len = config->pre_frames + config->post_frames;
+
+        assert(len >= frames_len * hxm->_chips_len);
+        (void)len;
+
+        cap->_hxm = hxm;
+        cap->_config = *config;
+        cap->_buffer = buffer;
+        cap->_frames_len = frames_len;
+        cap->_head = 0;
+        cap->_seen = 0;
+        cap->_post = 0;
+        cap->_pre_count = 0;
+        cap->_state = HX711_CAPTURE_STATE_IDLE;
+
+}
+
+void hx711_capture_start(hx711_capture_t* const cap) {
+
+    assert(cap != NULL);
+    assert(cap->_state != HX711_CAPTURE_STATE_ARMED);
+    assert(cap->_state != HX711_CAPTURE_STATE_TRIGGERED);
+
+    cap->_head = 0;
+    cap->_seen = 0;
+    cap->_post = 0;
+    cap->_pre_count = 0;
+    cap->_state = HX711_CAPTURE_STATE_ARMED;
+
+    hx711_multi_async_start_continuous(
+        cap->_hxm,
+        hx711_capture__on_frame,
+        cap);
+
+}
+
+void hx711_capture_stop(hx711_capture_t* const cap) {
+
+    assert(cap != NULL);
+
+    hx711_multi_async_stop(cap->_hxm);
+
+    if(cap->_state != HX711_CAPTURE_STATE_DONE) {
+        cap->_state = HX711_CAPTURE_STATE_IDLE;
+    }
+
+}
+
+hx711_capture_state_t hx711_capture_get_state(const hx711_capture_t* const cap) {
+    assert(cap != NULL);
+    return cap->_state;
+}
+
+size_t hx711_capture_get_frames_len(const hx711_capture_t* const cap) {
+    assert(cap != NULL);
+    assert(cap->_state == HX711_CAPTURE_STATE_DONE);
+    return cap->_pre_count + cap->_config.post_frames;
+}
+
+size_t hx711_capture_get_trigger_index(const hx711_capture_t* const cap) {
+    assert(cap != NULL);
+    assert(cap->_state == HX711_CAPTURE_STATE_DONE);
+    return cap->_pre_count;
+}
+
+const int32_t* hx711_capture_get_frame(
+    const hx711_capture_t* const cap,
+    const size_t n) {
+
+        assert(cap != NULL);
+        assert(cap->_state == HX711_CAPTURE_STATE_DONE);
+        assert(n < hx711_capture_get_frames_len(cap));
+
+        //_head is where the next frame would have gone, which is
+        //one past the newest; count back from there
+        const size_t len = hx711_capture_get_frames_len(cap);
+        const size_t idx = (cap->_head + cap->_frames_len - len + n) %
+            cap->_frames_len;
+
+        return &cap->_buffer[idx * cap->_hxm->_chips_len];
+
+}
+
+bool UTIL_HOT_FUNC(hx711_capture__on_frame)(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx) {
+
+        (void)frame;
+
+        hx711_capture_t* const cap = (hx711_capture_t*)ctx;
+        const size_t chips = hxm->_chips_len;
+        int32_t* const cur = &cap->_buffer[cap->_head * chips];
+
+        memcpy(cur, values, chips * sizeof(int32_t));
+
+        if(cap->_state == HX711_CAPTURE_STATE_ARMED && cap->_seen > 0) {
+
+            const size_t prev_idx = (cap->_head + cap->_frames_len - 1) %
+                cap->_frames_len;
+
+            if(hx711_capture__is_triggered(cap, &cap->_buffer[prev_idx * chips], cur)) {
+                cap->_pre_count = MIN(cap->_seen, cap->_config.pre_frames);
+                cap->_state = HX711_CAPTURE_STATE_TRIGGERED;
+            }
+
+        }
+
+        cap->_head = (cap->_head + 1) % cap->_frames_len;
+        ++cap->_seen;
+
+        if(cap->_state == HX711_CAPTURE_STATE_TRIGGERED &&
+            ++cap->_post == cap->_config.post_frames) {
+                cap->_state = HX711_CAPTURE_STATE_DONE;
+                return false;
+        }
+
+        return true;
+
+}
+
+bool UTIL_HOT_FUNC(hx711_capture__is_triggered)(
+    const hx711_capture_t* const cap,
+    const int32_t* const prev,
+    const int32_t* const cur) {
+
+        const hx711_capture_config_t* const cfg = &cap->_config;
+        const bool rising = cfg->edge == hx711_capture_edge_rising;
+        size_t first = 0;
+        size_t last = cap->_hxm->_chips_len;
+        int32_t p = 0;
+        int32_t c = 0;
+
+        if(cfg->source == hx711_capture_source_chip) {
+            first = cfg->chip;
+            last = cfg->chip + 1;
+        }
+
+        if(cfg->source == hx711_capture_source_sum) {
+            //at most 32 24-bit values, so no overflow
+            for(size_t i = first; i < last; ++i) {
+                p += prev[i];
+                c += cur[i];
+            }
+            first = 0;
+            last = 1;
+        }
+
+        for(size_t i = first; i < last; ++i) {
+
+            if(cfg->source != hx711_capture_source_sum) {
+                p = prev[i];
+                c = cur[i];
+            }
+
+            if(cfg->trigger == hx711_capture_trigger_level) {
+                if(rising ? (p < cfg->level && c >= cfg->level)
+                          : (p > cfg->level && c <= cfg->level)) {
+                    return true;
+                }
+            }
+            else if(rising ? (c - p >= cfg->level) : (p - c >= cfg->level)) {
+                return true;
+            }
+
+        }
+
+        return false;
+
+}
@@ -0,0 +1,63 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_crc.h"
+
+/**
+ * Nibble-wise table; 64 bytes of flash instead of the 1kB a
+ * byte-wise table needs. Records and packets are short, so
+ * the extra iteration per byte doesn't matter.
+ */
+static const uint32_t hx711__crc32_table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+    0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+uint32_t hx711_crc32_update(
+    uint32_t crc,
+    const void* const data,
+    const size_t len) {
+
+        assert(data != NULL || len == 0);
+
+        const uint8_t* p = (const uint8_t*)data;
+
+        for(size_t i = 0; i < len; ++i) {
+            crc ^= p[i];
+            crc = (crc >> 4) ^ hx711__crc32_table[crc & 0xf];
+            crc = (crc >> 4) ^ hx711__crc32_table[crc & 0xf];
+        }
+
+        return crc;
+
+}
+
+uint32_t hx711_crc32(
+    const void* const data,
+    const size_t len) {
+        return ~hx711_crc32_update(HX711_CRC32_INIT, data, len);
+}
@@ -0,0 +1,188 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_delta.h"
+
+void hx711_delta_enc_init(
+    hx711_delta_enc_t* const enc,
+    const size_t len,
+    const uint32_t resync_interval) {
+
+        assert(enc != NULL);
+        assert(len > 0);
+        assert(len <= HX711_DELTA_MAX_CHIPS);
+        assert(resync_interval > 0);
+
+        enc->_len = len;
+        enc->_resync_interval = resync_interval;
+        enc->_seq = 0;
+
+        hx711_delta_enc_reset(enc);
+
+}
+
+void hx711_delta_enc_reset(hx711_delta_enc_t* const enc) {
+    assert(enc != NULL);
+    enc->_count = 0;
+}
+
+size_t hx711_delta_encode(
+    hx711_delta_enc_t* const enc,
+    const int32_t* const values,
+    uint8_t* const out) {
+
+        assert(enc != NULL);
+        assert(values != NULL);
+        assert(out != NULL);
+
+        const bool key = enc->_count == 0;
+        size_t n = 0;
+
+        out[n++] = key ? HX711_DELTA_FRAME_KEY : HX711_DELTA_FRAME_DIFF;
+        out[n++] = enc->_seq++;
+
+        for(size_t i = 0; i < enc->_len; ++i) {
+
+            //wrapping arithmetic, undone by the decoder, so any
+            //int32_t survives the round trip
+            uint32_t u = hx711_delta_zigzag(key
+                ? values[i]
+                : (int32_t)((uint32_t)values[i] - (uint32_t)enc->_prev[i]));
+
+            while(u >= 0x80) {
+                out[n++] = (uint8_t)(u | 0x80);
+                u >>= 7;
+            }
+
+            out[n++] = (uint8_t)u;
+
+            enc->_prev[i] = values[i];
+
+        }
+
+        if(++enc->_count == enc->_resync_interval) {
+            enc->_count = 0;
+        }
+
+        return n;
+
+}
+
+void hx711_delta_dec_init(
+    hx711_delta_dec_t* const dec,
+    const size_t len) {
+
+        assert(dec != NULL);
+        assert(len > 0);
+        assert(len <= HX711_DELTA_MAX_CHIPS);
+
+        dec->_len = len;
+        dec->_synced = false;
+        dec->_seq = 0;
+        dec->_gaps = 0;
+
+}
+
+bool hx711_delta_decode(
+    hx711_delta_dec_t* const dec,
+    const uint8_t* const in,
+    const size_t in_len,
+    int32_t* const values,
+    size_t* const used) {
+
+        assert(dec != NULL);
+        assert(in != NULL);
+        assert(values != NULL);
+        assert(used != NULL);
+
+        if(in_len < 2) {
+            return false;
+        }
+
+        const uint8_t type = in[0];
+
+        if(type != HX711_DELTA_FRAME_KEY && type != HX711_DELTA_FRAME_DIFF) {
+            dec->_synced = false;
+            return false;
+        }
+
+        const bool key = type == HX711_DELTA_FRAME_KEY;
+        const uint8_t seq = in[1];
+        int32_t decoded[HX711_DELTA_MAX_CHIPS];
+        size_t n = 2;
+
+        for(size_t i = 0; i < dec->_len; ++i) {
+
+            uint32_t u = 0;
+            unsigned shift = 0;
+            uint8_t b;
+
+            do {
+                //a 32 bit value needs at most 5 bytes
+                if(n == in_len || shift > 28) {
+                    dec->_synced = false;
+                    return false;
+                }
+                b = in[n++];
+                u |= (uint32_t)(b & 0x7f) << shift;
+                shift += 7;
+            } while(b & 0x80);
+
+            decoded[i] = hx711_delta_unzigzag(u);
+
+        }
+
+        *used = n;
+
+        //a difference frame after a gap would be added to the
+        //wrong base, so wait for the next key frame
+        if(!key && dec->_synced && seq != (uint8_t)(dec->_seq + 1)) {
+            dec->_synced = false;
+            ++dec->_gaps;
+        }
+
+        if(!key && !dec->_synced) {
+            return false;
+        }
+
+        for(size_t i = 0; i < dec->_len; ++i) {
+            dec->_prev[i] = key
+                ? decoded[i]
+                : (int32_t)((uint32_t)dec->_prev[i] + (uint32_t)decoded[i]);
+            values[i] = dec->_prev[i];
+        }
+
+        dec->_synced = true;
+        dec->_seq = seq;
+
+        return true;
+
+}
+
+uint32_t hx711_delta_dec_get_gaps(const hx711_delta_dec_t* const dec) {
+    assert(dec != NULL);
+    return dec->_gaps;
+}
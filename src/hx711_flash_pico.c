@@ -0,0 +1,148 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "hardware/flash.h"
+#include "hardware/regs/addressmap.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "../include/hx711_flash.h"
+
+static bool hx711_flash__pico_read(
+    void* ctx,
+    size_t offset,
+    void* buf,
+    size_t len) {
+
+        (void)ctx;
+        assert(offset + len <= PICO_FLASH_SIZE_BYTES);
+
+        memcpy(buf, (const void*)(XIP_BASE + offset), len);
+        return true;
+
+}
+
+/**
+ * @brief Stop the other core, if it has called
+ * multicore_lockout_victim_init, and disable interrupts on this
+ * one so nothing executes from flash while it is written.
+ * 
+ * @param lockout set to whether the other core was locked out
+ * @return uint32_t interrupt status for hx711_flash__pico_exit
+ */
+static uint32_t hx711_flash__pico_enter(bool* const lockout) {
+
+    *lockout = multicore_lockout_victim_is_initialized(get_core_num() ^ 1);
+
+    if(*lockout) {
+        multicore_lockout_start_blocking();
+    }
+
+    return save_and_disable_interrupts();
+
+}
+
+static void hx711_flash__pico_exit(
+    const uint32_t status,
+    const bool lockout) {
+
+        restore_interrupts(status);
+
+        if(lockout) {
+            multicore_lockout_end_blocking();
+        }
+
+}
+
+static bool hx711_flash__pico_erase(
+    void* ctx,
+    size_t offset) {
+
+        (void)ctx;
+        assert(offset % FLASH_SECTOR_SIZE == 0);
+        assert(offset + FLASH_SECTOR_SIZE <= PICO_FLASH_SIZE_BYTES);
+
+        bool lockout;
+        const uint32_t status = hx711_flash__pico_enter(&lockout);
+        flash_range_erase(offset, FLASH_SECTOR_SIZE);
+        hx711_flash__pico_exit(status, lockout);
+
+        return true;
+
+}
+
+static bool hx711_flash__pico_program(
+    void* ctx,
+    size_t offset,
+    const void* buf,
+    size_t len) {
+
+        (void)ctx;
+        assert(offset + len <= PICO_FLASH_SIZE_BYTES);
+
+        const uint8_t* src = (const uint8_t*)buf;
+        uint8_t page[FLASH_PAGE_SIZE];
+
+        //flash is programmed in whole pages, so merge the data
+        //into a copy of the existing page; programming the
+        //unchanged bytes again leaves them as they are
+        while(len > 0) {
+
+            const size_t page_offset = offset - (offset % FLASH_PAGE_SIZE);
+            const size_t start = offset - page_offset;
+            const size_t n = MIN(len, FLASH_PAGE_SIZE - start);
+
+            memcpy(page, (const void*)(XIP_BASE + page_offset), FLASH_PAGE_SIZE);
+            memcpy(&page[start], src, n);
+
+            bool lockout;
+            const uint32_t status = hx711_flash__pico_enter(&lockout);
+            flash_range_program(page_offset, page, FLASH_PAGE_SIZE);
+            hx711_flash__pico_exit(status, lockout);
+
+            offset += n;
+            src += n;
+            len -= n;
+
+        }
+
+        return true;
+
+}
+
+void hx711_flash_pico_init(hx711_flash_t* const flash) {
+
+    assert(flash != NULL);
+
+    flash->sector_size = FLASH_SECTOR_SIZE;
+    flash->ctx = NULL;
+    flash->read = hx711_flash__pico_read;
+    flash->erase = hx711_flash__pico_erase;
+    flash->program = hx711_flash__pico_program;
+
+}
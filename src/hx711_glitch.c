@@ -0,0 +1,175 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_decode.h"
+#include "../include/hx711_glitch.h"
+
+void hx711_glitch_get_default_config(hx711_glitch_config_t* const config) {
+
+    assert(config != NULL);
+
+    config->max_delta = INT32_C(1) << 20;
+    config->shift = 2;
+    config->max_rejects = 3;
+    config->replace = true;
+
+}
+
+void hx711_glitch_init(
+    hx711_glitch_t* const g,
+    const hx711_glitch_config_t* const config) {
+
+        assert(g != NULL);
+        assert(config != NULL);
+        assert(config->max_delta > 0);
+        assert(config->shift <= HX711_GLITCH_MAX_SHIFT);
+
+        g->_max_delta = config->max_delta;
+        g->_shift = config->shift;
+        g->_max_rejects = config->max_rejects;
+        g->_replace = config->replace;
+
+        hx711_glitch_reset(g);
+
+}
+
+void hx711_glitch_reset(hx711_glitch_t* const g) {
+    assert(g != NULL);
+    g->_primed = false;
+    g->_rejects = 0;
+    g->_quality = HX711_QUALITY_OK;
+    g->_acc = 0;
+}
+
+uint8_t hx711_glitch_filter(
+    hx711_glitch_t* const g,
+    int32_t* const val) {
+
+        assert(g != NULL);
+        assert(val != NULL);
+
+        const int32_t v = *val;
+        uint8_t quality = HX711_QUALITY_OK;
+
+        if(v == HX711_DECODE_MIN_VALUE || v == HX711_DECODE_MAX_VALUE) {
+            quality |= HX711_QUALITY_SATURATED;
+        }
+
+        /**
+         * _acc holds the estimate scaled by 2^shift. With 24-bit
+         * values and a shift of at most 7 it fits in 31 bits, so
+         * the update is exact without 64-bit arithmetic.
+         */
+        const int32_t est = g->_acc >> g->_shift;
+        const int32_t delta = v - est;
+
+        if(!g->_primed) {
+
+            /**
+             * With max_rejects set, a glitch which primes the
+             * estimate is followed as a step once the real values
+             * have been rejected enough times. With 0 nothing would
+             * ever replace it, so the estimate only starts once
+             * HX711_GLITCH_PRIME_SAMPLES values agree; _rejects
+             * counts them and a value which disagrees starts the
+             * count again from itself. Values pass through
+             * unchanged until then.
+             */
+            const uint8_t needed = g->_max_rejects == 0
+                ? HX711_GLITCH_PRIME_SAMPLES
+                : 1;
+
+            if(g->_rejects == 0 || delta > g->_max_delta || delta < -g->_max_delta) {
+                g->_acc = v * (INT32_C(1) << g->_shift);
+                g->_rejects = 1;
+            }
+            else {
+                g->_acc += delta;
+                ++g->_rejects;
+            }
+
+            if(g->_rejects >= needed) {
+                g->_primed = true;
+                g->_rejects = 0;
+            }
+
+            g->_quality = quality;
+            return quality;
+
+        }
+
+        if(delta > g->_max_delta || delta < -g->_max_delta) {
+
+            if(g->_max_rejects == 0 || ++g->_rejects < g->_max_rejects) {
+                quality |= HX711_QUALITY_GLITCH;
+                if(g->_replace) {
+                    *val = est;
+                    quality |= HX711_QUALITY_REPLACED;
+                }
+                g->_quality = quality;
+                return quality;
+            }
+
+            //the "glitch" has persisted, so follow it
+            g->_acc = v * (INT32_C(1) << g->_shift);
+            g->_rejects = 0;
+            quality |= HX711_QUALITY_STEP;
+            g->_quality = quality;
+            return quality;
+
+        }
+
+        g->_rejects = 0;
+        g->_acc += delta;
+        g->_quality = quality;
+
+        return quality;
+
+}
+
+void hx711_glitch_filter_multi(
+    hx711_glitch_t* const gs,
+    int32_t* const values,
+    const size_t len) {
+
+        assert(gs != NULL);
+        assert(values != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            hx711_glitch_filter(&gs[i], &values[i]);
+        }
+
+}
+
+uint8_t hx711_glitch_get_quality(const hx711_glitch_t* const g) {
+    assert(g != NULL);
+    return g->_quality;
+}
+
+int32_t hx711_glitch_get_estimate(const hx711_glitch_t* const g) {
+    assert(g != NULL);
+    return g->_acc >> g->_shift;
+}
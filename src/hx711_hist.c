@@ -0,0 +1,162 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/sync.h"
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "../include/hx711_hist.h"
+#include "../include/util.h"
+
+void hx711_hist_init(hx711_hist_t* const hist) {
+
+    assert(hist != NULL);
+
+    hist->_seq = 0;
+    hist->_count = 0;
+    hist->_min = UINT32_MAX;
+    hist->_max = 0;
+
+    for(uint i = 0; i < HX711_HIST_BUCKETS; ++i) {
+        hist->_buckets[i] = 0;
+    }
+
+}
+
+void UTIL_HOT_FUNC(hx711_hist_record)(
+    hx711_hist_t* const hist,
+    const uint32_t val) {
+
+        assert(hist != NULL);
+
+        //an odd sequence number tells readers an update
+        //is in progress
+        ++hist->_seq;
+        __dmb();
+
+        ++hist->_buckets[hx711_hist_get_bucket(val)];
+        ++hist->_count;
+
+        if(val < hist->_min) {
+            hist->_min = val;
+        }
+
+        if(val > hist->_max) {
+            hist->_max = val;
+        }
+
+        __dmb();
+        ++hist->_seq;
+
+}
+
+bool hx711_hist_snapshot(
+    const hx711_hist_t* const hist,
+    hx711_hist_snapshot_t* const snap) {
+
+        assert(hist != NULL);
+        assert(snap != NULL);
+
+        //a writer preempted on this core never finishes, so
+        //give up rather than spin forever
+        for(uint tries = 0; tries < HX711_HIST_SNAPSHOT_TRIES; ++tries) {
+
+            const uint32_t seq = hist->_seq;
+
+            if(seq & 1) {
+                tight_loop_contents();
+                continue;
+            }
+
+            __dmb();
+
+            snap->count = hist->_count;
+            snap->min = hist->_min;
+            snap->max = hist->_max;
+
+            for(uint i = 0; i < HX711_HIST_BUCKETS; ++i) {
+                snap->buckets[i] = hist->_buckets[i];
+            }
+
+            __dmb();
+
+            if(seq == hist->_seq) {
+                if(snap->count == 0) {
+                    snap->min = 0;
+                }
+                return true;
+            }
+
+        }
+
+        return false;
+
+}
+
+uint UTIL_HOT_FUNC(hx711_hist_get_bucket)(const uint32_t val) {
+    return val == 0 ? 0 : 32 - (uint)__builtin_clz(val);
+}
+
+uint32_t hx711_hist_get_bucket_max(const uint bucket) {
+
+    assert(bucket < HX711_HIST_BUCKETS);
+
+    if(bucket == HX711_HIST_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+
+    return (UINT32_C(1) << bucket) - 1;
+
+}
+
+uint32_t hx711_hist_get_percentile(
+    const hx711_hist_snapshot_t* const snap,
+    const uint pct) {
+
+        assert(snap != NULL);
+        assert(pct <= 100);
+
+        if(snap->count == 0) {
+            return 0;
+        }
+
+        //smallest number of values which satisfies pct
+        const uint64_t target =
+            ((uint64_t)snap->count * pct + 99) / 100;
+
+        uint64_t seen = 0;
+
+        for(uint i = 0; i < HX711_HIST_BUCKETS; ++i) {
+            seen += snap->buckets[i];
+            if(seen >= target && seen > 0) {
+                //no value is larger than the max, so it
+                //is a tighter bound for the last bucket
+                const uint32_t bucketMax = hx711_hist_get_bucket_max(i);
+                return bucketMax < snap->max ? bucketMax : snap->max;
+            }
+        }
+
+        return snap->max;
+
+}
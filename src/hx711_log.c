@@ -0,0 +1,378 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/hx711_crc.h"
+#include "../include/hx711_flash.h"
+#include "../include/hx711_log.h"
+
+static_assert(sizeof(hx711_log_page_header_t) == 16,
+    "hx711_log_page_header_t is stored in flash and must not change size");
+
+static_assert(HX711_LOG_PAGE_LEN > sizeof(hx711_log_page_header_t) + 1,
+    "HX711_LOG_PAGE_LEN is too small");
+
+static uint32_t hx711_log__crc(
+    const uint8_t* const page,
+    const size_t used) {
+
+        uint32_t crc = hx711_crc32_update(
+            HX711_CRC32_INIT,
+            page,
+            offsetof(hx711_log_page_header_t, crc));
+
+        crc = hx711_crc32_update(
+            crc,
+            &page[sizeof(hx711_log_page_header_t)],
+            used);
+
+        return ~crc;
+
+}
+
+bool hx711_log_init(
+    hx711_log_t* const log,
+    hx711_flash_t* const flash,
+    const size_t offset,
+    const size_t sectors) {
+
+        assert(log != NULL);
+        assert(flash != NULL);
+        assert(flash->sector_size % HX711_LOG_PAGE_LEN == 0);
+        assert(offset % flash->sector_size == 0);
+        assert(sectors >= 2);
+
+        log->_flash = flash;
+        log->_offset = offset;
+        log->_pages_per_sector = flash->sector_size / HX711_LOG_PAGE_LEN;
+        log->_pages = log->_pages_per_sector * sectors;
+        log->_next = 0;
+        log->_seq = 0;
+        log->_fill = 0;
+        log->_erased_ahead = false;
+
+        uint8_t* const buf = log->_page;
+        hx711_log_page_header_t hdr;
+        bool valid;
+        bool found = false;
+        size_t newest = 0;
+        uint32_t seq = 0;
+
+        //sectors are filled in order, so the newest sector is
+        //the one whose first page is newest
+        for(size_t s = 0; s < sectors; ++s) {
+
+            const size_t page = s * log->_pages_per_sector;
+
+            if(!hx711_log__read_page(log, page, buf, &hdr, &valid)) {
+                return false;
+            }
+
+            if(valid && (!found || hdr.seq > seq)) {
+                found = true;
+                newest = page;
+                seq = hdr.seq;
+            }
+
+        }
+
+        if(!found) {
+            //nothing logged yet
+            return true;
+        }
+
+        //then find the last page written in that sector
+        const size_t end = newest + log->_pages_per_sector;
+        size_t page = newest + 1;
+
+        for(; page < end; ++page) {
+
+            if(!hx711_log__read_page(log, page, buf, &hdr, &valid)) {
+                return false;
+            }
+
+            if(!valid || hdr.seq <= seq) {
+                break;
+            }
+
+            seq = hdr.seq;
+
+        }
+
+        //skip anything left by an interrupted write; only a
+        //blank page can be programmed
+        for(; page < end; ++page) {
+
+            if(!log->_flash->read(
+                log->_flash->ctx,
+                hx711_log__page_offset(log, page),
+                buf,
+                HX711_LOG_PAGE_LEN)) {
+                    return false;
+            }
+
+            size_t i = 0;
+            while(i < HX711_LOG_PAGE_LEN && buf[i] == HX711_FLASH_ERASED_BYTE) {
+                ++i;
+            }
+
+            if(i == HX711_LOG_PAGE_LEN) {
+                break;
+            }
+
+        }
+
+        log->_next = page % log->_pages;
+        log->_seq = seq + 1;
+
+        return true;
+
+}
+
+bool hx711_log_append(
+    hx711_log_t* const log,
+    const void* const data,
+    const size_t len) {
+
+        assert(log != NULL);
+        assert(data != NULL);
+        assert(len > 0);
+        assert(len <= HX711_LOG_MAX_RECORD_LEN);
+
+        if(log->_fill + 1 + len > HX711_LOG_PAYLOAD_LEN) {
+            if(!hx711_log_flush(log)) {
+                return false;
+            }
+        }
+
+        uint8_t* const p = &log->_page[sizeof(hx711_log_page_header_t) + log->_fill];
+
+        p[0] = (uint8_t)len;
+        memcpy(&p[1], data, len);
+        log->_fill += 1 + len;
+
+        return true;
+
+}
+
+bool hx711_log_flush(hx711_log_t* const log) {
+
+    assert(log != NULL);
+
+    if(log->_fill == 0) {
+        return true;
+    }
+
+    hx711_log_page_header_t hdr = {
+        .magic = HX711_LOG_MAGIC,
+        .seq = log->_seq,
+        .used = (uint16_t)log->_fill,
+        .reserved = 0xffff
+    };
+
+    memcpy(log->_page, &hdr, sizeof(hdr));
+
+    //leave the unused tail erased
+    memset(
+        &log->_page[sizeof(hdr) + log->_fill],
+        HX711_FLASH_ERASED_BYTE,
+        HX711_LOG_PAYLOAD_LEN - log->_fill);
+
+    hdr.crc = hx711_log__crc(log->_page, log->_fill);
+    memcpy(log->_page, &hdr, sizeof(hdr));
+
+    const size_t offset = hx711_log__page_offset(log, log->_next);
+
+    if(log->_next % log->_pages_per_sector == 0) {
+        if(log->_erased_ahead) {
+            log->_erased_ahead = false;
+        }
+        else if(!log->_flash->erase(log->_flash->ctx, offset)) {
+            return false;
+        }
+    }
+
+    //move on even if programming fails so the next attempt is
+    //on a fresh page
+    const bool ok = log->_flash->program(
+        log->_flash->ctx,
+        offset,
+        log->_page,
+        HX711_LOG_PAGE_LEN);
+
+    log->_next = (log->_next + 1) % log->_pages;
+    ++log->_seq;
+    log->_fill = 0;
+
+    return ok;
+
+}
+
+bool hx711_log_erase_ahead(hx711_log_t* const log) {
+
+    assert(log != NULL);
+
+    if(log->_erased_ahead) {
+        return true;
+    }
+
+    //the first page of the sector writing will move on to; the
+    //next page itself if it starts one
+    const size_t pps = log->_pages_per_sector;
+    const size_t page = ((log->_next + pps - 1) / pps * pps) % log->_pages;
+
+    if(!log->_flash->erase(
+        log->_flash->ctx,
+        hx711_log__page_offset(log, page))) {
+            return false;
+    }
+
+    log->_erased_ahead = true;
+
+    return true;
+
+}
+
+void hx711_log_reader_init(
+    hx711_log_reader_t* const r,
+    const hx711_log_t* const log) {
+
+        assert(r != NULL);
+        assert(log != NULL);
+
+        //the oldest page is the first written one at or after
+        //the next page to be written, going round the ring
+        r->_log = log;
+        r->_page = log->_next;
+        r->_remaining = log->_pages;
+        r->_started = false;
+        r->_seq = 0;
+        r->_pos = 0;
+        r->_used = 0;
+
+}
+
+bool hx711_log_reader_next(
+    hx711_log_reader_t* const r,
+    void* const buf,
+    size_t* const len) {
+
+        assert(r != NULL);
+        assert(buf != NULL);
+        assert(len != NULL);
+
+        for(;;) {
+
+            while(r->_pos >= r->_used) {
+
+                hx711_log_page_header_t hdr;
+                bool valid = false;
+
+                while(!valid && r->_remaining > 0) {
+
+                    if(!hx711_log__read_page(r->_log, r->_page, r->_buf, &hdr, &valid)) {
+                        valid = false;
+                    }
+
+                    //a stale page from before the ring last
+                    //wrapped is older than what has been read
+                    if(valid && r->_started && hdr.seq <= r->_seq) {
+                        valid = false;
+                    }
+
+                    r->_page = (r->_page + 1) % r->_log->_pages;
+                    --r->_remaining;
+
+                }
+
+                if(!valid) {
+                    return false;
+                }
+
+                r->_started = true;
+                r->_seq = hdr.seq;
+                r->_pos = 0;
+                r->_used = hdr.used;
+
+            }
+
+            const uint8_t* const p = &r->_buf[sizeof(hx711_log_page_header_t) + r->_pos];
+            const size_t n = p[0];
+
+            //the CRC passed, so this can only come from a bad
+            //writer, but don't read past the page
+            if(n == 0 || r->_pos + 1 + n > r->_used) {
+                r->_pos = r->_used;
+                continue;
+            }
+
+            memcpy(buf, &p[1], n);
+            *len = n;
+            r->_pos += 1 + n;
+
+            return true;
+
+        }
+
+}
+
+uint32_t hx711_log_reader_get_seq(const hx711_log_reader_t* const r) {
+    assert(r != NULL);
+    return r->_seq;
+}
+
+size_t hx711_log__page_offset(
+    const hx711_log_t* const log,
+    const size_t page) {
+        return log->_offset + page * HX711_LOG_PAGE_LEN;
+}
+
+bool hx711_log__read_page(
+    const hx711_log_t* const log,
+    const size_t page,
+    uint8_t* const buf,
+    hx711_log_page_header_t* const hdr,
+    bool* const valid) {
+
+        *valid = false;
+
+        if(!log->_flash->read(
+            log->_flash->ctx,
+            hx711_log__page_offset(log, page),
+            buf,
+            HX711_LOG_PAGE_LEN)) {
+                return false;
+        }
+
+        memcpy(hdr, buf, sizeof(*hdr));
+
+        *valid = hdr->magic == HX711_LOG_MAGIC &&
+            hdr->used <= HX711_LOG_PAYLOAD_LEN &&
+            hdr->crc == hx711_log__crc(buf, hdr->used);
+
+        return true;
+
+}
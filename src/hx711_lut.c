@@ -0,0 +1,126 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_lut.h"
+
+bool hx711_lut_init(
+    hx711_lut_t* const lut,
+    const hx711_lut_point_t* const points,
+    const size_t len) {
+
+        assert(lut != NULL);
+        assert(points != NULL);
+        assert(len >= 2);
+        assert(len <= HX711_LUT_MAX_POINTS);
+
+        //insertion sort by raw value; there are only a few
+        for(size_t i = 0; i < len; ++i) {
+
+            size_t j = i;
+
+            while(j > 0 && lut->_raw[j - 1] > points[i].raw) {
+                lut->_raw[j] = lut->_raw[j - 1];
+                lut->_value[j] = lut->_value[j - 1];
+                --j;
+            }
+
+            lut->_raw[j] = points[i].raw;
+            lut->_value[j] = points[i].value;
+
+        }
+
+        for(size_t i = 0; i < len - 1; ++i) {
+
+            const int64_t dx = (int64_t)lut->_raw[i + 1] - lut->_raw[i];
+            const int64_t dy = (int64_t)lut->_value[i + 1] - lut->_value[i];
+
+            if(dx == 0) {
+                return false;
+            }
+
+            //rounded to nearest
+            const int64_t num = dy * (INT64_C(1) << HX711_LUT_SLOPE_Q);
+            const int64_t slope = (num + (num >= 0 ? dx / 2 : -dx / 2)) / dx;
+
+            if(slope > INT32_MAX || slope < -INT32_MAX) {
+                return false;
+            }
+
+            lut->_slope[i] = (int32_t)slope;
+
+        }
+
+        lut->_len = len;
+
+        return true;
+
+}
+
+int32_t hx711_lut_apply(
+    const hx711_lut_t* const lut,
+    const int32_t raw) {
+
+        assert(lut != NULL);
+        assert(lut->_len >= 2);
+
+        //find the last segment starting at or below raw,
+        //clamped to the first and last segments
+        size_t lo = 0;
+        size_t hi = lut->_len - 2;
+
+        while(lo < hi) {
+            const size_t mid = (lo + hi + 1) / 2;
+            if(lut->_raw[mid] <= raw) {
+                lo = mid;
+            }
+            else {
+                hi = mid - 1;
+            }
+        }
+
+        const int64_t dx = (int64_t)raw - lut->_raw[lo];
+        const int64_t round = INT64_C(1) << (HX711_LUT_SLOPE_Q - 1);
+
+        return lut->_value[lo] + (int32_t)
+            ((dx * lut->_slope[lo] + round) >> HX711_LUT_SLOPE_Q);
+
+}
+
+void hx711_lut_apply_multi(
+    const hx711_lut_t* const luts,
+    const int32_t* const raw,
+    int32_t* const out,
+    const size_t len) {
+
+        assert(luts != NULL);
+        assert(raw != NULL);
+        assert(out != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            out[i] = hx711_lut_apply(&luts[i], raw[i]);
+        }
+
+}
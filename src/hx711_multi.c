@@ -24,6 +24,7 @@
 #include <math.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <strings.h>
 #include "hardware/dma.h"
 #include "hardware/gpio.h"
@@ -34,9 +35,24 @@
 #include "pico/time.h"
 #include "pico/types.h"
 #include "../include/hx711.h"
+#include "../include/hx711_hist.h"
 #include "../include/hx711_multi.h"
+#include "../include/hx711_multi_decode.h"
+#include "../include/hx711_trace.h"
 #include "../include/util.h"
 
+/**
+ * Samples for hx711_multi_get_values_avg (sums) or
+ * hx711_multi_get_values_median (sorted), filled from the DMA
+ * IRQ handler during one continuous read.
+ */
+typedef struct {
+    uint n;
+    volatile uint count;
+    int64_t* sums;
+    int32_t (*sorted)[HX711_MEDIAN_MAX_SAMPLES];
+} hx711_multi__samples_t;
+
 hx711_multi_t* hx711_multi__async_read_array[] = {
     NULL, //...
 };
@@ -64,12 +80,18 @@ void hx711_multi__init_asert(
         assert(util_pio_irq_index_is_valid(config->pio_irq_index));
         assert(util_dma_irq_index_is_valid(config->dma_irq_index));
 
+        if(config->rate_pin != HX711_NO_RATE_PIN) {
+            check_gpio_param(config->rate_pin);
+            assert(config->rate_pin != config->clock_pin);
+        }
+
 #ifndef NDEBUG
         {
             //make sure none of the data pins are also the clock pin
             const uint l = config->data_pin_base + config->chips_len - 1;
             for(uint i = config->data_pin_base; i <= l; ++i) {
                 assert(i != config->clock_pin);
+                assert(i != config->rate_pin);
             }
         }
 #endif
@@ -229,7 +251,7 @@ void hx711_multi__init_irq(hx711_multi_t* const hxm) {
 
 }
 
-bool hx711_multi__async_dma_irq_is_set(
+bool UTIL_HOT_FUNC(hx711_multi__async_dma_irq_is_set)(
     hx711_multi_t* const hxm) {
 
         assert(hx711_multi__is_initd(hxm));
@@ -240,7 +262,7 @@ bool hx711_multi__async_dma_irq_is_set(
 
 }
 
-bool hx711_multi__async_pio_irq_is_set(
+bool UTIL_HOT_FUNC(hx711_multi__async_pio_irq_is_set)(
     hx711_multi_t* const hxm) {
 
         assert(hx711_multi__is_initd(hxm));
@@ -251,7 +273,7 @@ bool hx711_multi__async_pio_irq_is_set(
 
 }
 
-hx711_multi_t* const hx711_multi__async_get_dma_irq_request() {
+hx711_multi_t* const UTIL_HOT_FUNC(hx711_multi__async_get_dma_irq_request)() {
 
     assert(hx711_multi__async_read_array != NULL);
 
@@ -271,7 +293,7 @@ hx711_multi_t* const hx711_multi__async_get_dma_irq_request() {
 
 }
 
-hx711_multi_t* const hx711_multi__async_get_pio_irq_request() {
+hx711_multi_t* const UTIL_HOT_FUNC(hx711_multi__async_get_pio_irq_request)() {
 
     assert(hx711_multi__async_read_array != NULL);
 
@@ -291,12 +313,20 @@ hx711_multi_t* const hx711_multi__async_get_pio_irq_request() {
 
 }
 
-void hx711_multi__async_start_dma(
+void UTIL_HOT_FUNC(hx711_multi__async_start_dma)(
     hx711_multi_t* const hxm) {
 
         assert(hx711_multi__is_state_machines_enabled(hxm));
         assert(hxm->_async_state == HX711_MULTI_ASYNC_STATE_WAITING);
 
+#ifdef HX711_STATS
+        //the reader pushes without blocking, so once the RX
+        //FIFO is full any further bits are silently dropped
+        if(pio_sm_is_rx_fifo_full(hxm->_pio, hxm->_reader_sm)) {
+            HX711_STATS_INC(hxm->_stats, overruns);
+        }
+#endif
+
         util_pio_sm_clear_rx_fifo(
             hxm->_pio,
             hxm->_reader_sm);
@@ -311,11 +341,31 @@ void hx711_multi__async_start_dma(
 
         dma_channel_set_write_addr(
             hxm->_dma_channel,
-            hxm->_buffer,
+            hxm->_frame,
             true); //trigger
 
 }
 
+void UTIL_HOT_FUNC(hx711_multi__async_arm)(
+    hx711_multi_t* const hxm) {
+
+        assert(hxm->_async_state == HX711_MULTI_ASYNC_STATE_WAITING);
+
+        //if pio interrupt is already set, we can bypass the
+        //IRQ handler and immediately trigger dma
+        if(pio_interrupt_get(hxm->_pio, HX711_MULTI_CONVERSION_DONE_IRQ_NUM)) {
+            hx711_multi__async_start_dma(hxm);
+        }
+        else {
+            pio_set_irqn_source_enabled(
+                hxm->_pio,
+                hxm->_pio_irq_index,
+                util_pio_get_pis_from_pio_interrupt_num(HX711_MULTI_CONVERSION_DONE_IRQ_NUM),
+                true);
+        }
+
+}
+
 bool hx711_multi__async_is_running(
     hx711_multi_t* const hxm) {
 
@@ -332,7 +382,7 @@ bool hx711_multi__async_is_running(
 
 }
 
-static void hx711_multi__async_finish(
+static void UTIL_HOT_FUNC(hx711_multi__async_disarm)(
     hx711_multi_t* const hxm) {
 
         assert(hx711_multi__is_initd(hxm));
@@ -352,13 +402,24 @@ static void hx711_multi__async_finish(
             util_pio_get_pis_from_pio_interrupt_num(HX711_MULTI_CONVERSION_DONE_IRQ_NUM),
             false);
 
+}
+
+static void UTIL_HOT_FUNC(hx711_multi__async_finish)(
+    hx711_multi_t* const hxm) {
+
+        hx711_multi__async_disarm(hxm);
+
 #ifndef HX711_NO_MUTEX
         mutex_exit(&hxm->_mut);
 #endif
 
 }
 
-void __isr __not_in_flash_func(hx711_multi__async_pio_irq_handler)() {
+void __isr UTIL_HOT_FUNC(hx711_multi__async_pio_irq_handler)() {
+
+#ifdef HX711_STATS
+    const uint32_t startCycles = util_cycle_counter_get();
+#endif
 
     hx711_multi_t* const hxm = 
         hx711_multi__async_get_pio_irq_request();
@@ -366,6 +427,13 @@ void __isr __not_in_flash_func(hx711_multi__async_pio_irq_handler)() {
     assert(hx711_multi__is_state_machines_enabled(hxm));
     assert(hxm->_async_state == HX711_MULTI_ASYNC_STATE_WAITING);
 
+    //words already waiting in the reader's RX FIFO before the
+    //DMA starts draining it
+    HX711_TRACE_WRITE(
+        HX711_TRACE_EVENT_PIO_IRQ,
+        HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+        pio_sm_get_rx_fifo_level(hxm->_pio, hxm->_reader_sm));
+
     hx711_multi__async_start_dma(hxm);
 
     //disable listening until required again
@@ -378,9 +446,19 @@ void __isr __not_in_flash_func(hx711_multi__async_pio_irq_handler)() {
     irq_clear(
         util_pio_get_irq_from_index(hxm->_pio, hxm->_pio_irq_index));
 
+#ifdef HX711_STATS
+    HX711_STATS_ADD_ISR(
+        hxm->_stats,
+        util_cycle_counter_elapsed(startCycles, util_cycle_counter_get()));
+#endif
+
 }
 
-void __isr __not_in_flash_func(hx711_multi__async_dma_irq_handler)() {
+void __isr UTIL_HOT_FUNC(hx711_multi__async_dma_irq_handler)() {
+
+#ifdef HX711_STATS
+    const uint32_t startCycles = util_cycle_counter_get();
+#endif
 
     hx711_multi_t* const hxm =
         hx711_multi__async_get_dma_irq_request();
@@ -388,18 +466,76 @@ void __isr __not_in_flash_func(hx711_multi__async_dma_irq_handler)() {
     assert(hx711_multi__is_state_machines_enabled(hxm));
     assert(hxm->_async_state == HX711_MULTI_ASYNC_STATE_READING);
 
-    hxm->_async_state = HX711_MULTI_ASYNC_STATE_DONE;
+    //decode here only if something here needs the values; the
+    //frame callback and hx711_multi_async_get_values reuse them
+    hxm->_values_valid = hxm->_alarms != NULL || hxm->_frame_cb != NULL;
+
+    if(hxm->_values_valid) {
+        hx711_multi__pinvals_to_values_inline(
+            hxm->_frame,
+            hxm->_values,
+            hxm->_chips_len);
+    }
+
+    //alarms go first so their pins change as soon as possible
+    //after the conversion, and before the read is seen as done
+    if(hxm->_alarms != NULL) {
+        hx711_alarm_update_multi(
+            hxm->_alarms,
+            hxm->_values,
+            hxm->_chips_len);
+    }
+
+    HX711_STATS_INC(hxm->_stats, frames);
+
+    HX711_TRACE_WRITE(
+        HX711_TRACE_EVENT_DMA_IRQ,
+        HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+        util_dma_get_transfer_count(hxm->_dma_channel));
+
+#ifdef HX711_HIST
+    {
+        const uint32_t now = time_us_32();
+        if(hxm->_frame_time_valid) {
+            hx711_hist_record(
+                &hxm->_interval_hist,
+                now - hxm->_frame_time);
+        }
+        hxm->_frame_time = now;
+        hxm->_frame_time_valid = true;
+    }
+#endif
 
     dma_irqn_acknowledge_channel(
         hxm->_dma_irq_index,
         hxm->_dma_channel);
 
-    hx711_multi__async_finish(hxm);
+    if(hxm->_frame_cb == NULL) {
+        hxm->_async_state = HX711_MULTI_ASYNC_STATE_DONE;
+        hx711_multi__async_finish(hxm);
+    }
+    else if(hxm->_frame_cb(hxm, hxm->_frame, hxm->_values, hxm->_frame_cb_ctx)) {
+        //continuous; go straight back to waiting for the
+        //next conversion without passing through DONE
+        hxm->_async_state = HX711_MULTI_ASYNC_STATE_WAITING;
+        hx711_multi__async_arm(hxm);
+    }
+    else {
+        hxm->_frame_cb = NULL;
+        hxm->_async_state = HX711_MULTI_ASYNC_STATE_DONE;
+        hx711_multi__async_finish(hxm);
+    }
 
     irq_clear(
         util_dma_get_irqn(
             hxm->_dma_irq_index));
 
+#ifdef HX711_STATS
+    HX711_STATS_ADD_ISR(
+        hxm->_stats,
+        util_cycle_counter_elapsed(startCycles, util_cycle_counter_get()));
+#endif
+
 }
 
 bool hx711_multi__async_add_reader(
@@ -436,6 +572,51 @@ void hx711_multi__async_remove_reader(
 
 }
 
+void hx711_multi__async_acquire_frame(
+    hx711_multi_t* const hxm) {
+
+        const int prev = hx711_multi__get_pool_index(
+            hxm,
+            hxm->_frame);
+
+        //nobody else has the previous frame, so reuse it
+        if(prev >= 0 && !hxm->_frame_taken) {
+            hxm->_pool_free |= 1u << prev;
+        }
+
+        hxm->_frame_taken = false;
+        hxm->_frame_released = false;
+
+        if(hxm->_pool_free == 0) {
+            hxm->_frame = hxm->_buffer;
+            return;
+        }
+
+        const uint idx = (uint)__builtin_ctz(hxm->_pool_free);
+
+        hxm->_pool_free &= ~(1u << idx);
+        hxm->_frame = hxm->_pool[idx];
+
+}
+
+int hx711_multi__get_pool_index(
+    const hx711_multi_t* const hxm,
+    const uint32_t* const frame) {
+
+        if(hxm->_pool == NULL || frame == NULL) {
+            return -1;
+        }
+
+        for(size_t i = 0; i < hxm->_pool_len; ++i) {
+            if(frame == hxm->_pool[i]) {
+                return (int)i;
+            }
+        }
+
+        return -1;
+
+}
+
 static bool hx711_multi__is_initd(hx711_multi_t* const hxm) {
     return hxm != NULL &&
         hxm->_pio != NULL &&
@@ -459,7 +640,7 @@ static bool hx711_multi__is_state_machines_enabled(
             util_pio_sm_is_enabled(hxm->_pio, hxm->_reader_sm);
 }
 
-void hx711_multi_pinvals_to_values(
+void UTIL_HOT_FUNC(hx711_multi_pinvals_to_values)(
     const uint32_t* const pinvals,
     int32_t* const values,
     const size_t len) {
@@ -490,26 +671,14 @@ void hx711_multi_pinvals_to_values(
         //    ((pinvals[2] >> 0) & 1) << 22 |
         //...
         //    ((pinvals[23]) >> 0) & 1) << 0;
+        //
+        //every 24 bit value sign-extends to a valid HX711
+        //value, so there is no need to check each one.
 
-        for(size_t chipNum = 0; chipNum < len; ++chipNum) {
-
-            //reset to 0
-            //this is the raw value for an individual chip
-            uint32_t rawVal = 0;
-
-            //reconstruct an individual twos comp HX711 value from pinbits
-            for(size_t bitPos = 0; bitPos < HX711_READ_BITS; ++bitPos) {
-                const uint shift = HX711_READ_BITS - bitPos - 1;
-                const uint32_t bit = (pinvals[bitPos] >> chipNum) & 1;
-                rawVal |= bit << shift;
-            }
-
-            //then convert to a regular ones comp
-            values[chipNum] = hx711_get_twos_comp(rawVal);
-
-            assert(hx711_is_value_valid(values[chipNum]));
-
-        }
+        hx711_multi__pinvals_to_values_inline(
+            pinvals,
+            values,
+            len);
 
 }
 
@@ -542,10 +711,49 @@ void hx711_multi_init(
 
             hxm->_async_state = HX711_MULTI_ASYNC_STATE_NONE;
 
+            hxm->_pool = NULL;
+            hxm->_pool_len = 0;
+            hxm->_pool_free = 0;
+            hxm->_frame = hxm->_buffer;
+            hxm->_frame_taken = false;
+            hxm->_frame_released = false;
+            hxm->_values_valid = false;
+
+            hxm->_frame_cb = NULL;
+            hxm->_frame_cb_ctx = NULL;
+
+            hxm->_rate_pin = config->rate_pin;
+            hxm->_rate = hx711_rate_10;
+            hxm->_auto_rate = hx711_rate_10;
+            hxm->_stability = NULL;
+
+            hxm->_glitch = NULL;
+            hxm->_notch = NULL;
+            hxm->_alarms = NULL;
+
+#ifdef HX711_HIST
+            hx711_hist_init(&hxm->_latency_hist);
+            hx711_hist_init(&hxm->_interval_hist);
+            hxm->_frame_time_valid = false;
+#endif
+
+#ifdef HX711_STATS
+            hxm->_stats = (hx711_stats_t){ 0 };
+
+            //IRQ handlers run on this core, so this is the
+            //SysTick they will be timed with
+            util_cycle_counter_init();
+#endif
+
             hx711_multi__async_add_reader(hxm);
 
             util_gpio_set_output(hxm->_clock_pin);
 
+            if(hxm->_rate_pin != HX711_NO_RATE_PIN) {
+                util_gpio_set_output(hxm->_rate_pin);
+                gpio_put(hxm->_rate_pin, false);
+            }
+
             util_gpio_set_contiguous_input_pins(
                 hxm->_data_pin_base,
                 hxm->_chips_len);
@@ -608,7 +816,7 @@ void hx711_multi_close(hx711_multi_t* const hxm) {
 
         irq_remove_handler(
             util_dma_get_irqn(hxm->_dma_irq_index),
-            hx711_multi__async_pio_irq_handler);
+            hx711_multi__async_dma_irq_handler);
 
     );
 
@@ -671,6 +879,11 @@ void hx711_multi_set_gain(
             hxm->_reader_sm,
             gainVal);
 
+        HX711_TRACE_WRITE(
+            HX711_TRACE_EVENT_SET_GAIN,
+            HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+            gain);
+
         hx711_multi_async_start(hxm);
 
         while(!hx711_multi_async_done(hxm)) {
@@ -687,11 +900,23 @@ void hx711_multi_get_values(
         assert(values != NULL);
         assert(!hx711_multi__async_is_running(hxm));
 
+#ifdef HX711_STATS
+        const uint32_t spinStart = time_us_32();
+#endif
+
         hx711_multi_async_start(hxm);
         while(!hx711_multi_async_done(hxm)) {
             tight_loop_contents();
         }
+
+        HX711_STATS_ADD(
+            hxm->_stats,
+            spin_us,
+            time_us_32() - spinStart);
+
         hx711_multi_async_get_values(hxm, values);
+        hx711_multi_update_auto_rate(hxm, values);
+        hx711_multi_apply_auto_rate(hxm);
 
 }
 
@@ -707,6 +932,10 @@ bool hx711_multi_get_values_timeout(
         const absolute_time_t end = make_timeout_time_us(timeout);
         bool success = false;
 
+#ifdef HX711_STATS
+        const uint32_t spinStart = time_us_32();
+#endif
+
         hx711_multi_async_start(hxm);
 
         while(!time_reached(end)) {
@@ -716,14 +945,26 @@ bool hx711_multi_get_values_timeout(
             }
         }
 
+        HX711_STATS_ADD(
+            hxm->_stats,
+            spin_us,
+            time_us_32() - spinStart);
+
         if(success) {
             hx711_multi_async_get_values(hxm, values);
+            hx711_multi_update_auto_rate(hxm, values);
         }
         else {
             //if timed out, cancel DMA and stop listening
             //for IRQs and exit mutex. Do this atomically!
             UTIL_INTERRUPTS_OFF_BLOCK(
                 hx711_multi__async_finish(hxm);
+                HX711_STATS_INC(hxm->_stats, timeouts);
+                HX711_TRACE_WRITE(
+                    HX711_TRACE_EVENT_TIMEOUT,
+                    HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+                    hxm->_async_state);
+                hxm->_async_state = HX711_MULTI_ASYNC_STATE_NONE;
             );
         }
 
@@ -747,37 +988,356 @@ void hx711_multi_async_start(hx711_multi_t* const hxm) {
 
     hxm->_async_state = HX711_MULTI_ASYNC_STATE_WAITING;
 
-    //if pio interrupt is already set, we can bypass the
-    //IRQ handler and immediately trigger dma
-    if(pio_interrupt_get(hxm->_pio, HX711_MULTI_CONVERSION_DONE_IRQ_NUM)) {
-        hx711_multi__async_start_dma(hxm);
-    }
-    else {
-        pio_set_irqn_source_enabled(
-            hxm->_pio,
-            hxm->_pio_irq_index,
-            util_pio_get_irq_from_index(hxm->_pio, hxm->_pio_irq_index),
-            true);
-    }
+    hx711_multi__async_acquire_frame(hxm);
+
+    hx711_multi__async_arm(hxm);
+
+    //READING means the IRQ handler was bypassed
+    HX711_TRACE_WRITE(
+        HX711_TRACE_EVENT_ASYNC_START,
+        HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+        hxm->_async_state == HX711_MULTI_ASYNC_STATE_READING);
 
     restore_interrupts(status);
 
 }
 
-bool hx711_multi_async_done(hx711_multi_t* const hxm) {
+void hx711_multi_async_start_continuous(
+    hx711_multi_t* const hxm,
+    hx711_multi_frame_cb_t cb,
+    void* const ctx) {
+
+        assert(hx711_multi__is_state_machines_enabled(hxm));
+        assert(!hx711_multi__async_is_running(hxm));
+        assert(cb != NULL);
+
+        const uint32_t status = save_and_disable_interrupts();
+
+#ifndef HX711_NO_MUTEX
+        mutex_enter_blocking(&hxm->_mut);
+#endif
+
+        hxm->_async_state = HX711_MULTI_ASYNC_STATE_WAITING;
+
+        //the callback consumes each frame before the next
+        //lands, so one buffer is enough
+        hxm->_frame = hxm->_buffer;
+        hxm->_frame_taken = false;
+        hxm->_frame_released = false;
+
+        hxm->_frame_cb = cb;
+        hxm->_frame_cb_ctx = ctx;
+
+        hx711_multi__async_arm(hxm);
+
+        //READING means the IRQ handler was bypassed
+        HX711_TRACE_WRITE(
+            HX711_TRACE_EVENT_ASYNC_START,
+            HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+            hxm->_async_state == HX711_MULTI_ASYNC_STATE_READING);
+
+        restore_interrupts(status);
+
+}
+
+void hx711_multi_async_stop(hx711_multi_t* const hxm) {
+
+    assert(hx711_multi__is_state_machines_enabled(hxm));
+
+    UTIL_INTERRUPTS_OFF_BLOCK(
+        if(hx711_multi__async_is_running(hxm)) {
+            hxm->_frame_cb = NULL;
+            hx711_multi__async_finish(hxm);
+            hxm->_async_state = HX711_MULTI_ASYNC_STATE_NONE;
+        }
+    );
+
+}
+
+bool UTIL_HOT_FUNC(hx711_multi_async_done)(hx711_multi_t* const hxm) {
     assert(hx711_multi__is_initd(hxm));
     return hxm->_async_state == HX711_MULTI_ASYNC_STATE_DONE;
 }
 
-void hx711_multi_async_get_values(
+const uint32_t* UTIL_HOT_FUNC(hx711_multi_async_get_frame)(
     hx711_multi_t* const hxm,
     int32_t* const values) {
+
         assert(hx711_multi__is_initd(hxm));
         assert(hx711_multi_async_done(hxm));
-        hx711_multi_pinvals_to_values(
-            hxm->_buffer,
-            values,
-            hxm->_chips_len);
+        assert(!hxm->_frame_released);
+
+#ifdef HX711_STATS
+        hxm->_decode_start_cycles = util_cycle_counter_get();
+#endif
+
+        if(hxm->_values_valid) {
+            memcpy(values, hxm->_values, hxm->_chips_len * sizeof(int32_t));
+            return NULL;
+        }
+
+        return hxm->_frame;
+
+}
+
+void UTIL_HOT_FUNC(hx711_multi_async_process_values)(
+    hx711_multi_t* const hxm,
+    int32_t* const values) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(hx711_multi_async_done(hxm));
+
+#ifdef HX711_HIST
+        //after hx711_multi_reset_hists, _frame_time may belong
+        //to a frame from before the reset
+        if(hxm->_frame_time_valid) {
+            hx711_hist_record(
+                &hxm->_latency_hist,
+                time_us_32() - hxm->_frame_time);
+        }
+#endif
+
+        hx711_multi__process_values(hxm, values);
+
+        HX711_STATS_ADD(
+            hxm->_stats,
+            decode_cycles,
+            util_cycle_counter_elapsed(hxm->_decode_start_cycles, util_cycle_counter_get()));
+
+}
+
+void UTIL_HOT_FUNC(hx711_multi_async_get_values)(
+    hx711_multi_t* const hxm,
+    int32_t* const values) {
+
+        const uint32_t* const frame = hx711_multi_async_get_frame(
+            hxm,
+            values);
+
+        if(frame != NULL) {
+            hx711_multi_pinvals_to_values(
+                frame,
+                values,
+                hxm->_chips_len);
+        }
+
+        hx711_multi_async_process_values(hxm, values);
+
+}
+
+void UTIL_HOT_FUNC(hx711_multi__process_values)(
+    hx711_multi_t* const hxm,
+    int32_t* const values) {
+
+#ifdef HX711_STATS
+        for(size_t i = 0; i < hxm->_chips_len; ++i) {
+            if(values[i] == HX711_MIN_VALUE || values[i] == HX711_MAX_VALUE) {
+                HX711_STATS_INC(hxm->_stats, saturations);
+            }
+        }
+#endif
+
+        if(hxm->_glitch != NULL) {
+            hx711_glitch_filter_multi(
+                hxm->_glitch,
+                values,
+                hxm->_chips_len);
+        }
+
+        if(hxm->_notch != NULL) {
+            hx711_notch_filter_multi(
+                hxm->_notch,
+                values,
+                hxm->_chips_len);
+        }
+
+}
+
+void hx711_multi_set_rate(
+    hx711_multi_t* const hxm,
+    const hx711_rate_t rate) {
+
+        assert(hx711_multi__is_state_machines_enabled(hxm));
+        assert(!hx711_multi__async_is_running(hxm));
+        assert(hxm->_rate_pin != HX711_NO_RATE_PIN);
+        assert(hx711_is_rate_valid(rate));
+
+        HX711_MUTEX_BLOCK(hxm->_mut, 
+
+            gpio_put(hxm->_rate_pin, rate == hx711_rate_80);
+            hxm->_rate = rate;
+            hxm->_auto_rate = rate;
+
+            HX711_TRACE_WRITE(
+                HX711_TRACE_EVENT_SET_RATE,
+                HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+                rate);
+
+            //the notch filters were tuned for the old rate, and
+            //all filters' history is from before the settling gap
+            for(size_t i = 0; i < hxm->_chips_len; ++i) {
+                if(hxm->_notch != NULL) {
+                    hx711_notch_init(
+                        &hxm->_notch[i],
+                        hx711_get_rate_sps(rate),
+                        hx711_notch_get_mains(&hxm->_notch[i]));
+                }
+                if(hxm->_glitch != NULL) {
+                    hx711_glitch_reset(&hxm->_glitch[i]);
+                }
+            }
+
+            //the reader pushes without blocking, so nothing is
+            //queued up; the next async read waits for a fresh
+            //conversion once settled
+            hx711_wait_settle(rate);
+
+        );
+
+}
+
+hx711_rate_t hx711_multi_get_rate(hx711_multi_t* const hxm) {
+    assert(hx711_multi__is_initd(hxm));
+    return hxm->_rate;
+}
+
+void hx711_multi_set_auto_rate(
+    hx711_multi_t* const hxm,
+    hx711_stability_t* const ss) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(!hx711_multi__async_is_running(hxm));
+        assert(ss == NULL || hxm->_rate_pin != HX711_NO_RATE_PIN);
+
+        HX711_MUTEX_BLOCK(hxm->_mut, 
+            hxm->_stability = ss;
+            hxm->_auto_rate = hxm->_rate;
+            for(uint i = 0; ss != NULL && i < hxm->_chips_len; ++i) {
+                hx711_stability_seed(&ss[i], hxm->_rate == hx711_rate_10);
+            }
+        );
+
+}
+
+void hx711_multi_update_auto_rate(
+    hx711_multi_t* const hxm,
+    const int32_t* const values) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(values != NULL);
+
+        if(hxm->_stability == NULL) {
+            return;
+        }
+
+        bool stable = true;
+
+        //every detector has to see every frame, so don't stop
+        //at the first unstable chip
+        for(uint i = 0; i < hxm->_chips_len; ++i) {
+            stable &= hx711_stability_update(&hxm->_stability[i], values[i]);
+        }
+
+        hxm->_auto_rate = stable ? hx711_rate_10 : hx711_rate_80;
+
+}
+
+bool hx711_multi_apply_auto_rate(hx711_multi_t* const hxm) {
+
+    assert(hx711_multi__is_state_machines_enabled(hxm));
+    assert(!hx711_multi__async_is_running(hxm));
+
+    if(hxm->_stability == NULL || hxm->_auto_rate == hxm->_rate) {
+        return false;
+    }
+
+    hx711_multi_set_rate(hxm, hxm->_auto_rate);
+
+    return true;
+
+}
+
+void hx711_multi_set_glitch_filters(
+    hx711_multi_t* const hxm,
+    hx711_glitch_t* const gs) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(!hx711_multi__async_is_running(hxm));
+
+        HX711_MUTEX_BLOCK(hxm->_mut, 
+            hxm->_glitch = gs;
+        );
+
+}
+
+void hx711_multi_set_frame_pool(
+    hx711_multi_t* const hxm,
+    hx711_multi_frame_t* const frames,
+    const size_t len) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(len <= HX711_MULTI_MAX_POOL_FRAMES);
+        assert((frames == NULL) == (len == 0));
+
+        HX711_MUTEX_BLOCK(hxm->_mut, 
+
+            hxm->_pool = frames;
+            hxm->_pool_len = len;
+
+            //all frames start out free
+            hxm->_pool_free = len == HX711_MULTI_MAX_POOL_FRAMES
+                ? UINT32_MAX
+                : (UINT32_C(1) << len) - 1;
+
+            hxm->_frame = hxm->_buffer;
+            hxm->_frame_taken = false;
+            hxm->_frame_released = false;
+
+        );
+
+}
+
+const uint32_t* hx711_multi_async_take_frame(
+    hx711_multi_t* const hxm) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(hx711_multi_async_done(hxm));
+        assert(!hxm->_frame_released);
+
+        if(hx711_multi__get_pool_index(hxm, hxm->_frame) < 0) {
+            return NULL;
+        }
+
+        hxm->_frame_taken = true;
+
+        return hxm->_frame;
+
+}
+
+void hx711_multi_release_frame(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame) {
+
+        assert(hx711_multi__is_initd(hxm));
+
+        const int idx = hx711_multi__get_pool_index(hxm, frame);
+
+        assert(idx >= 0);
+
+        UTIL_INTERRUPTS_OFF_BLOCK(
+
+            //if this is still the most recent frame, its values
+            //can no longer be got; the next async start frees it
+            //again, which is harmless
+            if(frame == hxm->_frame) {
+                hxm->_frame_taken = false;
+                hxm->_frame_released = true;
+            }
+
+            hxm->_pool_free |= 1u << idx;
+
+        );
+
 }
 
 void hx711_multi_power_up(
@@ -792,9 +1352,13 @@ void hx711_multi_power_up(
 
         HX711_MUTEX_BLOCK(hxm->_mut, 
 
-            gpio_put(
-                hxm->_clock_pin,
-                false);
+            //clock pin is muxed to the PIO, so drive it through
+            //the stopped reader SM rather than gpio_put
+            pio_sm_set_pins_with_mask(
+                hxm->_pio,
+                hxm->_reader_sm,
+                0,
+                1u << hxm->_clock_pin);
 
             pio_sm_init(
                 hxm->_pio,
@@ -823,6 +1387,11 @@ void hx711_multi_power_up(
                 (1 << hxm->_awaiter_sm) | (1 << hxm->_reader_sm),
                 true);
 
+            HX711_TRACE_WRITE(
+                HX711_TRACE_EVENT_POWER_UP,
+                HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+                gain);
+
         );
 
 }
@@ -833,8 +1402,10 @@ void hx711_multi_power_down(hx711_multi_t* const hxm) {
 
     HX711_MUTEX_BLOCK(hxm->_mut,
 
+        //the mutex is already held here, so only disarm;
+        //finishing would release it a second time
         UTIL_INTERRUPTS_OFF_BLOCK(
-            hx711_multi__async_finish(hxm);
+            hx711_multi__async_disarm(hxm);
         );
 
         pio_set_sm_mask_enabled(
@@ -842,9 +1413,18 @@ void hx711_multi_power_down(hx711_multi_t* const hxm) {
             (1 << hxm->_awaiter_sm) | (1 << hxm->_reader_sm),
             false);
 
-        gpio_put(
-            hxm->_clock_pin,
-            true);
+        //clock pin is muxed to the PIO, so drive it through
+        //the stopped reader SM rather than gpio_put
+        pio_sm_set_pins_with_mask(
+            hxm->_pio,
+            hxm->_reader_sm,
+            1u << hxm->_clock_pin,
+            1u << hxm->_clock_pin);
+
+        HX711_TRACE_WRITE(
+            HX711_TRACE_EVENT_POWER_DOWN,
+            HX711_TRACE_INSTANCE(hxm->_pio, hxm->_reader_sm),
+            0);
 
     );
 
@@ -878,3 +1458,261 @@ bool hx711_multi_is_syncd(
         return state == 0 || state == allReady;
 
 }
+
+void hx711_multi_set_notch_filters(
+    hx711_multi_t* const hxm,
+    hx711_notch_t* const ns) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(!hx711_multi__async_is_running(hxm));
+
+        HX711_MUTEX_BLOCK(hxm->_mut, 
+            hxm->_notch = ns;
+        );
+
+}
+
+void hx711_multi_set_alarms(
+    hx711_multi_t* const hxm,
+    hx711_alarm_t* const as) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(!hx711_multi__async_is_running(hxm));
+
+        HX711_MUTEX_BLOCK(hxm->_mut, 
+            hxm->_alarms = as;
+        );
+
+}
+
+bool UTIL_HOT_FUNC(hx711_multi__on_sample_frame)(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const decoded,
+    void* const ctx) {
+
+        (void)frame;
+
+        hx711_multi__samples_t* const smp = (hx711_multi__samples_t*)ctx;
+        const uint i = smp->count;
+        int32_t values[HX711_MULTI_MAX_CHIPS];
+
+        memcpy(values, decoded, hxm->_chips_len * sizeof(int32_t));
+        hx711_multi__process_values(hxm, values);
+        hx711_multi_update_auto_rate(hxm, values);
+
+        for(uint j = 0; j < hxm->_chips_len; ++j) {
+            if(smp->sums != NULL) {
+                smp->sums[j] += values[j];
+            }
+            else {
+                util_sorted_insert_int32(smp->sorted[j], i, values[j]);
+            }
+        }
+
+        smp->count = i + 1;
+
+        return smp->count < smp->n;
+
+}
+
+/**
+ * @brief Read smp->n frames into smp in one continuous read,
+ * so the mutex is taken once and each conversion is armed from
+ * the DMA IRQ handler as soon as the previous frame lands.
+ * 
+ * @param hxm 
+ * @param smp 
+ */
+static void hx711_multi__get_samples(
+    hx711_multi_t* const hxm,
+    hx711_multi__samples_t* const smp) {
+
+#ifdef HX711_STATS
+        const uint32_t spinStart = time_us_32();
+#endif
+
+        hx711_multi_async_start_continuous(
+            hxm,
+            hx711_multi__on_sample_frame,
+            smp);
+
+        while(smp->count < smp->n) {
+            tight_loop_contents();
+        }
+
+        HX711_STATS_ADD(
+            hxm->_stats,
+            spin_us,
+            time_us_32() - spinStart);
+
+}
+
+void hx711_multi_get_values_avg(
+    hx711_multi_t* const hxm,
+    const uint n,
+    int32_t* const values) {
+
+        assert(hx711_multi__is_state_machines_enabled(hxm));
+        assert(n > 0);
+        assert(values != NULL);
+        assert(!hx711_multi__async_is_running(hxm));
+
+        int64_t sums[HX711_MULTI_MAX_CHIPS] = { 0 };
+
+        hx711_multi__samples_t smp = {
+            .n = n,
+            .count = 0,
+            .sums = sums,
+            .sorted = NULL
+        };
+
+        hx711_multi__get_samples(hxm, &smp);
+
+        for(uint i = 0; i < hxm->_chips_len; ++i) {
+            values[i] = (int32_t)(sums[i] / (int64_t)n);
+        }
+
+        hx711_multi_apply_auto_rate(hxm);
+
+}
+
+void hx711_multi_get_values_median(
+    hx711_multi_t* const hxm,
+    const uint n,
+    int32_t* const values) {
+
+        assert(hx711_multi__is_state_machines_enabled(hxm));
+        assert(n > 0);
+        assert(n <= HX711_MEDIAN_MAX_SAMPLES);
+        assert(values != NULL);
+        assert(!hx711_multi__async_is_running(hxm));
+
+        int32_t sorted[HX711_MULTI_MAX_CHIPS][HX711_MEDIAN_MAX_SAMPLES];
+
+        hx711_multi__samples_t smp = {
+            .n = n,
+            .count = 0,
+            .sums = NULL,
+            .sorted = sorted
+        };
+
+        hx711_multi__get_samples(hxm, &smp);
+
+        for(uint i = 0; i < hxm->_chips_len; ++i) {
+            values[i] = util_sorted_median_int32(sorted[i], n);
+        }
+
+        hx711_multi_apply_auto_rate(hxm);
+
+}
+
+void hx711_multi_tare(
+    hx711_multi_t* const hxm,
+    const uint samples,
+    hx711_calib_t* const calibs) {
+
+        assert(hx711_multi__is_state_machines_enabled(hxm));
+        assert(samples > 0);
+        assert(calibs != NULL);
+
+        int32_t values[HX711_MULTI_MAX_CHIPS];
+
+        hx711_multi_get_values_avg(hxm, samples, values);
+
+        for(uint i = 0; i < hxm->_chips_len; ++i) {
+            calibs[i].offset = values[i];
+        }
+
+}
+
+bool hx711_multi_calibrate(
+    hx711_multi_t* const hxm,
+    const uint samples,
+    const uint chip,
+    const float known_mass,
+    hx711_calib_t* const calibs) {
+
+        assert(hx711_multi__is_state_machines_enabled(hxm));
+        assert(samples > 0);
+        assert(chip < hxm->_chips_len);
+        assert(known_mass > 0.0f);
+        assert(calibs != NULL);
+
+        int32_t values[HX711_MULTI_MAX_CHIPS];
+
+        hx711_multi_get_values_avg(hxm, samples, values);
+
+        const int32_t diff = values[chip] - calibs[chip].offset;
+
+        if(diff == 0) {
+            return false;
+        }
+
+        calibs[chip].scale = (float)diff / known_mass;
+
+        return true;
+
+}
+
+#ifdef HX711_STATS
+void hx711_multi_get_stats(
+    hx711_multi_t* const hxm,
+    hx711_stats_t* const stats) {
+
+        assert(hx711_multi__is_initd(hxm));
+        assert(stats != NULL);
+
+        //the IRQ handlers also write to the counters
+        UTIL_INTERRUPTS_OFF_BLOCK(
+            *stats = hxm->_stats;
+        );
+
+}
+
+void hx711_multi_reset_stats(hx711_multi_t* const hxm) {
+
+    assert(hx711_multi__is_initd(hxm));
+
+    UTIL_INTERRUPTS_OFF_BLOCK(
+        hxm->_stats = (hx711_stats_t){ 0 };
+    );
+
+}
+#endif
+
+#ifdef HX711_HIST
+bool hx711_multi_get_hists(
+    hx711_multi_t* const hxm,
+    hx711_hist_snapshot_t* const latency,
+    hx711_hist_snapshot_t* const interval) {
+
+        assert(hx711_multi__is_initd(hxm));
+
+        if(latency != NULL &&
+            !hx711_hist_snapshot(&hxm->_latency_hist, latency)) {
+                return false;
+        }
+
+        if(interval != NULL &&
+            !hx711_hist_snapshot(&hxm->_interval_hist, interval)) {
+                return false;
+        }
+
+        return true;
+
+}
+
+void hx711_multi_reset_hists(hx711_multi_t* const hxm) {
+
+    assert(hx711_multi__is_initd(hxm));
+
+    //the DMA IRQ handler is the only other writer
+    UTIL_INTERRUPTS_OFF_BLOCK(
+        hx711_hist_init(&hxm->_latency_hist);
+        hx711_hist_init(&hxm->_interval_hist);
+        hxm->_frame_time_valid = false;
+    );
+
+}
+#endif
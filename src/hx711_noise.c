@@ -0,0 +1,142 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_noise.h"
+
+//full scale range of a 24-bit value
+#define HX711_NOISE__FULL_SCALE         16777216.0f
+
+void hx711_noise_init(hx711_noise_t* const n) {
+    assert(n != NULL);
+    n->_ref = 0;
+    n->_count = 0;
+    n->_sum = 0;
+    n->_sum_sq = 0;
+    n->_min = INT32_MAX;
+    n->_max = INT32_MIN;
+    n->_overflow = false;
+}
+
+void hx711_noise_add(
+    hx711_noise_t* const n,
+    const int32_t val) {
+
+        assert(n != NULL);
+
+        if(n->_overflow || n->_count == UINT32_MAX) {
+            return;
+        }
+
+        //the first value is the reference the sums are taken
+        //relative to; it only needs to be near the mean to
+        //keep the sums small
+        if(n->_count == 0) {
+            n->_ref = val;
+        }
+
+        const int64_t d = (int64_t)val - n->_ref;
+        const uint64_t sq = (uint64_t)(d * d);
+
+        //with 24-bit values d * d is at most 2^48, so this can
+        //only trigger after at least 2^15 large deviations
+        if(sq > UINT64_MAX - n->_sum_sq) {
+            n->_overflow = true;
+            return;
+        }
+
+        ++n->_count;
+        n->_sum += d;
+        n->_sum_sq += sq;
+
+        if(val < n->_min) {
+            n->_min = val;
+        }
+
+        if(val > n->_max) {
+            n->_max = val;
+        }
+
+}
+
+void hx711_noise_add_multi(
+    hx711_noise_t* const ns,
+    const int32_t* const values,
+    const size_t len) {
+
+        assert(ns != NULL);
+        assert(values != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            hx711_noise_add(&ns[i], values[i]);
+        }
+
+}
+
+bool hx711_noise_get_report(
+    const hx711_noise_t* const n,
+    hx711_noise_report_t* const report) {
+
+        assert(n != NULL);
+        assert(report != NULL);
+
+        if(n->_count < 2) {
+            return false;
+        }
+
+        const double count = (double)n->_count;
+        const double mean = (double)n->_sum / count;
+
+        //sum of squared deviations from the mean; both terms
+        //are exact integers converted once
+        double ss = (double)n->_sum_sq - ((double)n->_sum * mean);
+
+        if(ss < 0.0) {
+            ss = 0.0;
+        }
+
+        report->count = n->_count;
+        report->min = n->_min;
+        report->max = n->_max;
+        report->mean = (float)(n->_ref + mean);
+        report->variance = (float)(ss / (count - 1.0));
+        report->rms = sqrtf(report->variance);
+        report->peak_to_peak = (uint32_t)(n->_max - n->_min);
+        report->overflow = n->_overflow;
+
+        //a noiseless run has infinite resolution; report the
+        //full 24 bits instead
+        report->effective_bits = report->rms > 0.0f
+            ? fminf(log2f(HX711_NOISE__FULL_SCALE / report->rms), 24.0f)
+            : 24.0f;
+
+        report->noise_free_bits = report->peak_to_peak > 0
+            ? fminf(log2f(HX711_NOISE__FULL_SCALE / (float)report->peak_to_peak), 24.0f)
+            : 24.0f;
+
+        return true;
+
+}
@@ -0,0 +1,202 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_notch.h"
+
+//M_PI is not part of standard C
+#define HX711_NOTCH__PI                 3.14159265358979f
+
+/**
+ * Coefficients for Q = 2: w = 2pi * alias / 80, alpha =
+ * sin(w) / 4, normalised by a0 = 1 + alpha.
+ * 50Hz -> 30Hz, 60Hz -> 20Hz.
+ */
+const hx711_notch_coeffs_t HX711_NOTCH_COEFFS_80[2] = {
+    [hx711_mains_50] = {
+        .b0 = 228110785,
+        .b1 = 322597366,
+        .b2 = 228110785,
+        .a1 = 322597366,
+        .a2 = 187786114
+    },
+    [hx711_mains_60] = {
+        .b0 = 214748365,
+        .b1 = 0,
+        .b2 = 214748365,
+        .a1 = 0,
+        .a2 = 161061274
+    }
+};
+
+void hx711_notch_init(
+    hx711_notch_t* const n,
+    const uint8_t sps,
+    const hx711_mains_t mains) {
+
+        assert(n != NULL);
+        assert(sps == 10 || sps == 80);
+        assert(mains == hx711_mains_50 || mains == hx711_mains_60);
+
+        n->_mains = mains;
+        n->_comb = sps == 10;
+
+        if(!n->_comb) {
+            n->_coeffs = HX711_NOTCH_COEFFS_80[mains];
+        }
+
+        hx711_notch_reset(n);
+
+}
+
+bool hx711_notch_init_custom(
+    hx711_notch_t* const n,
+    const float sps,
+    const float hum_hz,
+    const float q) {
+
+        assert(n != NULL);
+        assert(sps > 0.0f);
+        assert(hum_hz > 0.0f);
+        assert(q > 0.0f);
+
+        const float scale = (float)(UINT32_C(1) << HX711_NOTCH_COEFF_BITS);
+
+        n->_mains = hum_hz < 55.0f
+            ? hx711_mains_50
+            : hx711_mains_60;
+
+        //fold the hum frequency into [0, sps / 2]
+        float alias = fmodf(hum_hz, sps);
+
+        if(alias > sps / 2.0f) {
+            alias = sps - alias;
+        }
+
+        //within 2% of DC or Nyquist a notch would also remove
+        //the signal (or nothing at all)
+        n->_comb = alias < sps * 0.02f || alias > sps * 0.48f;
+
+        if(!n->_comb) {
+
+            const float w = 2.0f * HX711_NOTCH__PI * alias / sps;
+            const float alpha = sinf(w) / (2.0f * q);
+            const float a0 = 1.0f + alpha;
+            const float c = -2.0f * cosf(w) / a0;
+
+            n->_coeffs.b0 = (int32_t)lroundf(scale / a0);
+            n->_coeffs.b1 = (int32_t)lroundf(scale * c);
+            n->_coeffs.b2 = n->_coeffs.b0;
+            n->_coeffs.a1 = n->_coeffs.b1;
+            n->_coeffs.a2 = (int32_t)lroundf(scale * (1.0f - alpha) / a0);
+
+        }
+
+        hx711_notch_reset(n);
+
+        return !n->_comb;
+
+}
+
+hx711_mains_t hx711_notch_get_mains(const hx711_notch_t* const n) {
+    assert(n != NULL);
+    return n->_mains;
+}
+
+void hx711_notch_reset(hx711_notch_t* const n) {
+    assert(n != NULL);
+    n->_primed = false;
+}
+
+int32_t hx711_notch_filter(
+    hx711_notch_t* const n,
+    const int32_t val) {
+
+        assert(n != NULL);
+
+        //start from steady state at the first value so there
+        //is no step response from zero (both filters have a
+        //DC gain of 1)
+        if(!n->_primed) {
+
+            n->_primed = true;
+            n->_x1 = n->_x2 = n->_y1 = n->_y2 = val;
+
+            for(uint8_t i = 0; i < HX711_NOTCH_COMB_LEN; ++i) {
+                n->_comb_buf[i] = val;
+            }
+
+            n->_comb_sum = val * HX711_NOTCH_COMB_LEN;
+            n->_comb_idx = 0;
+
+        }
+
+        if(n->_comb) {
+
+            n->_comb_sum += val - n->_comb_buf[n->_comb_idx];
+            n->_comb_buf[n->_comb_idx] = val;
+            n->_comb_idx = (n->_comb_idx + 1) % HX711_NOTCH_COMB_LEN;
+
+            return n->_comb_sum / HX711_NOTCH_COMB_LEN;
+
+        }
+
+        const hx711_notch_coeffs_t* const c = &n->_coeffs;
+
+        //direct form I; 24-bit values and coefficients below 2^31
+        //keep every product and the sum within 64 bits
+        int64_t acc = INT64_C(1) << (HX711_NOTCH_COEFF_BITS - 1);
+
+        acc += (int64_t)c->b0 * val;
+        acc += (int64_t)c->b1 * n->_x1;
+        acc += (int64_t)c->b2 * n->_x2;
+        acc -= (int64_t)c->a1 * n->_y1;
+        acc -= (int64_t)c->a2 * n->_y2;
+
+        const int32_t y = (int32_t)(acc >> HX711_NOTCH_COEFF_BITS);
+
+        n->_x2 = n->_x1;
+        n->_x1 = val;
+        n->_y2 = n->_y1;
+        n->_y1 = y;
+
+        return y;
+
+}
+
+void hx711_notch_filter_multi(
+    hx711_notch_t* const ns,
+    int32_t* const values,
+    const size_t len) {
+
+        assert(ns != NULL);
+        assert(values != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            values[i] = hx711_notch_filter(&ns[i], values[i]);
+        }
+
+}
@@ -0,0 +1,353 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "../include/hx711.h"
+#include "../include/hx711_multi.h"
+#include "../include/hx711_multi_decode.h"
+#include "../include/hx711_platform.h"
+#include "../include/util.h"
+
+typedef struct {
+    const hx711_platform_t* p;
+    hx711_platform_result_t* result;
+} hx711_platform__read_ctx_t;
+
+void hx711_platform_init(
+    hx711_platform_t* const p,
+    const hx711_platform_config_t* const config) {
+
+        assert(p != NULL);
+        assert(config != NULL);
+        assert(config->positions != NULL);
+        assert(config->len > 0);
+        assert(config->len <= HX711_PLATFORM_MAX_CELLS);
+        assert(config->cog_min_total > 0);
+
+        p->_len = config->len;
+        p->_cog_min_total = config->cog_min_total;
+        p->_scale = 1.0f;
+
+        for(size_t i = 0; i < p->_len; ++i) {
+            p->_pos[i] = config->positions[i];
+            p->_offset[i] = 0;
+            p->_trim[i] = HX711_PLATFORM_TRIM_ONE;
+        }
+
+}
+
+void hx711_platform_tare(
+    hx711_platform_t* const p,
+    const int32_t* const values) {
+
+        assert(p != NULL);
+        assert(values != NULL);
+
+        for(size_t i = 0; i < p->_len; ++i) {
+            p->_offset[i] = values[i];
+        }
+
+}
+
+void hx711_platform_set_trims(
+    hx711_platform_t* const p,
+    const int32_t* const trims,
+    const float scale) {
+
+        assert(p != NULL);
+        assert(trims != NULL);
+        assert(scale != 0.0f);
+
+        for(size_t i = 0; i < p->_len; ++i) {
+            assert(trims[i] > 0);
+            p->_trim[i] = trims[i];
+        }
+
+        p->_scale = scale;
+
+}
+
+void hx711_platform_get_trims(
+    const hx711_platform_t* const p,
+    int32_t* const trims,
+    float* const scale) {
+
+        assert(p != NULL);
+        assert(trims != NULL);
+
+        for(size_t i = 0; i < p->_len; ++i) {
+            trims[i] = p->_trim[i];
+        }
+
+        if(scale != NULL) {
+            *scale = p->_scale;
+        }
+
+}
+
+bool hx711_platform_calibrate(
+    hx711_platform_t* const p,
+    const int32_t* const values,
+    const float* const masses,
+    const size_t loads_len) {
+
+        assert(p != NULL);
+        assert(values != NULL);
+        assert(masses != NULL);
+
+        const size_t n = p->_len;
+
+        if(loads_len < n) {
+            return false;
+        }
+
+        //find the mass per count g of each cell minimising
+        //sum over loads of (sum_i a_i * g_i - mass)^2, where
+        //a_i is the tared value, by solving the normal
+        //equations (A'A)g = A'm with Gaussian elimination.
+        //m is the augmented n x (n + 1) matrix [A'A | A'm]
+        double m[HX711_PLATFORM_MAX_CELLS][HX711_PLATFORM_MAX_CELLS + 1] = { 0 };
+
+        for(size_t k = 0; k < loads_len; ++k) {
+
+            const int32_t* const row = &values[k * n];
+
+            for(size_t i = 0; i < n; ++i) {
+
+                const double ai = (double)row[i] - p->_offset[i];
+
+                for(size_t j = 0; j < n; ++j) {
+                    m[i][j] += ai * ((double)row[j] - p->_offset[j]);
+                }
+
+                m[i][n] += ai * masses[k];
+
+            }
+
+        }
+
+        //for judging singularity relative to the size of the
+        //counts
+        double diag = 0;
+        for(size_t i = 0; i < n; ++i) {
+            diag = fmax(diag, m[i][i]);
+        }
+
+        for(size_t col = 0; col < n; ++col) {
+
+            //partial pivoting
+            size_t pivot = col;
+            for(size_t r = col + 1; r < n; ++r) {
+                if(fabs(m[r][col]) > fabs(m[pivot][col])) {
+                    pivot = r;
+                }
+            }
+
+            if(fabs(m[pivot][col]) <= 1e-9 * diag) {
+                return false;
+            }
+
+            if(pivot != col) {
+                for(size_t c = col; c <= n; ++c) {
+                    const double t = m[col][c];
+                    m[col][c] = m[pivot][c];
+                    m[pivot][c] = t;
+                }
+            }
+
+            for(size_t r = col + 1; r < n; ++r) {
+                const double f = m[r][col] / m[col][col];
+                for(size_t c = col; c <= n; ++c) {
+                    m[r][c] -= f * m[col][c];
+                }
+            }
+
+        }
+
+        double g[HX711_PLATFORM_MAX_CELLS];
+        double mean = 0;
+
+        for(size_t i = n; i-- > 0;) {
+
+            double acc = m[i][n];
+
+            for(size_t c = i + 1; c < n; ++c) {
+                acc -= m[i][c] * g[c];
+            }
+
+            g[i] = acc / m[i][i];
+
+            //cells may all be wired to read negative under load,
+            //but one which reads the other way from the rest, or
+            //not at all, is wired backwards or broken and no trim
+            //can fix that
+            if(!(g[i] * g[n - 1] > 0)) {
+                return false;
+            }
+
+            mean += g[i];
+
+        }
+
+        mean /= n;
+
+        //trims are relative to the mean so that they stay near
+        //HX711_PLATFORM_TRIM_ONE, and the mean becomes the scale
+        for(size_t i = 0; i < n; ++i) {
+            const double t = g[i] / mean * HX711_PLATFORM_TRIM_ONE;
+            if(t >= INT32_MAX) {
+                return false;
+            }
+            p->_trim[i] = (int32_t)lround(t);
+        }
+
+        p->_scale = (float)(1.0 / mean);
+
+        return true;
+
+}
+
+void UTIL_HOT_FUNC(hx711_platform_process_values)(
+    const hx711_platform_t* const p,
+    const int32_t* const values,
+    hx711_platform_result_t* const result) {
+
+        assert(p != NULL);
+        assert(values != NULL);
+        assert(result != NULL);
+
+        int64_t total = 0;
+        int64_t sx = 0;
+        int64_t sy = 0;
+
+        for(size_t i = 0; i < p->_len; ++i) {
+
+            const int64_t w = ((int64_t)(values[i] - p->_offset[i]) *
+                p->_trim[i]) >> HX711_PLATFORM_TRIM_Q;
+
+            total += w;
+            sx += w * p->_pos[i].x;
+            sy += w * p->_pos[i].y;
+
+        }
+
+        hx711_platform__finish(p, total, sx, sy, result);
+
+}
+
+void UTIL_HOT_FUNC(hx711_platform_process_frame)(
+    const hx711_platform_t* const p,
+    const uint32_t* const pinvals,
+    hx711_platform_result_t* const result) {
+
+        assert(p != NULL);
+        assert(pinvals != NULL);
+        assert(result != NULL);
+
+        int32_t values[HX711_PLATFORM_MAX_CELLS];
+
+        hx711_multi__pinvals_to_values_inline(pinvals, values, p->_len);
+        hx711_platform_process_values(p, values, result);
+
+}
+
+void hx711_platform_read(
+    const hx711_platform_t* const p,
+    hx711_multi_t* const hxm,
+    hx711_platform_result_t* const result) {
+
+        assert(p != NULL);
+        assert(hxm != NULL);
+        assert(result != NULL);
+        assert(hxm->_chips_len == p->_len);
+
+        hx711_platform__read_ctx_t ctx = {
+            .p = p,
+            .result = result
+        };
+
+        hx711_multi_async_start_continuous(
+            hxm,
+            hx711_platform__on_frame,
+            &ctx);
+
+        while(!hx711_multi_async_done(hxm)) {
+            tight_loop_contents();
+        }
+
+}
+
+float hx711_platform_get_mass(
+    const hx711_platform_t* const p,
+    const hx711_platform_result_t* const result) {
+
+        assert(p != NULL);
+        assert(result != NULL);
+
+        return (float)result->total / p->_scale;
+
+}
+
+void UTIL_HOT_FUNC(hx711_platform__finish)(
+    const hx711_platform_t* const p,
+    const int64_t total,
+    const int64_t sx,
+    const int64_t sy,
+    hx711_platform_result_t* const result) {
+
+        result->total = total;
+        result->cog_valid = (total < 0 ? -total : total) >= p->_cog_min_total;
+
+        if(result->cog_valid) {
+            result->x = (int32_t)(sx / total);
+            result->y = (int32_t)(sy / total);
+        }
+        else {
+            result->x = 0;
+            result->y = 0;
+        }
+
+}
+
+bool UTIL_HOT_FUNC(hx711_platform__on_frame)(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx) {
+
+        (void)hxm;
+        (void)frame;
+
+        hx711_platform__read_ctx_t* const rc =
+            (hx711_platform__read_ctx_t*)ctx;
+
+        hx711_platform_process_values(rc->p, values, rc->result);
+
+        return false;
+
+}
@@ -0,0 +1,196 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/hx711_replay.h"
+
+static_assert(sizeof(hx711_replay_header_t) == 16,
+    "hx711_replay_header_t is part of the file format and must not change size");
+
+bool hx711_replay_rec_init(
+    hx711_replay_rec_t* const rec,
+    const uint8_t kind,
+    const uint8_t chips_len,
+    hx711_replay_write_t write,
+    void* const ctx) {
+
+        assert(rec != NULL);
+        assert(kind == HX711_REPLAY_KIND_MULTI || kind == HX711_REPLAY_KIND_SINGLE);
+        assert(chips_len > 0);
+        assert(kind == HX711_REPLAY_KIND_MULTI || chips_len == 1);
+        assert(write != NULL);
+
+        rec->_write = write;
+        rec->_ctx = ctx;
+        rec->_kind = kind;
+        rec->_chips_len = chips_len;
+
+        const hx711_replay_header_t hdr = {
+            .magic = HX711_REPLAY_MAGIC,
+            .version = HX711_REPLAY_VERSION,
+            .kind = kind,
+            .chips_len = chips_len
+        };
+
+        return write(ctx, &hdr, sizeof(hdr));
+
+}
+
+bool hx711_replay_rec_frame(
+    hx711_replay_rec_t* const rec,
+    const uint32_t timestamp,
+    const uint32_t* const pinvals) {
+
+        assert(rec != NULL);
+        assert(rec->_kind == HX711_REPLAY_KIND_MULTI);
+        assert(pinvals != NULL);
+
+        //one write per record, so a writer which adds its own
+        //framing (eg. hx711_log_append) keeps records whole
+        uint32_t buf[1 + HX711_REPLAY_FRAME_WORDS];
+
+        buf[0] = timestamp;
+        memcpy(&buf[1], pinvals, HX711_REPLAY_FRAME_WORDS * sizeof(uint32_t));
+
+        return rec->_write(rec->_ctx, buf, sizeof(buf));
+
+}
+
+bool hx711_replay_rec_raw(
+    hx711_replay_rec_t* const rec,
+    const uint32_t timestamp,
+    const uint32_t raw) {
+
+        assert(rec != NULL);
+        assert(rec->_kind == HX711_REPLAY_KIND_SINGLE);
+
+        const uint32_t buf[2] = { timestamp, raw };
+
+        return rec->_write(rec->_ctx, buf, sizeof(buf));
+
+}
+
+bool hx711_replay_src_init(
+    hx711_replay_src_t* const src,
+    const void* const data,
+    const size_t len) {
+
+        assert(src != NULL);
+        assert(data != NULL);
+
+        hx711_replay_header_t hdr;
+
+        if(len < sizeof(hdr)) {
+            return false;
+        }
+
+        memcpy(&hdr, data, sizeof(hdr));
+
+        if(hdr.magic != HX711_REPLAY_MAGIC ||
+            hdr.version != HX711_REPLAY_VERSION ||
+            (hdr.kind != HX711_REPLAY_KIND_MULTI && hdr.kind != HX711_REPLAY_KIND_SINGLE) ||
+            hdr.chips_len == 0 ||
+            hdr.chips_len > 32) {
+                return false;
+        }
+
+        src->_data = (const uint8_t*)data;
+        src->_len = len;
+        src->_pos = sizeof(hdr);
+        src->_kind = hdr.kind;
+        src->_chips_len = hdr.chips_len;
+
+        return true;
+
+}
+
+uint8_t hx711_replay_src_get_kind(const hx711_replay_src_t* const src) {
+    assert(src != NULL);
+    return src->_kind;
+}
+
+uint8_t hx711_replay_src_get_chips_len(const hx711_replay_src_t* const src) {
+    assert(src != NULL);
+    return src->_chips_len;
+}
+
+void hx711_replay_src_rewind(hx711_replay_src_t* const src) {
+    assert(src != NULL);
+    src->_pos = sizeof(hx711_replay_header_t);
+}
+
+bool hx711_replay_src_next_frame(
+    hx711_replay_src_t* const src,
+    uint32_t* const timestamp,
+    uint32_t* const pinvals) {
+
+        assert(src != NULL);
+        assert(src->_kind == HX711_REPLAY_KIND_MULTI);
+        assert(timestamp != NULL);
+        assert(pinvals != NULL);
+
+        const size_t n = (1 + HX711_REPLAY_FRAME_WORDS) * sizeof(uint32_t);
+
+        //a partial record at the end (eg. recording was cut
+        //short) is ignored
+        if(src->_len - src->_pos < n) {
+            return false;
+        }
+
+        memcpy(timestamp, &src->_data[src->_pos], sizeof(uint32_t));
+        memcpy(
+            pinvals,
+            &src->_data[src->_pos + sizeof(uint32_t)],
+            HX711_REPLAY_FRAME_WORDS * sizeof(uint32_t));
+
+        src->_pos += n;
+
+        return true;
+
+}
+
+bool hx711_replay_src_next_raw(
+    hx711_replay_src_t* const src,
+    uint32_t* const timestamp,
+    uint32_t* const raw) {
+
+        assert(src != NULL);
+        assert(src->_kind == HX711_REPLAY_KIND_SINGLE);
+        assert(timestamp != NULL);
+        assert(raw != NULL);
+
+        if(src->_len - src->_pos < 2 * sizeof(uint32_t)) {
+            return false;
+        }
+
+        memcpy(timestamp, &src->_data[src->_pos], sizeof(uint32_t));
+        memcpy(raw, &src->_data[src->_pos + sizeof(uint32_t)], sizeof(uint32_t));
+
+        src->_pos += 2 * sizeof(uint32_t);
+
+        return true;
+
+}
@@ -0,0 +1,111 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_stability.h"
+
+void hx711_stability_get_default_config(hx711_stability_config_t* const config) {
+    assert(config != NULL);
+    config->threshold = 1000;
+    config->stable_count = 8;
+}
+
+void hx711_stability_init(
+    hx711_stability_t* const s,
+    const hx711_stability_config_t* const config) {
+
+        assert(s != NULL);
+        assert(config != NULL);
+        assert(config->threshold >= 0);
+        assert(config->stable_count > 0);
+
+        s->_threshold = config->threshold;
+        s->_stable_count = config->stable_count;
+
+        hx711_stability_reset(s);
+
+}
+
+void hx711_stability_reset(hx711_stability_t* const s) {
+    assert(s != NULL);
+    s->_run = 0;
+    s->_started = false;
+    s->_min = 0;
+    s->_max = 0;
+}
+
+void hx711_stability_seed(
+    hx711_stability_t* const s,
+    const bool stable) {
+
+        assert(s != NULL);
+
+        hx711_stability_reset(s);
+
+        if(stable) {
+            s->_run = s->_stable_count;
+        }
+
+}
+
+bool hx711_stability_update(
+    hx711_stability_t* const s,
+    const int32_t val) {
+
+        assert(s != NULL);
+
+        if(!s->_started) {
+            s->_started = true;
+            s->_min = s->_max = val;
+        }
+        else {
+
+            const int32_t min = val < s->_min ? val : s->_min;
+            const int32_t max = val > s->_max ? val : s->_max;
+
+            if(max - min > s->_threshold) {
+                //moving; start again from this value
+                s->_run = 0;
+                s->_min = s->_max = val;
+            }
+            else {
+                s->_min = min;
+                s->_max = max;
+            }
+
+        }
+
+        if(s->_run < s->_stable_count) {
+            ++s->_run;
+        }
+
+        return hx711_stability_is_stable(s);
+
+}
+
+bool hx711_stability_is_stable(const hx711_stability_t* const s) {
+    assert(s != NULL);
+    return s->_run >= s->_stable_count;
+}
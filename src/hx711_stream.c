@@ -0,0 +1,304 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_crc.h"
+#include "../include/hx711_stream.h"
+
+static void hx711_stream__put_u32(
+    uint8_t* const p,
+    const uint32_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+        p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t hx711_stream__get_u32(const uint8_t* const p) {
+    return (uint32_t)p[0] |
+        ((uint32_t)p[1] << 8) |
+        ((uint32_t)p[2] << 16) |
+        ((uint32_t)p[3] << 24);
+}
+
+size_t hx711_stream_cobs_encode(
+    const uint8_t* const in,
+    const size_t len,
+    uint8_t* const out) {
+
+        assert(in != NULL || len == 0);
+        assert(out != NULL);
+
+        //out[code] holds the distance to the next zero, filled
+        //in once that is known
+        size_t code = 0;
+        size_t o = 1;
+        uint8_t dist = 1;
+
+        for(size_t i = 0; i < len; ++i) {
+
+            if(in[i] != 0) {
+                out[o++] = in[i];
+                ++dist;
+            }
+
+            if(in[i] == 0 || dist == 0xff) {
+                out[code] = dist;
+                code = o++;
+                dist = 1;
+            }
+
+        }
+
+        out[code] = dist;
+
+        return o;
+
+}
+
+bool hx711_stream_cobs_decode(
+    const uint8_t* const in,
+    const size_t len,
+    uint8_t* const out,
+    size_t* const out_len) {
+
+        assert(in != NULL || len == 0);
+        assert(out != NULL);
+        assert(out_len != NULL);
+
+        size_t i = 0;
+        size_t o = 0;
+
+        while(i < len) {
+
+            const uint8_t code = in[i++];
+
+            if(code == 0 || i + code - 1 > len) {
+                return false;
+            }
+
+            for(uint8_t j = 1; j < code; ++j) {
+                if(in[i] == 0) {
+                    return false;
+                }
+                out[o++] = in[i++];
+            }
+
+            //a full block of 254 bytes has no implied zero, nor
+            //does the last block
+            if(code != 0xff && i < len) {
+                out[o++] = 0;
+            }
+
+        }
+
+        *out_len = o;
+
+        return true;
+
+}
+
+size_t hx711_stream_encode(
+    const uint32_t seq,
+    const uint32_t timestamp,
+    const int32_t* const values,
+    const size_t len,
+    uint8_t* const out) {
+
+        assert(values != NULL);
+        assert(len > 0);
+        assert(len <= HX711_STREAM_MAX_CHIPS);
+        assert(out != NULL);
+
+        uint8_t frame[HX711_STREAM_FRAME_LEN(HX711_STREAM_MAX_CHIPS)];
+        uint8_t* p = frame;
+
+        *p++ = HX711_STREAM_VERSION;
+        *p++ = (uint8_t)len;
+        hx711_stream__put_u32(p, seq);
+        p += 4;
+        hx711_stream__put_u32(p, timestamp);
+        p += 4;
+
+        //values are 24 bit two's complement; the top byte is
+        //only sign extension
+        for(size_t i = 0; i < len; ++i) {
+            const uint32_t v = (uint32_t)values[i];
+            *p++ = (uint8_t)v;
+            *p++ = (uint8_t)(v >> 8);
+            *p++ = (uint8_t)(v >> 16);
+        }
+
+        hx711_stream__put_u32(p, hx711_crc32(frame, (size_t)(p - frame)));
+        p += 4;
+
+        size_t n = hx711_stream_cobs_encode(frame, (size_t)(p - frame), out);
+        out[n++] = 0;
+
+        return n;
+
+}
+
+bool hx711_stream_decode(
+    const uint8_t* const in,
+    const size_t in_len,
+    uint32_t* const seq,
+    uint32_t* const timestamp,
+    int32_t* const values,
+    size_t* const len) {
+
+        assert(in != NULL);
+        assert(seq != NULL);
+        assert(timestamp != NULL);
+        assert(values != NULL);
+        assert(len != NULL);
+
+        uint8_t frame[HX711_STREAM_ENCODED_MAX(HX711_STREAM_MAX_CHIPS)];
+        size_t frame_len;
+
+        if(in_len > sizeof(frame) ||
+            !hx711_stream_cobs_decode(in, in_len, frame, &frame_len)) {
+                return false;
+        }
+
+        if(frame_len < HX711_STREAM_FRAME_LEN(1) ||
+            frame[0] != HX711_STREAM_VERSION ||
+            frame[1] == 0 ||
+            frame[1] > HX711_STREAM_MAX_CHIPS ||
+            frame_len != (size_t)HX711_STREAM_FRAME_LEN(frame[1])) {
+                return false;
+        }
+
+        if(hx711_crc32(frame, frame_len - 4) !=
+            hx711_stream__get_u32(&frame[frame_len - 4])) {
+                return false;
+        }
+
+        *len = frame[1];
+        *seq = hx711_stream__get_u32(&frame[2]);
+        *timestamp = hx711_stream__get_u32(&frame[6]);
+
+        const uint8_t* p = &frame[10];
+
+        for(size_t i = 0; i < *len; ++i, p += 3) {
+            const uint32_t raw = (uint32_t)p[0] |
+                ((uint32_t)p[1] << 8) |
+                ((uint32_t)p[2] << 16);
+            values[i] = (int32_t)(raw << 8) >> 8;
+        }
+
+        return true;
+
+}
+
+void hx711_stream_init(
+    hx711_stream_t* const s,
+    hx711_stream_write_t write,
+    void* const ctx) {
+
+        assert(s != NULL);
+        assert(write != NULL);
+
+        s->_write = write;
+        s->_ctx = ctx;
+        s->_seq = 0;
+        s->_dropped = 0;
+        s->_busy = false;
+        s->_active = 0;
+        s->_fill = 0;
+
+}
+
+bool hx711_stream_write(
+    hx711_stream_t* const s,
+    const uint32_t timestamp,
+    const int32_t* const values,
+    const size_t len) {
+
+        assert(s != NULL);
+        assert(values != NULL);
+
+        if(HX711_STREAM_BUF_LEN - s->_fill < HX711_STREAM_ENCODED_MAX(len) &&
+            !hx711_stream_flush(s)) {
+                //both buffers are taken; keep the sequence number
+                //moving so the gap shows up at the reader
+                ++s->_seq;
+                ++s->_dropped;
+                return false;
+        }
+
+        s->_fill += hx711_stream_encode(
+            s->_seq++,
+            timestamp,
+            values,
+            len,
+            &s->_buf[s->_active][s->_fill]);
+
+        return true;
+
+}
+
+bool hx711_stream_flush(hx711_stream_t* const s) {
+
+    assert(s != NULL);
+
+    if(s->_fill == 0) {
+        return true;
+    }
+
+    //the other buffer is still being sent
+    if(s->_busy) {
+        return false;
+    }
+
+    const uint8_t* const buf = s->_buf[s->_active];
+    const size_t len = s->_fill;
+
+    s->_busy = true;
+    s->_active ^= 1;
+    s->_fill = 0;
+
+    if(s->_write(s->_ctx, buf, len)) {
+        s->_busy = false;
+    }
+
+    return true;
+
+}
+
+void hx711_stream_write_done(hx711_stream_t* const s) {
+    assert(s != NULL);
+    s->_busy = false;
+}
+
+bool hx711_stream_is_busy(const hx711_stream_t* const s) {
+    assert(s != NULL);
+    return s->_busy;
+}
+
+uint32_t hx711_stream_get_dropped(const hx711_stream_t* const s) {
+    assert(s != NULL);
+    return s->_dropped;
+}
@@ -0,0 +1,185 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#include "pico/stdio.h"
+#include "../include/hx711_stream.h"
+#include "../include/hx711_stream_pico.h"
+#include "../include/util.h"
+
+static hx711_stream_pico_uart_dma_t* hx711_stream_pico__uart_dmas[HX711_STREAM_PICO_UART_DMA_COUNT] = { NULL };
+static bool hx711_stream_pico__irq_added[UTIL_NUM_DMA_IRQS] = { false };
+
+bool hx711_stream_pico_stdio_write(
+    void* ctx,
+    const uint8_t* buf,
+    size_t len) {
+
+        (void)ctx;
+
+        //putchar_raw skips CRLF translation, which would
+        //corrupt any 0x0a byte
+        for(size_t i = 0; i < len; ++i) {
+            putchar_raw(buf[i]);
+        }
+
+        return true;
+
+}
+
+void hx711_stream_pico_uart_dma_init(
+    hx711_stream_pico_uart_dma_t* const d,
+    hx711_stream_t* const s,
+    uart_inst_t* const uart,
+    const uint dma_irq_index) {
+
+        assert(d != NULL);
+        assert(s != NULL);
+        assert(uart != NULL);
+        assert(util_dma_irq_index_is_valid(dma_irq_index));
+
+        d->_uart = uart;
+        d->_dma_irq_index = dma_irq_index;
+        d->_stream = s;
+
+        hx711_stream_init(s, hx711_stream_pico_uart_dma_write, d);
+
+        //panics rather than returning -1 if none are free
+        d->_dma_channel = (uint)dma_claim_unused_channel(true);
+
+        dma_channel_config cfg = dma_channel_get_default_config(
+            d->_dma_channel);
+
+        //one byte at a time from the buffer into the TX FIFO,
+        //paced by the UART
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+        channel_config_set_read_increment(&cfg, true);
+        channel_config_set_write_increment(&cfg, false);
+        channel_config_set_dreq(&cfg, uart_get_dreq(uart, true));
+
+        dma_channel_configure(
+            d->_dma_channel,
+            &cfg,
+            &uart_get_hw(uart)->dr,
+            NULL,
+            0,
+            false);
+
+        uint slot = 0;
+
+        UTIL_INTERRUPTS_OFF_BLOCK(
+            for(; slot < HX711_STREAM_PICO_UART_DMA_COUNT; ++slot) {
+                if(hx711_stream_pico__uart_dmas[slot] == NULL) {
+                    hx711_stream_pico__uart_dmas[slot] = d;
+                    break;
+                }
+            }
+        );
+
+        //a writer without a slot would never have its IRQ
+        //handled, so its first write would never finish
+        assert(slot < HX711_STREAM_PICO_UART_DMA_COUNT);
+
+        const uint irq_num = util_dma_get_irqn(dma_irq_index);
+
+        if(!hx711_stream_pico__irq_added[dma_irq_index]) {
+            irq_add_shared_handler(
+                irq_num,
+                hx711_stream_pico__uart_dma_irq_handler,
+                PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            hx711_stream_pico__irq_added[dma_irq_index] = true;
+        }
+
+        dma_irqn_set_channel_enabled(
+            dma_irq_index,
+            d->_dma_channel,
+            true);
+
+        irq_set_enabled(irq_num, true);
+
+}
+
+void hx711_stream_pico_uart_dma_close(hx711_stream_pico_uart_dma_t* const d) {
+
+    assert(d != NULL);
+
+    dma_channel_wait_for_finish_blocking(d->_dma_channel);
+
+    dma_irqn_set_channel_enabled(
+        d->_dma_irq_index,
+        d->_dma_channel,
+        false);
+
+    UTIL_INTERRUPTS_OFF_BLOCK(
+        for(uint i = 0; i < HX711_STREAM_PICO_UART_DMA_COUNT; ++i) {
+            if(hx711_stream_pico__uart_dmas[i] == d) {
+                hx711_stream_pico__uart_dmas[i] = NULL;
+            }
+        }
+    );
+
+    dma_channel_unclaim(d->_dma_channel);
+
+}
+
+bool hx711_stream_pico_uart_dma_write(
+    void* ctx,
+    const uint8_t* buf,
+    size_t len) {
+
+        hx711_stream_pico_uart_dma_t* const d =
+            (hx711_stream_pico_uart_dma_t*)ctx;
+
+        assert(d != NULL);
+        assert(!dma_channel_is_busy(d->_dma_channel));
+
+        dma_channel_transfer_from_buffer_now(
+            d->_dma_channel,
+            buf,
+            len);
+
+        return false;
+
+}
+
+void hx711_stream_pico__uart_dma_irq_handler(void) {
+
+    for(uint i = 0; i < HX711_STREAM_PICO_UART_DMA_COUNT; ++i) {
+
+        hx711_stream_pico_uart_dma_t* const d =
+            hx711_stream_pico__uart_dmas[i];
+
+        if(d != NULL && dma_irqn_get_channel_status(d->_dma_irq_index, d->_dma_channel)) {
+            dma_irqn_acknowledge_channel(d->_dma_irq_index, d->_dma_channel);
+            hx711_stream_write_done(d->_stream);
+        }
+
+    }
+
+}
@@ -0,0 +1,124 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "pico/platform.h"
+#include "pico/types.h"
+#include "../include/hx711_trace.h"
+#include "../include/util.h"
+
+static_assert(
+    (HX711_TRACE_LEN & (HX711_TRACE_LEN - 1)) == 0,
+    "HX711_TRACE_LEN must be a power of 2");
+
+static_assert(
+    sizeof(hx711_trace_record_t) == 8,
+    "hx711_trace_record_t layout must match the decoder");
+
+static hx711_trace_record_t hx711__trace_ring[HX711_TRACE_LEN];
+
+/**
+ * @brief Total number of records written since the last
+ * clear. The next record is written at
+ * hx711__trace_head % HX711_TRACE_LEN.
+ */
+static uint32_t hx711__trace_head = 0;
+
+static spin_lock_t* hx711__trace_lock = NULL;
+
+void hx711_trace_init(void) {
+
+    if(hx711__trace_lock == NULL) {
+        hx711__trace_lock = spin_lock_instance(
+            next_striped_spin_lock_num());
+    }
+
+    hx711_trace_clear();
+
+}
+
+void hx711_trace_clear(void) {
+
+    assert(hx711__trace_lock != NULL);
+
+    const uint32_t status = spin_lock_blocking(hx711__trace_lock);
+    hx711__trace_head = 0;
+    spin_unlock(hx711__trace_lock, status);
+
+}
+
+void UTIL_HOT_FUNC(hx711_trace_write)(
+    const hx711_trace_event_t event,
+    const uint8_t instance,
+    const uint16_t arg) {
+
+        if(hx711__trace_lock == NULL) {
+            return;
+        }
+
+        const uint32_t now = time_us_32();
+        const uint32_t status = spin_lock_blocking(hx711__trace_lock);
+
+        hx711_trace_record_t* const rec = &hx711__trace_ring[
+            hx711__trace_head & (HX711_TRACE_LEN - 1)];
+
+        rec->timestamp = now;
+        rec->event = (uint8_t)event;
+        rec->instance = instance;
+        rec->arg = arg;
+
+        ++hx711__trace_head;
+
+        spin_unlock(hx711__trace_lock, status);
+
+}
+
+size_t hx711_trace_dump(
+    hx711_trace_record_t* const records,
+    const size_t len) {
+
+        assert(records != NULL);
+        assert(hx711__trace_lock != NULL);
+
+        const uint32_t status = spin_lock_blocking(hx711__trace_lock);
+
+        const uint32_t head = hx711__trace_head;
+        const uint32_t avail = head < HX711_TRACE_LEN ? head : HX711_TRACE_LEN;
+        const size_t count = avail < len ? avail : len;
+
+        //skip the oldest records if not all of them fit
+        const uint32_t first = head - count;
+
+        for(size_t i = 0; i < count; ++i) {
+            records[i] = hx711__trace_ring[
+                (first + i) & (HX711_TRACE_LEN - 1)];
+        }
+
+        spin_unlock(hx711__trace_lock, status);
+
+        return count;
+
+}
@@ -29,8 +29,10 @@
 #include "hardware/pio.h"
 #include "hardware/pio_instructions.h"
 #include "hardware/regs/intctrl.h"
+#include "hardware/regs/m0plus.h"
 #include "hardware/regs/pio.h"
 #include "hardware/structs/dma.h"
+#include "hardware/structs/systick.h"
 #include "hardware/timer.h"
 #include "pico/platform.h"
 #include "pico/time.h"
@@ -118,7 +120,7 @@ void util_dma_set_exclusive_channel_irq_handler(
 
 }
 
-uint32_t util_dma_get_transfer_count(const uint channel) {
+uint32_t UTIL_HOT_FUNC(util_dma_get_transfer_count)(const uint channel) {
     check_dma_channel_param(channel);
     return (uint32_t)dma_hw->ch[channel].transfer_count;
 }
@@ -141,7 +143,7 @@ bool util_dma_channel_wait_for_finish_timeout(
 
 }
 
-uint util_dma_get_irqn(const uint irq_index) {
+uint UTIL_HOT_FUNC(util_dma_get_irqn)(const uint irq_index) {
 
     assert(util_dma_to_irq_map != NULL);
     assert(util_uint_in_range(
@@ -247,7 +249,7 @@ uint util_pion_get_irqn(
 
 }
 
-uint util_pio_get_irq_from_index(
+uint UTIL_HOT_FUNC(util_pio_get_irq_from_index)(
     PIO const pio,
     const uint idx) {
     
@@ -298,7 +300,7 @@ PIO const util_pio_get_pio_from_irq(const uint irq_num) {
 
 }
 
-uint util_pio_get_pis_from_pio_interrupt_num(
+uint UTIL_HOT_FUNC(util_pio_get_pis_from_pio_interrupt_num)(
     const uint pio_interrupt_num) {
 
         assert(util_routable_pio_interrupt_num_is_valid(
@@ -331,7 +333,7 @@ void util_pio_gpio_contiguous_init(
 
 }
 
-void util_pio_sm_clear_rx_fifo(
+void UTIL_HOT_FUNC(util_pio_sm_clear_rx_fifo)(
     PIO const pio,
     const uint sm) {
         check_pio_param(pio);
@@ -500,4 +502,94 @@ bool util_pio_sm_try_get(
 
 }
 
+bool util_pio_sm_rx_stalled(
+    PIO const pio,
+    const uint sm) {
+
+        check_pio_param(pio);
+        check_sm_param(sm);
+
+        const uint32_t mask = 1u << (PIO_FDEBUG_RXSTALL_LSB + sm);
+
+        if((pio->fdebug & mask) == 0) {
+            return false;
+        }
+
+        //flag is cleared by writing a 1 to it
+        pio->fdebug = mask;
+
+        return true;
+
+}
+
+void util_cycle_counter_init(void) {
+
+    if((systick_hw->csr & M0PLUS_SYST_CSR_ENABLE_BITS) != 0) {
+        return;
+    }
+
+    //count processor clock cycles over the full 24 bits
+    systick_hw->rvr = M0PLUS_SYST_RVR_BITS;
+    systick_hw->cvr = 0;
+    systick_hw->csr =
+        M0PLUS_SYST_CSR_CLKSOURCE_BITS |
+        M0PLUS_SYST_CSR_ENABLE_BITS;
+
+}
+
+uint32_t UTIL_HOT_FUNC(util_cycle_counter_get)(void) {
+    return systick_hw->cvr;
+}
+
+uint32_t UTIL_HOT_FUNC(util_cycle_counter_elapsed)(
+    const uint32_t start,
+    const uint32_t end) {
+
+        //SysTick counts down from the reload value
+        if(start >= end) {
+            return start - end;
+        }
+
+        return start + (systick_hw->rvr + 1) - end;
+
+}
+
+void util_sorted_insert_int32(
+    int32_t* const arr,
+    const size_t len,
+    const int32_t val) {
+
+        assert(arr != NULL);
+
+        size_t i = len;
+
+        //shift larger values up one place; for the small
+        //arrays this is used with, this is cheaper than a
+        //binary search followed by a move
+        while(i > 0 && arr[i - 1] > val) {
+            arr[i] = arr[i - 1];
+            --i;
+        }
+
+        arr[i] = val;
+
+}
+
+int32_t util_sorted_median_int32(
+    const int32_t* const arr,
+    const size_t len) {
+
+        assert(arr != NULL);
+        assert(len > 0);
+
+        const size_t mid = len / 2;
+
+        if(len % 2 != 0) {
+            return arr[mid];
+        }
+
+        return (int32_t)(((int64_t)arr[mid - 1] + arr[mid]) / 2);
+
+}
+
 #undef UTIL_DEF_IN_RANGE_FUNC
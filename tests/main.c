@@ -25,10 +25,15 @@
 #include "pico/stdio.h"
 #include "tusb.h"
 #include "../include/common.h"
+#include "../include/hx711_stream.h"
 //                 4294967296
 //#define DELAY_US    480000000
 #define DELAY_US    200000000
 
+// 1 to send frames with hx711_stream_t instead of printf; decode
+// them with tools/hx711_stream_decode.c
+#define STREAM_BINARY 0
+
 #define PRINT_ARR(arr, len) \
     do { \
         for(size_t i = 0; i < len; ++i) { \
@@ -165,6 +170,11 @@ int main(void) {
 
     //busy_wait_ms(3000);
 
+#if STREAM_BINARY
+    static hx711_stream_t stream;
+    hx711_stream_init(&stream, hx711_stream_pico_stdio_write, NULL);
+#endif
+
     hx711_multi_async_start(&hxm);
 
 
@@ -176,10 +186,25 @@ int main(void) {
             tight_loop_contents();
         }
         hx711_multi_async_get_values(&hxm, arr);
+#if STREAM_BINARY
+        hx711_stream_write(&stream, time_us_32(), arr, hxmcfg.chips_len);
+#else
         PRINT_ARR_MathLab(arr, hxmcfg.chips_len);
+#endif
         hx711_multi_async_start(&hxm);
     }
 
+#if STREAM_BINARY
+    //the last buffer may have to wait for the previous write
+    while(!hx711_stream_flush(&stream)) {
+        tight_loop_contents();
+    }
+
+    while(hx711_stream_is_busy(&stream)) {
+        tight_loop_contents();
+    }
+#endif
+
 
 
 
@@ -0,0 +1,316 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Measures the CPU time the library takes per delivered
+ * sample in each hx711_multi_t read mode, so the blocking and
+ * asynchronous APIs can be chosen between on data rather than
+ * guesswork. Build with HX711_STATS (the profile target in
+ * tests/CMakeLists.txt does) and open the USB serial port.
+ * 
+ * For each mode SAMPLES frames are read and the following are
+ * reported per sample, in microseconds:
+ * 
+ *  wall    time between samples (the conversion period)
+ *  lib     CPU time inside the library, from the caller's
+ *          side for the blocking calls and summed from its
+ *          parts for the others
+ *  spin    busy-waiting in the blocking calls (includes IRQ
+ *          handlers which ran meanwhile)
+ *  isr     PIO and DMA IRQ handlers
+ *  decode  hx711_multi_async_get_values
+ * 
+ * and cpu%, which is lib as a share of wall: the time the core
+ * could not spend on anything else.
+ * 
+ * It also builds on a PC against tools/hx711_shim.h, with a
+ * hx711_model_t on each data pin, to check every mode
+ * delivers its samples without a board:
+ *  cc -std=c11 -O2 -DHX711_STATS -Itools/shim -o profile \
+ *      tests/profile.c tools/hx711_shim.c tools/hx711_model.c \
+ *      src/common.c src/hx711_multi.c src/hx711.c \
+ *      src/hx711_alarm.c src/hx711_glitch.c src/hx711_notch.c \
+ *      src/hx711_stability.c src/util.c -lm
+ * 
+ * There, time is simulated and the library's code takes none,
+ * so wall and spin follow the models' conversions and isr and
+ * decode are 0. Only the board gives real CPU costs.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hardware/clocks.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "tusb.h"
+#include "../include/common.h"
+#include "../include/util.h"
+
+#if !PICO_ON_DEVICE
+    #include "../tools/hx711_model.h"
+    #include "../tools/hx711_shim.h"
+#endif
+
+#ifndef HX711_STATS
+    #error "profile.c needs HX711_STATS to be defined"
+#endif
+
+#define CLOCK_PIN       14
+#define DATA_PIN_BASE   2
+#define CHIPS           4
+
+#define SAMPLES     160
+#define TIMEOUT_US  250000
+
+//time the application does its own work between polls in the
+//async mode
+#define WORK_US     100
+
+typedef struct {
+    const char* name;
+    uint32_t samples;
+    uint64_t wall_us;
+    uint64_t lib_cycles;        //async and continuous only
+    uint64_t lib_us;            //blocking calls only
+    hx711_stats_t stats;
+} result_t;
+
+static volatile uint32_t continuous_count;
+
+static bool on_frame(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx) {
+
+        (void)hxm;
+        (void)frame;
+        (void)values;
+        (void)ctx;
+
+        return ++continuous_count < SAMPLES;
+
+}
+
+static void profile_get_values(
+    hx711_multi_t* const hxm,
+    result_t* const r) {
+
+        int32_t values[HX711_MULTI_MAX_CHIPS];
+
+        hx711_multi_reset_stats(hxm);
+        const uint64_t start = time_us_64();
+
+        for(uint32_t i = 0; i < SAMPLES; ++i) {
+            const uint64_t t = time_us_64();
+            hx711_multi_get_values(hxm, values);
+            r->lib_us += time_us_64() - t;
+        }
+
+        r->wall_us = time_us_64() - start;
+        r->samples = SAMPLES;
+        hx711_multi_get_stats(hxm, &r->stats);
+
+}
+
+static void profile_get_values_timeout(
+    hx711_multi_t* const hxm,
+    result_t* const r) {
+
+        int32_t values[HX711_MULTI_MAX_CHIPS];
+
+        hx711_multi_reset_stats(hxm);
+        const uint64_t start = time_us_64();
+
+        for(uint32_t i = 0; i < SAMPLES; ++i) {
+            const uint64_t t = time_us_64();
+            r->samples += hx711_multi_get_values_timeout(hxm, values, TIMEOUT_US);
+            r->lib_us += time_us_64() - t;
+        }
+
+        r->wall_us = time_us_64() - start;
+        hx711_multi_get_stats(hxm, &r->stats);
+
+}
+
+static void profile_async(
+    hx711_multi_t* const hxm,
+    result_t* const r) {
+
+        int32_t values[HX711_MULTI_MAX_CHIPS];
+        uint32_t c;
+
+        hx711_multi_reset_stats(hxm);
+        const uint64_t start = time_us_64();
+
+        for(uint32_t i = 0; i < SAMPLES; ++i) {
+
+            c = util_cycle_counter_get();
+            hx711_multi_async_start(hxm);
+            r->lib_cycles += util_cycle_counter_elapsed(c, util_cycle_counter_get());
+
+            for(;;) {
+                c = util_cycle_counter_get();
+                const bool done = hx711_multi_async_done(hxm);
+                r->lib_cycles += util_cycle_counter_elapsed(c, util_cycle_counter_get());
+                if(done) {
+                    break;
+                }
+                //the application's own work
+                busy_wait_us_32(WORK_US);
+            }
+
+            //counted in decode_cycles
+            hx711_multi_async_get_values(hxm, values);
+
+        }
+
+        r->wall_us = time_us_64() - start;
+        r->samples = SAMPLES;
+        hx711_multi_get_stats(hxm, &r->stats);
+        r->lib_cycles += r->stats.isr_cycles + r->stats.decode_cycles;
+
+}
+
+static void profile_continuous(
+    hx711_multi_t* const hxm,
+    result_t* const r) {
+
+        continuous_count = 0;
+
+        hx711_multi_reset_stats(hxm);
+        const uint64_t start = time_us_64();
+
+        const uint32_t c = util_cycle_counter_get();
+        hx711_multi_async_start_continuous(hxm, on_frame, NULL);
+        r->lib_cycles += util_cycle_counter_elapsed(c, util_cycle_counter_get());
+
+        //each frame is decoded in the IRQ handler, so there is
+        //nothing to do here but wait
+        while(!hx711_multi_async_done(hxm)) {
+            busy_wait_us_32(WORK_US);
+        }
+
+        r->wall_us = time_us_64() - start;
+        r->samples = continuous_count;
+        hx711_multi_get_stats(hxm, &r->stats);
+        r->lib_cycles += r->stats.isr_cycles;
+
+}
+
+static void print_result(
+    const result_t* const r,
+    const double cycles_per_us) {
+
+        if(r->samples == 0) {
+            printf("%-22s no samples\n", r->name);
+            return;
+        }
+
+        const double n = r->samples;
+        const double lib = r->lib_us > 0
+            ? r->lib_us / n
+            : r->lib_cycles / cycles_per_us / n;
+        const double wall = r->wall_us / n;
+
+        printf("%-22s %7lu %9.1f %9.1f %9.1f %9.2f %9.2f %6.1f\n",
+            r->name,
+            (unsigned long)r->samples,
+            wall,
+            lib,
+            r->stats.spin_us / n,
+            r->stats.isr_cycles / cycles_per_us / n,
+            r->stats.decode_cycles / cycles_per_us / n,
+            100.0 * lib / wall);
+
+}
+
+int main(void) {
+
+    stdio_init_all();
+
+    while (!tud_cdc_connected()) {
+        sleep_ms(1);
+    }
+
+#if !PICO_ON_DEVICE
+    static hx711_model_t models[CHIPS];
+    hx711_model_config_t mcfg;
+
+    hx711_model_get_default_config(&mcfg, 80);
+
+    for(uint i = 0; i < CHIPS; ++i) {
+        mcfg.seed = i + 1;
+        hx711_model_init(&models[i], &mcfg);
+        hx711_shim_attach(&models[i], CLOCK_PIN, DATA_PIN_BASE + i);
+    }
+#endif
+
+    hx711_multi_config_t hxmcfg;
+    hx711_multi_get_default_config(&hxmcfg);
+    hxmcfg.clock_pin = CLOCK_PIN;
+    hxmcfg.data_pin_base = DATA_PIN_BASE;
+    hxmcfg.chips_len = CHIPS;
+    hxmcfg.pio_irq_index = 1;
+    hxmcfg.dma_irq_index = 1;
+
+    hx711_multi_t hxm;
+
+    hx711_multi_init(&hxm, &hxmcfg);
+    hx711_multi_power_up(&hxm, hx711_gain_128);
+    hx711_wait_settle(hx711_rate_80);
+
+    result_t results[] = {
+        { .name = "get_values" },
+        { .name = "get_values_timeout" },
+        { .name = "async" },
+        { .name = "async_continuous" }
+    };
+
+    profile_get_values(&hxm, &results[0]);
+    profile_get_values_timeout(&hxm, &results[1]);
+    profile_async(&hxm, &results[2]);
+    profile_continuous(&hxm, &results[3]);
+
+    hx711_multi_close(&hxm);
+
+    const double cycles_per_us = clock_get_hz(clk_sys) / 1e6;
+
+    printf("%zu chips, %u samples per mode, times in us per sample\n",
+        hxmcfg.chips_len,
+        SAMPLES);
+    printf("%-22s %7s %9s %9s %9s %9s %9s %6s\n",
+        "mode", "samples", "wall", "lib", "spin", "isr", "decode", "cpu%");
+
+    for(size_t i = 0; i < count_of(results); ++i) {
+        print_result(&results[i], cycles_per_us);
+    }
+
+#if PICO_ON_DEVICE
+    //keep the USB serial port up so the results can be read
+    while(1);
+#endif
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,180 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side tool for calibration stores, backed by a file
+ * which stands in for the two flash sectors. It can be used
+ * to inspect an image read back from a device (eg. with
+ * picotool save -r) or to exercise the store without
+ * hardware.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_calib_tool tools/hx711_calib_tool.c \
+ *      src/hx711_calib.c src/hx711_crc.c
+ * 
+ * Usage:
+ *  hx711_calib_tool [-s sector_size] [-o offset] file list
+ *  hx711_calib_tool [-s sector_size] [-o offset] file get chip
+ *  hx711_calib_tool [-s sector_size] [-o offset] file set chip offset scale [timestamp]
+ *  hx711_calib_tool [-s sector_size] [-o offset] file stress count
+ * 
+ * The file is created (erased) if it does not exist. stress
+ * saves count records round-robin across chips, checking each
+ * can be loaded back, to exercise sector switching.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/hx711_calib.h"
+#include "../include/hx711_flash.h"
+#include "hx711_file_flash.h"
+
+static void usage(const char* const name) {
+    fprintf(stderr,
+        "usage: %s [-s sector_size] [-o offset] file list|get|set|stress ...\n",
+        name);
+}
+
+static void print_calib(
+    const unsigned chip,
+    const hx711_calib_t* const calib) {
+        printf("%2u offset=%" PRId32 " scale=%g timestamp=%" PRIu32 "\n",
+            chip,
+            calib->offset,
+            (double)calib->scale,
+            calib->timestamp);
+}
+
+int main(int argc, char** argv) {
+
+    file_flash_t ff = { .fp = NULL, .sector_size = 4096 };
+    hx711_flash_t flash;
+    hx711_calib_store_t store;
+    hx711_calib_t calib;
+    size_t offset = 0;
+    int opt;
+    int ret = EXIT_SUCCESS;
+
+    while((opt = getopt(argc, argv, "s:o:")) != -1) {
+        switch(opt) {
+            case 's':
+                ff.sector_size = strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                offset = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if(argc - optind < 2) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* const path = argv[optind];
+    const char* const cmd = argv[optind + 1];
+    char** const args = &argv[optind + 2];
+    const int nargs = argc - optind - 2;
+
+    file_flash_init(&ff, &flash);
+
+    if((ff.fp = fopen(path, "r+b")) == NULL) {
+        if((ff.fp = fopen(path, "w+b")) == NULL ||
+            !file_erase(&ff, offset) ||
+            !file_erase(&ff, offset + ff.sector_size)) {
+                perror(path);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if(!hx711_calib_store_init(&store, &flash, offset)) {
+        fprintf(stderr, "%s: unable to read store\n", path);
+        fclose(ff.fp);
+        return EXIT_FAILURE;
+    }
+
+    if(strcmp(cmd, "list") == 0) {
+        for(unsigned chip = 0; chip < HX711_CALIB_MAX_CHIPS; ++chip) {
+            if(hx711_calib_store_load(&store, (uint8_t)chip, &calib)) {
+                print_calib(chip, &calib);
+            }
+        }
+    }
+    else if(strcmp(cmd, "get") == 0 && nargs == 1) {
+        const unsigned chip = (unsigned)strtoul(args[0], NULL, 0);
+        if(chip >= HX711_CALIB_MAX_CHIPS ||
+            !hx711_calib_store_load(&store, (uint8_t)chip, &calib)) {
+                fprintf(stderr, "no calibration for chip %s\n", args[0]);
+                ret = EXIT_FAILURE;
+        }
+        else {
+            print_calib(chip, &calib);
+        }
+    }
+    else if(strcmp(cmd, "set") == 0 && (nargs == 3 || nargs == 4)) {
+        const unsigned chip = (unsigned)strtoul(args[0], NULL, 0);
+        calib.offset = (int32_t)strtol(args[1], NULL, 0);
+        calib.scale = strtof(args[2], NULL);
+        calib.timestamp = nargs == 4 ? (uint32_t)strtoul(args[3], NULL, 0) : 0;
+        if(chip >= HX711_CALIB_MAX_CHIPS ||
+            !hx711_calib_store_save(&store, (uint8_t)chip, &calib)) {
+                fprintf(stderr, "unable to save calibration\n");
+                ret = EXIT_FAILURE;
+        }
+    }
+    else if(strcmp(cmd, "stress") == 0 && nargs == 1) {
+        const unsigned long count = strtoul(args[0], NULL, 0);
+        hx711_calib_t check;
+        for(unsigned long i = 0; i < count && ret == EXIT_SUCCESS; ++i) {
+            const uint8_t chip = (uint8_t)(i % 4);
+            calib.offset = (int32_t)i;
+            calib.scale = 1.0f + (float)chip;
+            calib.timestamp = (uint32_t)i;
+            if(!hx711_calib_store_save(&store, chip, &calib) ||
+                !hx711_calib_store_load(&store, chip, &check) ||
+                check.offset != calib.offset ||
+                check.timestamp != calib.timestamp) {
+                    fprintf(stderr, "mismatch after %lu saves\n", i);
+                    ret = EXIT_FAILURE;
+            }
+        }
+    }
+    else {
+        usage(argv[0]);
+        ret = EXIT_FAILURE;
+    }
+
+    fclose(ff.fp);
+    return ret;
+
+}
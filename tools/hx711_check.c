@@ -0,0 +1,254 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side check of src/hx711.c. The library is built
+ * against tools/hx711_shim.h, which runs the real
+ * hx711_reader PIO program against an hx711_model_t, so what
+ * is checked is what the chip would see on PD_SCK:
+ * 
+ *  values          reads, timeouts, noblock, avg and median
+ *                  return the model's input
+ *  gain            hx711_set_gain and hx711_power_up send the
+ *                  pulses for the wanted channel and gain, and
+ *                  the first value after is converted with it
+ *  power down      hx711_power_down holds PD_SCK high long
+ *                  enough to power the chip down, and
+ *                  hx711_power_up brings it back, reset, after
+ *                  the settling time
+ *  rate            hx711_set_rate drives the RATE pin, retunes
+ *                  an attached notch filter and resets an
+ *                  attached glitch filter
+ *  timing          no read is cut short, none has extra pulses
+ *                  and none collides with a conversion
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -Itools/shim -o hx711_check tools/hx711_check.c \
+ *      tools/hx711_shim.c tools/hx711_model.c src/hx711.c \
+ *      src/util.c src/hx711_glitch.c src/hx711_notch.c \
+ *      src/hx711_stability.c -lm
+ * 
+ * Usage:
+ *  hx711_check
+ * 
+ * Exits with 0 if every check passes.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hx711_model.h"
+#include "hx711_shim.h"
+#include "../include/hx711.h"
+#include "../include/hx711_reader.pio.h"
+
+#define CLOCK_PIN       14
+#define DATA_PIN        15
+#define RATE_PIN        16
+
+#define INPUT_A         -123456
+#define INPUT_B         4567
+
+//values the RX FIFO can hold, plus the one being converted
+#define MAX_STALE       5
+
+static unsigned failures = 0;
+
+static void expect(
+    const bool ok,
+    const char* const fmt,
+    ...) {
+
+        va_list args;
+
+        va_start(args, fmt);
+        printf("%s  ", ok ? "ok  " : "FAIL");
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+
+        failures += !ok;
+
+}
+
+/**
+ * @brief Read until a value matches, as an application would
+ * after changing the input; values already queued in the FIFO
+ * are older.
+ */
+static bool read_until(
+    hx711_t* const hx,
+    const int32_t want) {
+        for(unsigned i = 0; i < MAX_STALE; ++i) {
+            if(hx711_get_value(hx) == want) {
+                return true;
+            }
+        }
+        return false;
+}
+
+/**
+ * @brief Gain of the model once the pulses after the last read
+ * have been sent; the state machine sends them just after the
+ * value is pushed.
+ */
+static hx711_model_gain_t model_gain(hx711_model_t* const m) {
+    sleep_us(10);
+    hx711_shim_sync_models();
+    return hx711_model_get_gain(m);
+}
+
+int main(void) {
+
+    hx711_model_config_t mcfg;
+    hx711_model_t m;
+
+    hx711_model_get_default_config(&mcfg, 10);
+    mcfg.input_a = INPUT_A;
+    mcfg.input_b = INPUT_B;
+    hx711_model_init(&m, &mcfg);
+    hx711_shim_attach(&m, CLOCK_PIN, DATA_PIN);
+
+    hx711_t hx;
+    const hx711_config_t cfg = {
+        .clock_pin = CLOCK_PIN,
+        .data_pin = DATA_PIN,
+        .rate_pin = RATE_PIN,
+        .pio = pio0,
+        .pio_init = hx711_reader_pio_init,
+        .reader_prog = &hx711_reader_program,
+        .reader_prog_init = hx711_reader_program_init
+    };
+
+    hx711_init(&hx, &cfg);
+    hx711_power_up(&hx, hx711_gain_128);
+
+    //values
+    expect(hx711_get_value(&hx) == INPUT_A, "first value is channel A/128");
+    expect(hx711_get_value(&hx) == INPUT_A, "second value is channel A/128");
+
+    int32_t val = 0;
+
+    expect(!hx711_get_value_noblock(&hx, &val), "noblock straight after a read finds nothing");
+    expect(!hx711_get_value_timeout(&hx, &val, 1000), "1ms timeout at 10 SPS times out");
+    expect(hx711_get_value_timeout(&hx, &val, 250000) && val == INPUT_A,
+        "250ms timeout at 10 SPS gets a value");
+    expect(hx711_get_value_avg(&hx, 5) == INPUT_A, "mean of 5 values");
+    expect(hx711_get_value_median(&hx, 5) == INPUT_A, "median of 5 values");
+
+    hx711_model_set_input(&m, INPUT_A + 1000, INPUT_B);
+    expect(read_until(&hx, INPUT_A + 1000), "a new input is read within %u values", MAX_STALE);
+    hx711_model_set_input(&m, INPUT_A, INPUT_B);
+    read_until(&hx, INPUT_A);
+
+    //gain
+    hx711_set_gain(&hx, hx711_gain_64);
+    expect(hx711_get_value(&hx) == INPUT_A / 2, "first value after set_gain(64) is channel A/64");
+    expect(model_gain(&m) == hx711_model_gain_64, "set_gain(64) sends 27 pulses");
+
+    hx711_set_gain(&hx, hx711_gain_32);
+    expect(hx711_get_value(&hx) == INPUT_B, "first value after set_gain(32) is channel B");
+    expect(model_gain(&m) == hx711_model_gain_32, "set_gain(32) sends 26 pulses");
+
+    hx711_set_gain(&hx, hx711_gain_128);
+    expect(hx711_get_value(&hx) == INPUT_A, "first value after set_gain(128) is channel A/128");
+    expect(model_gain(&m) == hx711_model_gain_128, "set_gain(128) sends 25 pulses");
+
+    //power down
+    hx711_power_down(&hx);
+    hx711_wait_power_down();
+    hx711_shim_sync_models();
+
+    expect(!hx711_model_is_powered(&m), "power_down and wait_power_down power the chip down");
+    expect(hx711_model_get_power_downs(&m) == 1, "one power down");
+
+    const uint32_t conversions = hx711_model_get_conversions(&m);
+
+    sleep_ms(1000);
+    hx711_shim_sync_models();
+
+    expect(hx711_model_get_conversions(&m) == conversions, "no conversions while powered down");
+
+    const uint64_t up = hx711_shim_get_time_ns();
+
+    hx711_power_up(&hx, hx711_gain_64);
+    hx711_shim_sync_models();
+
+    expect(hx711_model_is_powered(&m), "power_up powers the chip up");
+    expect(hx711_get_value(&hx) == INPUT_A, "first value after power up is channel A/128");
+    expect(hx711_shim_get_time_ns() - up >= mcfg.settling_ns,
+        "first value after power up waits for settling (%.1fms)",
+        (hx711_shim_get_time_ns() - up) / 1e6);
+    expect(model_gain(&m) == hx711_model_gain_64, "power_up(64) sends 27 pulses");
+    expect(hx711_get_value(&hx) == INPUT_A / 2, "second value after power_up(64) is channel A/64");
+
+    //rate
+    hx711_notch_t notch;
+    hx711_glitch_t glitch;
+    hx711_glitch_config_t gcfg;
+
+    hx711_notch_init(&notch, hx711_get_rate_sps(hx711_rate_10), hx711_mains_60);
+    hx711_glitch_get_default_config(&gcfg);
+    hx711_glitch_init(&glitch, &gcfg);
+    hx711_set_notch_filter(&hx, &notch);
+    hx711_set_glitch_filter(&hx, &glitch);
+
+    for(unsigned i = 0; i < MAX_STALE; ++i) {
+        hx711_get_value(&hx);
+    }
+
+    expect(glitch._primed && notch._primed, "filters primed at 10 SPS");
+
+    expect(!hx711_shim_get_pin(RATE_PIN), "RATE pin low after init");
+    hx711_set_rate(&hx, hx711_rate_80);
+    expect(hx711_shim_get_pin(RATE_PIN), "set_rate(80) drives RATE high");
+    expect(!notch._comb &&
+        notch._coeffs.b1 == HX711_NOTCH_COEFFS_80[hx711_mains_60].b1 &&
+        !notch._primed,
+        "set_rate(80) tunes the notch filter to 60Hz at 80 SPS");
+    expect(!glitch._primed, "set_rate(80) resets the glitch filter");
+    hx711_set_rate(&hx, hx711_rate_10);
+    expect(!hx711_shim_get_pin(RATE_PIN), "set_rate(10) drives RATE low");
+    expect(notch._comb, "set_rate(10) switches the notch filter to the comb");
+
+    hx711_set_notch_filter(&hx, NULL);
+    hx711_set_glitch_filter(&hx, NULL);
+
+    //timing
+    expect(hx711_model_get_short_reads(&m) == 0, "no reads cut short");
+    expect(hx711_model_get_extra_pulses(&m) == 0, "no extra pulses");
+    expect(hx711_model_get_collisions(&m) == 0, "no reads collide with a conversion");
+
+    hx711_power_down(&hx);
+    hx711_wait_power_down();
+    hx711_close(&hx);
+
+    expect(!pio_sm_is_claimed(pio0, hx._reader_sm), "close releases the state machine");
+
+    printf("%u failure(s)\n", failures);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -0,0 +1,444 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side benchmark comparing hx711::Multi<N>'s read path
+ * with the C library's. The real src/hx711_multi.c is built
+ * against tools/hx711_shim.h, and for every chip count up to
+ * HX711_MULTI_MAX_CHIPS this times:
+ * 
+ *  c_runtime       hx711_multi_pinvals_to_values
+ *  c_fixed         hx711_multi_pinvals_to_values_N, as defined
+ *                  by HX711_MULTI_DEFINE_PINVALS_TO_VALUES
+ *  cpp_decode      hx711::decode<N>
+ *  c_get           hx711_multi_async_get_values: decode, then
+ *                  the glitch and notch filters
+ *  cpp_get         hx711::async_get_values<N>, which is what
+ *                  Multi<N>::read and async_get run once the
+ *                  async read is done
+ * 
+ * Every pair is checked to agree, and each result is printed
+ * as a CSV row. Each is timed several times and the fastest
+ * run kept.
+ * 
+ * The get rows use an hx711_multi_t set up with
+ * hx711_multi_init, with a hx711_model_t on each data pin.
+ * One real read through the shim's PIO, DMA and IRQs must
+ * return every model's input from both functions before that
+ * read's frame is swapped for the test frames. The shared
+ * clock takes GPIO 0, so only 29 chips fit on the RP2040's 30
+ * GPIOs and the 30 chip get rows are skipped.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -DNDEBUG -Itools/shim -c src/common.c \
+ *      src/hx711_multi.c src/hx711.c src/hx711_alarm.c \
+ *      src/hx711_glitch.c src/hx711_notch.c \
+ *      src/hx711_stability.c src/util.c tools/hx711_shim.c \
+ *      tools/hx711_model.c
+ *  c++ -std=c++20 -O2 -DNDEBUG -Itools/shim -o hx711_cpp_bench \
+ *      tools/hx711_cpp_bench.cpp *.o -lm
+ * 
+ * Usage:
+ *  hx711_cpp_bench [frames]
+ * 
+ * Columns:
+ *  function,chips,ns_per_frame,ns_per_chip
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <utility>
+#include "hx711_model.h"
+#include "hx711_shim.h"
+#include "../include/common.h"
+#include "../include/hx711_decode.hpp"
+#include "../include/hx711_glitch.h"
+#include "../include/hx711_multi.h"
+#include "../include/hx711_multi.hpp"
+#include "../include/hx711_multi_decode.h"
+#include "../include/hx711_notch.h"
+
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(1)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(2)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(3)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(4)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(5)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(6)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(7)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(8)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(9)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(10)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(11)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(12)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(13)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(14)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(15)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(16)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(17)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(18)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(19)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(20)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(21)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(22)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(23)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(24)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(25)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(26)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(27)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(28)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(29)
+HX711_MULTI_DEFINE_PINVALS_TO_VALUES(30)
+
+namespace {
+
+using fixed_fn_t = void (*)(const std::uint32_t*, std::int32_t*);
+
+constexpr std::array<fixed_fn_t, HX711_MULTI_MAX_CHIPS> c_fixed = {
+    hx711_multi_pinvals_to_values_1,
+    hx711_multi_pinvals_to_values_2,
+    hx711_multi_pinvals_to_values_3,
+    hx711_multi_pinvals_to_values_4,
+    hx711_multi_pinvals_to_values_5,
+    hx711_multi_pinvals_to_values_6,
+    hx711_multi_pinvals_to_values_7,
+    hx711_multi_pinvals_to_values_8,
+    hx711_multi_pinvals_to_values_9,
+    hx711_multi_pinvals_to_values_10,
+    hx711_multi_pinvals_to_values_11,
+    hx711_multi_pinvals_to_values_12,
+    hx711_multi_pinvals_to_values_13,
+    hx711_multi_pinvals_to_values_14,
+    hx711_multi_pinvals_to_values_15,
+    hx711_multi_pinvals_to_values_16,
+    hx711_multi_pinvals_to_values_17,
+    hx711_multi_pinvals_to_values_18,
+    hx711_multi_pinvals_to_values_19,
+    hx711_multi_pinvals_to_values_20,
+    hx711_multi_pinvals_to_values_21,
+    hx711_multi_pinvals_to_values_22,
+    hx711_multi_pinvals_to_values_23,
+    hx711_multi_pinvals_to_values_24,
+    hx711_multi_pinvals_to_values_25,
+    hx711_multi_pinvals_to_values_26,
+    hx711_multi_pinvals_to_values_27,
+    hx711_multi_pinvals_to_values_28,
+    hx711_multi_pinvals_to_values_29,
+    hx711_multi_pinvals_to_values_30
+};
+
+constexpr std::size_t FRAMES = 256;
+constexpr int RUNS = 5;
+
+std::array<std::array<std::uint32_t, hx711::frame_words>, FRAMES> pinvals;
+
+volatile std::int32_t sink;
+
+void fill() {
+    std::uint32_t seed = 1;
+    for(auto& frame : pinvals) {
+        for(auto& word : frame) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            word = seed;
+        }
+    }
+}
+
+/**
+ * @brief hx711::decode<N>, out of line so it is timed as a
+ * call like the C functions.
+ */
+template<std::size_t N>
+[[gnu::noinline]] hx711::Frame<N> cpp_decode(const hx711::RawFrame pv) {
+    return hx711::decode<N>(pv);
+}
+
+constexpr uint CLOCK_PIN = 0;
+constexpr uint DATA_PIN_BASE = 1;
+
+//chips which fit on the GPIOs above the clock pin
+constexpr std::size_t READ_CHIPS = NUM_BANK0_GPIOS - DATA_PIN_BASE;
+
+std::array<hx711_model_t, READ_CHIPS> models;
+
+std::int32_t model_input(const std::size_t i) {
+    return 1000 * static_cast<std::int32_t>(i + 1) * (i % 2 ? -1 : 1);
+}
+
+void attach_models() {
+
+    hx711_model_config_t cfg;
+    hx711_model_get_default_config(&cfg, 80);
+
+    for(std::size_t i = 0; i < READ_CHIPS; ++i) {
+        cfg.input_a = model_input(i);
+        cfg.seed = static_cast<std::uint32_t>(i) + 1;
+        hx711_model_init(&models[i], &cfg);
+        hx711_shim_attach(&models[i], CLOCK_PIN, DATA_PIN_BASE + static_cast<uint>(i));
+    }
+
+}
+
+/**
+ * @brief An hx711_multi_t of N chips which has just finished a
+ * real read, with one set of glitch and notch filters for the
+ * C function and one for the C++ one.
+ */
+template<std::size_t N>
+struct Finished {
+
+    hx711_multi_t hxm;
+    std::array<hx711_glitch_t, N> c_glitch;
+    std::array<hx711_glitch_t, N> cpp_glitch;
+    std::array<hx711_notch_t, N> c_notch;
+    std::array<hx711_notch_t, N> cpp_notch;
+    bool ok;
+
+    Finished() {
+
+        hx711_multi_config_t hxmcfg;
+        hx711_multi_get_default_config(&hxmcfg);
+        hxmcfg.clock_pin = CLOCK_PIN;
+        hxmcfg.data_pin_base = DATA_PIN_BASE;
+        hxmcfg.chips_len = N;
+
+        hx711_multi_init(&hxm, &hxmcfg);
+        hx711_multi_power_up(&hxm, hx711_gain_128);
+
+        hx711_multi_async_start(&hxm);
+        while(!hx711_multi_async_done(&hxm)) {
+            tight_loop_contents();
+        }
+
+        std::array<std::int32_t, N> c;
+        hx711_multi_async_get_values(&hxm, c.data());
+        const auto cpp = hx711::async_get_values<N>(&hxm);
+
+        ok = c == cpp;
+        for(std::size_t i = 0; i < N; ++i) {
+            ok = ok && c[i] == model_input(i);
+        }
+
+        hx711_glitch_config_t cfg;
+        hx711_glitch_get_default_config(&cfg);
+
+        for(std::size_t i = 0; i < N; ++i) {
+            hx711_glitch_init(&c_glitch[i], &cfg);
+            hx711_glitch_init(&cpp_glitch[i], &cfg);
+            hx711_notch_init(&c_notch[i], 80, hx711_mains_50);
+            hx711_notch_init(&cpp_notch[i], 80, hx711_mains_50);
+        }
+
+    }
+
+    ~Finished() {
+        hx711_multi_power_down(&hxm);
+        hx711_multi_close(&hxm);
+    }
+
+    Finished(const Finished&) = delete;
+    Finished& operator=(const Finished&) = delete;
+
+    void use_c_filters() {
+        hx711_multi_set_glitch_filters(&hxm, c_glitch.data());
+        hx711_multi_set_notch_filters(&hxm, c_notch.data());
+    }
+
+    void use_cpp_filters() {
+        hx711_multi_set_glitch_filters(&hxm, cpp_glitch.data());
+        hx711_multi_set_notch_filters(&hxm, cpp_notch.data());
+    }
+
+    /**
+     * @brief The hx711_multi_t with test frame f in place of
+     * the frame of the real read.
+     */
+    hx711_multi_t* at(const std::size_t f) {
+        hxm._frame = pinvals[f].data();
+        return &hxm;
+    }
+
+};
+
+template<typename F>
+double time_ns_per_frame(
+    const unsigned long frames,
+    F&& fn) {
+
+        double best = 0;
+
+        for(int r = 0; r < RUNS; ++r) {
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for(unsigned long n = 0; n < frames; ++n) {
+                fn(n % FRAMES);
+            }
+
+            const std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+            const double ns = elapsed.count() / frames;
+
+            if(r == 0 || ns < best) {
+                best = ns;
+            }
+
+        }
+
+        return best;
+
+}
+
+template<std::size_t N>
+bool bench_get(const unsigned long frames) {
+
+    Finished<N> fin;
+
+    if(!fin.ok) {
+        std::fprintf(stderr, "real read mismatch at %zu chips\n", N);
+        return false;
+    }
+
+    //separate but identical filters, fed the same frames, so
+    //their outputs must match frame by frame
+    for(std::size_t f = 0; f < FRAMES; ++f) {
+
+        std::array<std::int32_t, N> d;
+
+        fin.use_c_filters();
+        hx711_multi_async_get_values(fin.at(f), d.data());
+
+        fin.use_cpp_filters();
+        const auto e = hx711::async_get_values<N>(fin.at(f));
+
+        if(d != e) {
+            std::fprintf(stderr, "get mismatch at %zu chips\n", N);
+            return false;
+        }
+
+    }
+
+    fin.use_c_filters();
+
+    const double ns_c_get = time_ns_per_frame(frames, [&fin](const std::size_t f) {
+        std::array<std::int32_t, N> values;
+        hx711_multi_async_get_values(fin.at(f), values.data());
+        sink = values[N - 1];
+    });
+
+    fin.use_cpp_filters();
+
+    const double ns_cpp_get = time_ns_per_frame(frames, [&fin](const std::size_t f) {
+        sink = hx711::async_get_values<N>(fin.at(f))[N - 1];
+    });
+
+    std::printf("c_get,%zu,%.3f,%.3f\n", N, ns_c_get, ns_c_get / N);
+    std::printf("cpp_get,%zu,%.3f,%.3f\n", N, ns_cpp_get, ns_cpp_get / N);
+
+    return true;
+
+}
+
+template<std::size_t N>
+bool bench(const unsigned long frames) {
+
+    for(std::size_t f = 0; f < FRAMES; ++f) {
+
+        std::array<std::int32_t, N> a;
+        std::array<std::int32_t, N> b;
+
+        hx711_multi_pinvals_to_values(pinvals[f].data(), a.data(), N);
+        c_fixed[N - 1](pinvals[f].data(), b.data());
+        const auto c = cpp_decode<N>(pinvals[f]);
+
+        if(a != b || a != c) {
+            std::fprintf(stderr, "decode mismatch at %zu chips\n", N);
+            return false;
+        }
+
+    }
+
+    const double ns_runtime = time_ns_per_frame(frames, [](const std::size_t f) {
+        std::array<std::int32_t, N> values;
+        hx711_multi_pinvals_to_values(pinvals[f].data(), values.data(), N);
+        sink = values[N - 1];
+    });
+
+    const double ns_fixed = time_ns_per_frame(frames, [](const std::size_t f) {
+        std::array<std::int32_t, N> values;
+        c_fixed[N - 1](pinvals[f].data(), values.data());
+        sink = values[N - 1];
+    });
+
+    const double ns_cpp = time_ns_per_frame(frames, [](const std::size_t f) {
+        sink = cpp_decode<N>(pinvals[f])[N - 1];
+    });
+
+    std::printf("c_runtime,%zu,%.3f,%.3f\n", N, ns_runtime, ns_runtime / N);
+    std::printf("c_fixed,%zu,%.3f,%.3f\n", N, ns_fixed, ns_fixed / N);
+    std::printf("cpp_decode,%zu,%.3f,%.3f\n", N, ns_cpp, ns_cpp / N);
+
+    if constexpr(N <= READ_CHIPS) {
+        return bench_get<N>(frames);
+    }
+    else {
+        return true;
+    }
+
+}
+
+template<std::size_t... Ns>
+bool bench_all(
+    const unsigned long frames,
+    std::index_sequence<Ns...>) {
+        return (bench<Ns + 1>(frames) && ...);
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    const unsigned long frames = argc > 1
+        ? std::strtoul(argv[1], nullptr, 0)
+        : 1000000;
+
+    if(frames == 0) {
+        std::fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fill();
+    attach_models();
+
+    std::printf("function,chips,ns_per_frame,ns_per_chip\n");
+
+    return bench_all(frames, std::make_index_sequence<HX711_MULTI_MAX_CHIPS>())
+        ? EXIT_SUCCESS
+        : EXIT_FAILURE;
+
+}
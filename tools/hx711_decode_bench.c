@@ -0,0 +1,420 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side throughput benchmark for the decode hot path. For
+ * every chip count from 1 to 32 and every bit pattern it times
+ * how many frames per second each function gets through, and
+ * prints one CSV row per combination so runs can be diffed or
+ * plotted to catch regressions before they reach a board.
+ * 
+ * The decode bodies come from include/hx711_decode.h, which is
+ * what hx711_get_twos_comp_batch, hx711_multi_pinvals_to_values
+ * and HX711_MULTI_DEFINE_PINVALS_TO_VALUES compile, wrapped here
+ * in non-inlined functions of the same shape. The calibrated and
+ * filtered rows add the library's own pure stages after
+ * decoding. Figures are for the host; compare runs on the same
+ * machine, not against an RP2040.
+ * 
+ * Functions:
+ *  pinvals_to_values       hx711_multi_pinvals_to_values
+ *  pinvals_to_values_n     hx711_multi_pinvals_to_values_N
+ *  get_twos_comp           hx711_get_twos_comp, once per chip
+ *  get_twos_comp_batch     hx711_get_twos_comp_batch
+ *  decode_calib            decode + hx711_calib_apply_multi
+ *  decode_lut              decode + hx711_lut_apply_multi
+ *  decode_glitch           decode + hx711_glitch_filter_multi
+ *  decode_notch            decode + hx711_notch_filter_multi
+ * 
+ * Patterns:
+ *  random                  uniformly random 24 bit values
+ *  zero                    every bit clear
+ *  ones                    every bit set (-1, sign extended)
+ *  toggle                  every chip swinging between full
+ *                          scale and minus full scale on every
+ *                          frame; the worst case for the glitch
+ *                          filter and the correction table
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_decode_bench tools/hx711_decode_bench.c \
+ *      src/hx711_calib.c src/hx711_crc.c src/hx711_glitch.c \
+ *      src/hx711_lut.c src/hx711_notch.c -lm
+ * 
+ * Usage:
+ *  hx711_decode_bench [-t ms] [-c max_chips] [-f function] > results.csv
+ * 
+ *  -t  time spent on each row (default 20)
+ *  -c  stop at this many chips (default 32)
+ *  -f  only run the named function
+ * 
+ * Columns:
+ *  function,chips,pattern,frames,ns_per_frame,frames_per_s,ns_per_chip
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/hx711_calib.h"
+#include "../include/hx711_decode.h"
+#include "../include/hx711_glitch.h"
+#include "../include/hx711_lut.h"
+#include "../include/hx711_notch.h"
+
+#define MAX_CHIPS       32
+
+//frames cycled through for each row; enough that the branch
+//predictor cannot learn a random pattern, small enough to
+//stay in L1
+#define FRAMES          256
+
+#define NOINLINE        __attribute__((noinline))
+
+typedef enum {
+    pattern_random = 0,
+    pattern_zero,
+    pattern_ones,
+    pattern_toggle,
+    pattern_count
+} pattern_t;
+
+static const char* const PATTERN_NAMES[] = {
+    "random",
+    "zero",
+    "ones",
+    "toggle"
+};
+
+static uint32_t pinvals[FRAMES][HX711_DECODE_BITS];
+static uint32_t raws[FRAMES][MAX_CHIPS];
+
+static hx711_calib_t calibs[MAX_CHIPS];
+static hx711_lut_t luts[MAX_CHIPS];
+static hx711_glitch_t glitches[MAX_CHIPS];
+static hx711_notch_t notches[MAX_CHIPS];
+
+static volatile int32_t sink;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void fill(
+    const pattern_t pattern,
+    const size_t chips) {
+
+        uint32_t seed = 1;
+
+        memset(pinvals, 0, sizeof(pinvals));
+
+        for(size_t f = 0; f < FRAMES; ++f) {
+            for(size_t i = 0; i < chips; ++i) {
+
+                uint32_t raw;
+
+                switch(pattern) {
+                    case pattern_random:
+                        seed ^= seed << 13;
+                        seed ^= seed >> 17;
+                        seed ^= seed << 5;
+                        raw = seed;
+                        break;
+                    case pattern_zero:
+                        raw = 0;
+                        break;
+                    case pattern_ones:
+                        raw = UINT32_C(0xffffff);
+                        break;
+                    case pattern_toggle:
+                    default:
+                        raw = (f + i) % 2 ? UINT32_C(0x800000) : UINT32_C(0x7fffff);
+                        break;
+                }
+
+                raw &= UINT32_C(0xffffff);
+                raws[f][i] = raw;
+
+                for(size_t b = 0; b < HX711_DECODE_BITS; ++b) {
+                    pinvals[f][b] |= ((raw >> (HX711_DECODE_BITS - 1 - b)) & 1) << i;
+                }
+
+            }
+        }
+
+}
+
+static void reset_stages(void) {
+
+    hx711_glitch_config_t gcfg;
+    hx711_glitch_get_default_config(&gcfg);
+
+    //a slight bow, so lookups land on every segment
+    hx711_lut_point_t points[9];
+    for(size_t p = 0; p < 9; ++p) {
+        const int32_t raw = -0x800000 + (int32_t)p * 0x1fffff;
+        points[p].raw = raw;
+        points[p].value = raw + (int32_t)(p * (8 - p)) * 100;
+    }
+
+    for(size_t i = 0; i < MAX_CHIPS; ++i) {
+        calibs[i].offset = 1000 * (int32_t)i;
+        calibs[i].scale = 420.0f;
+        calibs[i].timestamp = 0;
+        hx711_lut_init(&luts[i], points, 9);
+        hx711_glitch_init(&glitches[i], &gcfg);
+        hx711_notch_init(&notches[i], 80, hx711_mains_50);
+    }
+
+}
+
+/**
+ * @brief Same as hx711_multi_pinvals_to_values.
+ */
+static NOINLINE void pinvals_to_values(
+    const uint32_t* const pv,
+    int32_t* const values,
+    const size_t len) {
+        hx711_decode_pinvals(pv, values, len);
+}
+
+/**
+ * @brief Same as HX711_MULTI_DEFINE_PINVALS_TO_VALUES(N).
+ */
+#define DEFINE_FIXED(N) \
+    static NOINLINE void pinvals_to_values_ ## N( \
+        const uint32_t* const pv, \
+        int32_t* const values) { \
+            hx711_decode_pinvals(pv, values, (N)); \
+    }
+
+DEFINE_FIXED(1)  DEFINE_FIXED(2)  DEFINE_FIXED(3)  DEFINE_FIXED(4)
+DEFINE_FIXED(5)  DEFINE_FIXED(6)  DEFINE_FIXED(7)  DEFINE_FIXED(8)
+DEFINE_FIXED(9)  DEFINE_FIXED(10) DEFINE_FIXED(11) DEFINE_FIXED(12)
+DEFINE_FIXED(13) DEFINE_FIXED(14) DEFINE_FIXED(15) DEFINE_FIXED(16)
+DEFINE_FIXED(17) DEFINE_FIXED(18) DEFINE_FIXED(19) DEFINE_FIXED(20)
+DEFINE_FIXED(21) DEFINE_FIXED(22) DEFINE_FIXED(23) DEFINE_FIXED(24)
+DEFINE_FIXED(25) DEFINE_FIXED(26) DEFINE_FIXED(27) DEFINE_FIXED(28)
+DEFINE_FIXED(29) DEFINE_FIXED(30) DEFINE_FIXED(31) DEFINE_FIXED(32)
+
+typedef void (*fixed_fn_t)(const uint32_t*, int32_t*);
+
+static const fixed_fn_t FIXED[MAX_CHIPS] = {
+    pinvals_to_values_1,  pinvals_to_values_2,  pinvals_to_values_3,  pinvals_to_values_4,
+    pinvals_to_values_5,  pinvals_to_values_6,  pinvals_to_values_7,  pinvals_to_values_8,
+    pinvals_to_values_9,  pinvals_to_values_10, pinvals_to_values_11, pinvals_to_values_12,
+    pinvals_to_values_13, pinvals_to_values_14, pinvals_to_values_15, pinvals_to_values_16,
+    pinvals_to_values_17, pinvals_to_values_18, pinvals_to_values_19, pinvals_to_values_20,
+    pinvals_to_values_21, pinvals_to_values_22, pinvals_to_values_23, pinvals_to_values_24,
+    pinvals_to_values_25, pinvals_to_values_26, pinvals_to_values_27, pinvals_to_values_28,
+    pinvals_to_values_29, pinvals_to_values_30, pinvals_to_values_31, pinvals_to_values_32
+};
+
+/**
+ * @brief Same as hx711_get_twos_comp.
+ */
+static NOINLINE int32_t get_twos_comp(const uint32_t raw) {
+    return HX711_SIGN_EXTEND(raw);
+}
+
+/**
+ * @brief Same as hx711_get_twos_comp_batch.
+ */
+static NOINLINE void get_twos_comp_batch(
+    const uint32_t* const raw,
+    int32_t* const out,
+    const size_t n) {
+        hx711_decode_twos_comp_batch(raw, out, n);
+}
+
+/**
+ * @brief Run one function over frame f.
+ */
+typedef void (*bench_fn_t)(size_t f, size_t chips);
+
+static void bench_pinvals_to_values(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    pinvals_to_values(pinvals[f], values, chips);
+    sink = values[chips - 1];
+}
+
+static void bench_pinvals_to_values_n(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    FIXED[chips - 1](pinvals[f], values);
+    sink = values[chips - 1];
+}
+
+static void bench_get_twos_comp(const size_t f, const size_t chips) {
+    int32_t acc = 0;
+    for(size_t i = 0; i < chips; ++i) {
+        acc += get_twos_comp(raws[f][i]);
+    }
+    sink = acc;
+}
+
+static void bench_get_twos_comp_batch(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    get_twos_comp_batch(raws[f], values, chips);
+    sink = values[chips - 1];
+}
+
+static void bench_decode_calib(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    float out[MAX_CHIPS];
+    pinvals_to_values(pinvals[f], values, chips);
+    hx711_calib_apply_multi(calibs, values, out, chips);
+    sink = (int32_t)out[chips - 1];
+}
+
+static void bench_decode_lut(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    pinvals_to_values(pinvals[f], values, chips);
+    hx711_lut_apply_multi(luts, values, values, chips);
+    sink = values[chips - 1];
+}
+
+static void bench_decode_glitch(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    pinvals_to_values(pinvals[f], values, chips);
+    hx711_glitch_filter_multi(glitches, values, chips);
+    sink = values[chips - 1];
+}
+
+static void bench_decode_notch(const size_t f, const size_t chips) {
+    int32_t values[MAX_CHIPS];
+    pinvals_to_values(pinvals[f], values, chips);
+    hx711_notch_filter_multi(notches, values, chips);
+    sink = values[chips - 1];
+}
+
+static const struct {
+    const char* name;
+    bench_fn_t fn;
+} BENCHES[] = {
+    { "pinvals_to_values",      bench_pinvals_to_values },
+    { "pinvals_to_values_n",    bench_pinvals_to_values_n },
+    { "get_twos_comp",          bench_get_twos_comp },
+    { "get_twos_comp_batch",    bench_get_twos_comp_batch },
+    { "decode_calib",           bench_decode_calib },
+    { "decode_lut",             bench_decode_lut },
+    { "decode_glitch",          bench_decode_glitch },
+    { "decode_notch",           bench_decode_notch }
+};
+
+static void run(
+    const size_t b,
+    const size_t chips,
+    const pattern_t pattern,
+    const double seconds) {
+
+        const bench_fn_t fn = BENCHES[b].fn;
+        unsigned long frames = 0;
+        unsigned long batch = FRAMES;
+
+        reset_stages();
+
+        //warm up
+        for(size_t f = 0; f < FRAMES; ++f) {
+            fn(f, chips);
+        }
+
+        const double start = now_s();
+        double elapsed;
+
+        //check the clock only every batch of frames, doubling
+        //the batch until a check is cheap next to the work
+        do {
+            for(unsigned long n = 0; n < batch; ++n) {
+                fn(n % FRAMES, chips);
+            }
+            frames += batch;
+            elapsed = now_s() - start;
+            if(elapsed < seconds / 64) {
+                batch *= 2;
+            }
+        } while(elapsed < seconds);
+
+        const double ns_per_frame = elapsed * 1e9 / frames;
+
+        printf("%s,%zu,%s,%lu,%.3f,%.0f,%.3f\n",
+            BENCHES[b].name,
+            chips,
+            PATTERN_NAMES[pattern],
+            frames,
+            ns_per_frame,
+            1e9 / ns_per_frame,
+            ns_per_frame / chips);
+
+}
+
+int main(int argc, char** argv) {
+
+    unsigned long ms = 20;
+    size_t max_chips = MAX_CHIPS;
+    const char* only = NULL;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:c:f:")) != -1) {
+        switch(opt) {
+            case 't': ms = strtoul(optarg, NULL, 0); break;
+            case 'c': max_chips = strtoul(optarg, NULL, 0); break;
+            case 'f': only = optarg; break;
+            default:
+                fprintf(stderr,
+                    "usage: %s [-t ms] [-c max_chips] [-f function]\n",
+                    argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if(ms == 0 || max_chips == 0 || max_chips > MAX_CHIPS) {
+        fprintf(stderr, "ms must be > 0 and max_chips 1 to %d\n", MAX_CHIPS);
+        return EXIT_FAILURE;
+    }
+
+    printf("function,chips,pattern,frames,ns_per_frame,frames_per_s,ns_per_chip\n");
+
+    for(size_t b = 0; b < sizeof(BENCHES) / sizeof(BENCHES[0]); ++b) {
+
+        if(only != NULL && strcmp(only, BENCHES[b].name) != 0) {
+            continue;
+        }
+
+        for(size_t chips = 1; chips <= max_chips; ++chips) {
+            for(int p = 0; p < pattern_count; ++p) {
+                fill((pattern_t)p, chips);
+                run(b, chips, (pattern_t)p, ms / 1000.0);
+            }
+        }
+
+    }
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,316 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side benchmark for hx711_delta_enc_t. It compresses a
+ * recording made with hx711_stream_t (eg. captured from a
+ * serial port) or, with no file, a synthetic trace of a
+ * steady load with noise and occasional steps. It checks
+ * every frame decodes back exactly, then reports the
+ * compression ratio against 3 bytes per value and the time
+ * (and, on x86, cycles) taken to encode each value.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_delta_bench tools/hx711_delta_bench.c \
+ *      src/hx711_delta.c src/hx711_stream.c src/hx711_crc.c
+ * 
+ * Usage:
+ *  hx711_delta_bench [-r resync_interval] [file]
+ * 
+ * resync_interval defaults to 64.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/hx711_delta.h"
+#include "../include/hx711_stream.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define HAVE_RDTSC 1
+#endif
+
+#define SYNTH_FRAMES 100000
+#define SYNTH_CHIPS 4
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Read every good frame of a hx711_stream_t recording.
+ * All frames must have the same chip count.
+ */
+static int32_t* load_stream(
+    FILE* const fp,
+    size_t* const frames,
+    size_t* const chips) {
+
+        uint8_t buf[HX711_STREAM_ENCODED_MAX(HX711_STREAM_MAX_CHIPS)];
+        size_t len = 0;
+        size_t cap = 0;
+        int32_t* data = NULL;
+        int c;
+
+        *frames = 0;
+        *chips = 0;
+
+        while((c = fgetc(fp)) != EOF) {
+
+            if(c != 0) {
+                if(len < sizeof(buf)) {
+                    buf[len++] = (uint8_t)c;
+                }
+                continue;
+            }
+
+            uint32_t seq;
+            uint32_t timestamp;
+            int32_t values[HX711_STREAM_MAX_CHIPS];
+            size_t values_len;
+
+            if(len > 0 && len < sizeof(buf) &&
+                hx711_stream_decode(buf, len, &seq, &timestamp, values, &values_len) &&
+                (*chips == 0 || values_len == *chips)) {
+
+                    *chips = values_len;
+
+                    if(*frames == cap) {
+                        cap = cap ? cap * 2 : 1024;
+                        data = realloc(data, cap * *chips * sizeof(int32_t));
+                        if(data == NULL) {
+                            return NULL;
+                        }
+                    }
+
+                    for(size_t i = 0; i < *chips; ++i) {
+                        data[*frames * *chips + i] = values[i];
+                    }
+
+                    ++*frames;
+
+            }
+
+            len = 0;
+
+        }
+
+        return data;
+
+}
+
+static int32_t* synthesise(
+    size_t* const frames,
+    size_t* const chips) {
+
+        int32_t* const data = malloc(SYNTH_FRAMES * SYNTH_CHIPS * sizeof(int32_t));
+        int32_t load = 0;
+        uint32_t seed = 1;
+
+        if(data == NULL) {
+            return NULL;
+        }
+
+        for(size_t f = 0; f < SYNTH_FRAMES; ++f) {
+
+            //a new load every 1000 frames
+            if(f % 1000 == 0) {
+                seed = seed * 1664525u + 1013904223u;
+                load = (int32_t)(seed % 2000000);
+            }
+
+            for(size_t i = 0; i < SYNTH_CHIPS; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                //roughly +/-100 counts of noise
+                const int32_t noise = (int32_t)(seed >> 24) - 128 +
+                    (int32_t)((seed >> 16) & 0x3f) - 32;
+                data[f * SYNTH_CHIPS + i] = 150000 + (int32_t)i * 20000 + load / 4 + noise;
+            }
+
+        }
+
+        *frames = SYNTH_FRAMES;
+        *chips = SYNTH_CHIPS;
+
+        return data;
+
+}
+
+int main(int argc, char** argv) {
+
+    uint32_t resync = 64;
+    int opt;
+
+    while((opt = getopt(argc, argv, "r:")) != -1) {
+        if(opt == 'r') {
+            resync = (uint32_t)strtoul(optarg, NULL, 0);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-r resync_interval] [file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(resync == 0) {
+        fprintf(stderr, "resync_interval must be at least 1\n");
+        return 1;
+    }
+
+    size_t frames;
+    size_t chips;
+    int32_t* data;
+
+    if(optind < argc) {
+        FILE* const fp = fopen(argv[optind], "rb");
+        if(fp == NULL) {
+            perror(argv[optind]);
+            return 1;
+        }
+        data = load_stream(fp, &frames, &chips);
+        fclose(fp);
+    }
+    else {
+        data = synthesise(&frames, &chips);
+    }
+
+    if(data == NULL || frames == 0) {
+        fprintf(stderr, "no frames\n");
+        return 1;
+    }
+
+    uint8_t* const out = malloc(frames * HX711_DELTA_ENCODED_MAX(chips));
+    size_t* const lens = malloc(frames * sizeof(size_t));
+
+    if(out == NULL || lens == NULL) {
+        return 1;
+    }
+
+    hx711_delta_enc_t enc;
+    hx711_delta_enc_init(&enc, chips, resync);
+
+    size_t total = 0;
+
+    const double start = now_s();
+#ifdef HAVE_RDTSC
+    const uint64_t startCycles = __rdtsc();
+#endif
+
+    for(size_t f = 0; f < frames; ++f) {
+        lens[f] = hx711_delta_encode(&enc, &data[f * chips], &out[total]);
+        total += lens[f];
+    }
+
+#ifdef HAVE_RDTSC
+    const uint64_t cycles = __rdtsc() - startCycles;
+#endif
+    const double elapsed = now_s() - start;
+
+    //round trip
+    hx711_delta_dec_t dec;
+    hx711_delta_dec_init(&dec, chips);
+
+    size_t pos = 0;
+
+    for(size_t f = 0; f < frames; ++f) {
+
+        int32_t values[HX711_DELTA_MAX_CHIPS];
+        size_t used;
+
+        if(!hx711_delta_decode(&dec, &out[pos], total - pos, values, &used) ||
+            used != lens[f]) {
+                fprintf(stderr, "frame %zu failed to decode\n", f);
+                return 1;
+        }
+
+        for(size_t i = 0; i < chips; ++i) {
+            if(values[i] != data[f * chips + i]) {
+                fprintf(stderr, "frame %zu chip %zu mismatch\n", f, i);
+                return 1;
+            }
+        }
+
+        pos += used;
+
+    }
+
+    //drop frame 1 and check nothing is decoded against the
+    //wrong base until the next key frame
+    if(frames > resync && resync > 2) {
+
+        hx711_delta_dec_init(&dec, chips);
+        pos = 0;
+
+        for(size_t f = 0; f <= resync; ++f) {
+
+            int32_t values[HX711_DELTA_MAX_CHIPS];
+            size_t used = 0;
+            const bool ok = f != 1 &&
+                hx711_delta_decode(&dec, &out[pos], total - pos, values, &used);
+
+            if(ok != (f == 0 || f == resync)) {
+                fprintf(stderr, "frame %zu %s after a lost frame\n",
+                    f, ok ? "decoded" : "not decoded");
+                return 1;
+            }
+
+            pos += lens[f];
+
+        }
+
+        if(hx711_delta_dec_get_gaps(&dec) != 1) {
+            fprintf(stderr, "gap not counted\n");
+            return 1;
+        }
+
+    }
+
+    const size_t samples = frames * chips;
+    const size_t packed = samples * 3;
+
+    printf("frames:              %zu x %zu chips\n", frames, chips);
+    printf("resync interval:     %" PRIu32 "\n", resync);
+    printf("packed 24 bit:       %zu bytes\n", packed);
+    printf("delta/varint:        %zu bytes (%.2f bytes per value)\n",
+        total, (double)total / samples);
+    printf("compression ratio:   %.2f:1\n", (double)packed / total);
+    printf("encode per value:    %.2f ns\n", elapsed * 1e9 / samples);
+#ifdef HAVE_RDTSC
+    printf("encode cycles/value: %.2f (TSC)\n", (double)cycles / samples);
+#endif
+
+    free(lens);
+    free(out);
+    free(data);
+
+    return 0;
+
+}
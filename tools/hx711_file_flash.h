@@ -0,0 +1,122 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * File-backed stand-in for hx711_flash_t, shared by the
+ * host-side tools. The file holds an image of the device
+ * from offset 0 and behaves like NOR flash: erase fills a
+ * sector with HX711_FLASH_ERASED_BYTE and programming can
+ * only clear bits.
+ */
+
+#ifndef HX711_FILE_FLASH_H_8CEA9585_C307_4519_94E1_703755A6BAF0
+#define HX711_FILE_FLASH_H_8CEA9585_C307_4519_94E1_703755A6BAF0
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/hx711_flash.h"
+
+typedef struct {
+    FILE* fp;
+    size_t sector_size;
+} file_flash_t;
+
+static bool file_read(
+    void* ctx,
+    size_t offset,
+    void* buf,
+    size_t len) {
+
+        file_flash_t* const ff = (file_flash_t*)ctx;
+
+        if(fseek(ff->fp, (long)offset, SEEK_SET) != 0) {
+            return false;
+        }
+
+        return fread(buf, 1, len, ff->fp) == len;
+
+}
+
+static bool file_erase(
+    void* ctx,
+    size_t offset) {
+
+        file_flash_t* const ff = (file_flash_t*)ctx;
+        uint8_t* const buf = malloc(ff->sector_size);
+        bool ok;
+
+        if(buf == NULL) {
+            return false;
+        }
+
+        memset(buf, HX711_FLASH_ERASED_BYTE, ff->sector_size);
+
+        ok = fseek(ff->fp, (long)offset, SEEK_SET) == 0 &&
+            fwrite(buf, 1, ff->sector_size, ff->fp) == ff->sector_size &&
+            fflush(ff->fp) == 0;
+
+        free(buf);
+        return ok;
+
+}
+
+static bool file_program(
+    void* ctx,
+    size_t offset,
+    const void* buf,
+    size_t len) {
+
+        file_flash_t* const ff = (file_flash_t*)ctx;
+        const uint8_t* const src = (const uint8_t*)buf;
+        uint8_t b;
+
+        //NOR flash can only clear bits
+        for(size_t i = 0; i < len; ++i) {
+            if(!file_read(ctx, offset + i, &b, 1)) {
+                return false;
+            }
+            b &= src[i];
+            if(fseek(ff->fp, (long)(offset + i), SEEK_SET) != 0 ||
+                fwrite(&b, 1, 1, ff->fp) != 1) {
+                    return false;
+            }
+        }
+
+        return fflush(ff->fp) == 0;
+
+}
+
+static void file_flash_init(
+    file_flash_t* const ff,
+    hx711_flash_t* const flash) {
+        flash->sector_size = ff->sector_size;
+        flash->ctx = ff;
+        flash->read = file_read;
+        flash->erase = file_erase;
+        flash->program = file_program;
+}
+
+#endif
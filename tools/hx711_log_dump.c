@@ -0,0 +1,311 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side tool for sample logs, backed by a file which
+ * stands in for the log's flash region. It reads back an
+ * image saved from a device (eg. with picotool save -r, using
+ * the same offset into the file as into flash) or exercises
+ * the log without hardware.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_log_dump tools/hx711_log_dump.c \
+ *      src/hx711_log.c src/hx711_delta.c src/hx711_crc.c
+ * 
+ * Usage:
+ *  hx711_log_dump [-s sector_size] [-o offset] [-n sectors] file dump
+ *  hx711_log_dump [-s sector_size] [-o offset] [-n sectors] file frames chips
+ *  hx711_log_dump [-s sector_size] [-o offset] [-n sectors] file fill count
+ * 
+ * dump prints every record in hex, oldest first, with the
+ * sequence number of its page. frames decodes records written
+ * by hx711_delta_encode for chips chips, one line per frame.
+ * fill appends count numbered test records, erasing ahead
+ * and reopening the log every so often as a device would
+ * while idle and after a restart, then
+ * checks the records read back are the newest ones, in order
+ * and without gaps. The file is created (erased) if it does
+ * not exist. The defaults are 4096 byte sectors, offset 0 and
+ * 4 sectors.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/hx711_delta.h"
+#include "../include/hx711_flash.h"
+#include "../include/hx711_log.h"
+#include "hx711_file_flash.h"
+
+static void usage(const char* const name) {
+    fprintf(stderr,
+        "usage: %s [-s sector_size] [-o offset] [-n sectors] file dump|frames|fill ...\n",
+        name);
+}
+
+static int dump(const hx711_log_t* const log) {
+
+    hx711_log_reader_t r;
+    uint8_t buf[HX711_LOG_MAX_RECORD_LEN];
+    size_t len;
+
+    hx711_log_reader_init(&r, log);
+
+    while(hx711_log_reader_next(&r, buf, &len)) {
+        printf("%" PRIu32 ":", hx711_log_reader_get_seq(&r));
+        for(size_t i = 0; i < len; ++i) {
+            printf(" %02x", buf[i]);
+        }
+        putchar('\n');
+    }
+
+    return EXIT_SUCCESS;
+
+}
+
+static int frames(
+    const hx711_log_t* const log,
+    const size_t chips) {
+
+        if(chips == 0 || chips > HX711_DELTA_MAX_CHIPS) {
+            fprintf(stderr, "chips must be 1 to %u\n", (unsigned)HX711_DELTA_MAX_CHIPS);
+            return EXIT_FAILURE;
+        }
+
+        hx711_log_reader_t r;
+        hx711_delta_dec_t dec;
+        uint8_t buf[HX711_LOG_MAX_RECORD_LEN];
+        int32_t values[HX711_DELTA_MAX_CHIPS];
+        size_t len;
+        size_t used;
+        unsigned long skipped = 0;
+
+        hx711_log_reader_init(&r, log);
+        hx711_delta_dec_init(&dec, chips);
+
+        while(hx711_log_reader_next(&r, buf, &len)) {
+
+            if(!hx711_delta_decode(&dec, buf, len, values, &used) || used != len) {
+                //before the first key frame, or not a frame
+                ++skipped;
+                continue;
+            }
+
+            for(size_t i = 0; i < chips; ++i) {
+                printf(i == 0 ? "%" PRId32 : " %" PRId32, values[i]);
+            }
+            putchar('\n');
+
+        }
+
+        fprintf(stderr, "%lu records skipped, %" PRIu32 " sequence gaps\n",
+            skipped, hx711_delta_dec_get_gaps(&dec));
+
+        return EXIT_SUCCESS;
+
+}
+
+static int fill(
+    hx711_log_t* const log,
+    hx711_flash_t* const flash,
+    const size_t offset,
+    const size_t sectors,
+    const unsigned long count) {
+
+        uint8_t rec[HX711_LOG_MAX_RECORD_LEN];
+
+        //carry on numbering from an earlier fill
+        uint32_t first = 0;
+        hx711_log_reader_t r;
+        size_t len;
+
+        hx711_log_reader_init(&r, log);
+
+        while(hx711_log_reader_next(&r, rec, &len)) {
+            if(len >= 4) {
+                memcpy(&first, rec, 4);
+                ++first;
+            }
+        }
+
+        const uint32_t last = first + (uint32_t)count;
+
+        for(uint32_t n = first; n < last; ++n) {
+
+            //varying lengths so records pack pages unevenly
+            len = 4 + n % 29;
+
+            memcpy(rec, &n, 4);
+            memset(&rec[4], (int)(n & 0xff), len - 4);
+
+            if(!hx711_log_append(log, rec, len)) {
+                fprintf(stderr, "append failed at record %" PRIu32 "\n", n);
+                return EXIT_FAILURE;
+            }
+
+            //as a device would while acquisition is idle
+            if(n % 331 == 0 && !hx711_log_erase_ahead(log)) {
+                fprintf(stderr, "erase ahead failed at record %" PRIu32 "\n", n);
+                return EXIT_FAILURE;
+            }
+
+            if(n % 997 == 0) {
+                if(!hx711_log_flush(log) ||
+                    !hx711_log_init(log, flash, offset, sectors)) {
+                        fprintf(stderr, "reopen failed at record %" PRIu32 "\n", n);
+                        return EXIT_FAILURE;
+                }
+            }
+
+        }
+
+        if(!hx711_log_flush(log) ||
+            !hx711_log_init(log, flash, offset, sectors)) {
+                fprintf(stderr, "reopen failed\n");
+                return EXIT_FAILURE;
+        }
+
+        bool started = false;
+        uint32_t expected = 0;
+        unsigned long read = 0;
+
+        hx711_log_reader_init(&r, log);
+
+        while(hx711_log_reader_next(&r, rec, &len)) {
+
+            uint32_t n;
+            memcpy(&n, rec, 4);
+
+            if((started && n != expected) || len != 4 + n % 29) {
+                fprintf(stderr, "expected record %" PRIu32 ", got %" PRIu32 "\n", expected, n);
+                return EXIT_FAILURE;
+            }
+
+            for(size_t i = 4; i < len; ++i) {
+                if(rec[i] != (n & 0xff)) {
+                    fprintf(stderr, "record %" PRIu32 " corrupt\n", n);
+                    return EXIT_FAILURE;
+                }
+            }
+
+            started = true;
+            expected = n + 1;
+            ++read;
+
+        }
+
+        if(expected != last) {
+            fprintf(stderr, "newest record %" PRIu32 ", expected %" PRIu32 "\n", expected - 1, last - 1);
+            return EXIT_FAILURE;
+        }
+
+        printf("%lu records written, newest %lu read back\n", count, read);
+
+        return EXIT_SUCCESS;
+
+}
+
+int main(int argc, char** argv) {
+
+    file_flash_t ff = { .fp = NULL, .sector_size = 4096 };
+    hx711_flash_t flash;
+    hx711_log_t log;
+    size_t offset = 0;
+    size_t sectors = 4;
+    int opt;
+    int ret = EXIT_SUCCESS;
+
+    while((opt = getopt(argc, argv, "s:o:n:")) != -1) {
+        switch(opt) {
+            case 's':
+                ff.sector_size = strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                offset = strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                sectors = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if(argc - optind < 2 ||
+        sectors < 2 ||
+        ff.sector_size == 0 ||
+        ff.sector_size % HX711_LOG_PAGE_LEN != 0 ||
+        offset % ff.sector_size != 0) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+    }
+
+    const char* const path = argv[optind];
+    const char* const cmd = argv[optind + 1];
+    char** const args = &argv[optind + 2];
+    const int nargs = argc - optind - 2;
+
+    file_flash_init(&ff, &flash);
+
+    if((ff.fp = fopen(path, "r+b")) == NULL) {
+        bool ok = (ff.fp = fopen(path, "w+b")) != NULL;
+        for(size_t s = 0; ok && s < sectors; ++s) {
+            ok = file_erase(&ff, offset + s * ff.sector_size);
+        }
+        if(!ok) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(!hx711_log_init(&log, &flash, offset, sectors)) {
+        fprintf(stderr, "%s: unable to read log\n", path);
+        fclose(ff.fp);
+        return EXIT_FAILURE;
+    }
+
+    if(strcmp(cmd, "dump") == 0 && nargs == 0) {
+        ret = dump(&log);
+    }
+    else if(strcmp(cmd, "frames") == 0 && nargs == 1) {
+        ret = frames(&log, strtoul(args[0], NULL, 0));
+    }
+    else if(strcmp(cmd, "fill") == 0 && nargs == 1) {
+        ret = fill(&log, &flash, offset, sectors, strtoul(args[0], NULL, 0));
+    }
+    else {
+        usage(argv[0]);
+        ret = EXIT_FAILURE;
+    }
+
+    fclose(ff.fp);
+    return ret;
+
+}
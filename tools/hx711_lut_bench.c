@@ -0,0 +1,168 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side benchmark for correction tables. It models a cell
+ * with a few hundred ppm of curvature, builds a table from
+ * evenly spaced calibration points, then reports the worst
+ * error left over against the model and the time (and, on
+ * x86, cycles) taken per corrected value.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_lut_bench tools/hx711_lut_bench.c \
+ *      src/hx711_lut.c -lm
+ * 
+ * Usage:
+ *  hx711_lut_bench [points] [curvature_ppm] [samples]
+ * 
+ * Defaults are 9 points, 300ppm and 10000000 samples. The
+ * figures are for the host; expect the same order of
+ * operations, not the same cost, on an RP2040.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/hx711_lut.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define HAVE_RDTSC 1
+#endif
+
+//full scale of the modelled cell, in counts
+#define FULL_SCALE 8000000
+
+/**
+ * @brief What the cell reads for a true value: a quadratic
+ * bow which is zero at both ends and peaks mid-scale.
+ */
+static int32_t model(
+    const int32_t truth,
+    const double ppm) {
+        const double t = (double)truth / FULL_SCALE;
+        return (int32_t)lround(truth + ppm * 1e-6 * FULL_SCALE * 4 * t * (1 - t));
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+
+    const size_t points_len = argc > 1 ? (size_t)strtoul(argv[1], NULL, 0) : 9;
+    const double ppm = argc > 2 ? strtod(argv[2], NULL) : 300;
+    const size_t samples = argc > 3 ? (size_t)strtoul(argv[3], NULL, 0) : 10000000;
+
+    if(points_len < 2 || points_len > HX711_LUT_MAX_POINTS || samples == 0) {
+        fprintf(stderr,
+            "usage: %s [points (2-%u)] [curvature_ppm] [samples]\n",
+            argv[0],
+            (unsigned)HX711_LUT_MAX_POINTS);
+        return 1;
+    }
+
+    hx711_lut_point_t points[HX711_LUT_MAX_POINTS];
+
+    for(size_t i = 0; i < points_len; ++i) {
+        const int32_t truth = (int32_t)((int64_t)FULL_SCALE * i / (points_len - 1));
+        points[i].raw = model(truth, ppm);
+        points[i].value = truth;
+    }
+
+    hx711_lut_t lut;
+
+    if(!hx711_lut_init(&lut, points, points_len)) {
+        fprintf(stderr, "could not build table\n");
+        return 1;
+    }
+
+    //accuracy over the whole range, uncorrected and corrected
+    int32_t worst_raw = 0;
+    int32_t worst_lut = 0;
+
+    for(int32_t truth = 0; truth <= FULL_SCALE; truth += 97) {
+        const int32_t raw = model(truth, ppm);
+        const int32_t err_raw = abs(raw - truth);
+        const int32_t err_lut = abs(hx711_lut_apply(&lut, raw) - truth);
+        worst_raw = err_raw > worst_raw ? err_raw : worst_raw;
+        worst_lut = err_lut > worst_lut ? err_lut : worst_lut;
+    }
+
+    //speed, over pseudo-random inputs so the search is not
+    //trivially predicted
+    int32_t* const inputs = malloc(4096 * sizeof(int32_t));
+    uint32_t seed = 1;
+    int64_t sink = 0;
+
+    if(inputs == NULL) {
+        return 1;
+    }
+
+    for(size_t i = 0; i < 4096; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        inputs[i] = (int32_t)(seed % (FULL_SCALE + 1));
+    }
+
+    const double start = now_s();
+#ifdef HAVE_RDTSC
+    const uint64_t startCycles = __rdtsc();
+#endif
+
+    for(size_t i = 0; i < samples; ++i) {
+        sink += hx711_lut_apply(&lut, inputs[i & 4095]);
+    }
+
+#ifdef HAVE_RDTSC
+    const uint64_t cycles = __rdtsc() - startCycles;
+#endif
+    const double elapsed = now_s() - start;
+
+    printf("points:              %zu\n", points_len);
+    printf("curvature:           %g ppm\n", ppm);
+    printf("worst error raw:     %" PRId32 " counts (%.1f ppm of full scale)\n",
+        worst_raw, worst_raw * 1e6 / FULL_SCALE);
+    printf("worst error lut:     %" PRId32 " counts (%.1f ppm of full scale)\n",
+        worst_lut, worst_lut * 1e6 / FULL_SCALE);
+    printf("time per sample:     %.2f ns\n", elapsed * 1e9 / samples);
+#ifdef HAVE_RDTSC
+    printf("cycles per sample:   %.2f (TSC)\n", (double)cycles / samples);
+#endif
+
+    //stop the loop being optimised away
+    if(sink == 42) {
+        putchar('\n');
+    }
+
+    free(inputs);
+
+    return 0;
+
+}
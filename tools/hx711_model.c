@@ -0,0 +1,330 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/hx711_decode.h"
+#include "hx711_model.h"
+
+static int32_t hx711_model__clamp(const int64_t val) {
+    if(val < HX711_DECODE_MIN_VALUE) {
+        return HX711_DECODE_MIN_VALUE;
+    }
+    if(val > HX711_DECODE_MAX_VALUE) {
+        return HX711_DECODE_MAX_VALUE;
+    }
+    return (int32_t)val;
+}
+
+static uint32_t hx711_model__rand(hx711_model_t* const m) {
+    //xorshift32
+    uint32_t x = m->_rand;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return m->_rand = x;
+}
+
+static hx711_model_gain_t hx711_model__pulses_to_gain(const uint8_t pulses) {
+    switch(pulses) {
+        case 25: return hx711_model_gain_128;
+        case 26: return hx711_model_gain_32;
+        default: return hx711_model_gain_64;
+    }
+}
+
+static void hx711_model__convert(hx711_model_t* const m) {
+
+    ++m->_conversions;
+
+    if(m->_pulses > 0 && m->_pulses < HX711_MODEL_READ_BITS + 1) {
+
+        //a read is part way through. If the clock has been
+        //idle for a whole period it was abandoned, otherwise
+        //this conversion is lost and the read carries on with
+        //the old data
+        if(m->_clock || m->_now - m->_clock_edge < m->_cfg.period_ns) {
+            ++m->_collisions;
+            return;
+        }
+
+        ++m->_short_reads;
+        m->_pulses = 0;
+
+    }
+
+    if(m->_pulses > HX711_MODEL_READ_BITS) {
+        m->_gain = hx711_model__pulses_to_gain(m->_pulses);
+        m->_pulses = 0;
+    }
+
+    if(m->_ready) {
+        ++m->_overwritten;
+    }
+
+    int64_t val = hx711_model_get_expected(m, m->_gain);
+
+    if(m->_cfg.noise > 0) {
+        val += (int64_t)(hx711_model__rand(m) % (2 * (uint64_t)m->_cfg.noise + 1)) -
+            m->_cfg.noise;
+    }
+
+    m->_data = (uint32_t)hx711_model__clamp(val) & UINT32_C(0xffffff);
+    m->_ready = true;
+
+}
+
+void hx711_model_get_default_config(
+    hx711_model_config_t* const cfg,
+    const unsigned sps) {
+
+        assert(cfg != NULL);
+        assert(sps == 10 || sps == 80);
+
+        cfg->period_ns = UINT64_C(1000000000) / sps;
+        cfg->phase_ns = 0;
+        cfg->settling_ns = sps == 10 ? UINT64_C(400000000) : UINT64_C(50000000);
+        cfg->input_a = 0;
+        cfg->input_b = 0;
+        cfg->noise = 0;
+        cfg->seed = 1;
+
+}
+
+void hx711_model_init(
+    hx711_model_t* const m,
+    const hx711_model_config_t* const cfg) {
+
+        assert(m != NULL);
+        assert(cfg != NULL);
+        assert(cfg->period_ns > 0);
+
+        m->_cfg = *cfg;
+
+        m->_now = 0;
+        m->_next_conv = cfg->phase_ns;
+        m->_clock_high_since = 0;
+        m->_clock_edge = 0;
+        m->_rand = cfg->seed != 0 ? cfg->seed : 1;
+
+        m->_data = 0;
+        m->_pulses = 0;
+
+        m->_gain = hx711_model_gain_128;
+        m->_clock = false;
+        m->_powered = true;
+        m->_ready = false;
+
+        m->_conversions = 0;
+        m->_overwritten = 0;
+        m->_collisions = 0;
+        m->_reads = 0;
+        m->_short_reads = 0;
+        m->_extra_pulses = 0;
+        m->_power_downs = 0;
+
+}
+
+void hx711_model_set_input(
+    hx711_model_t* const m,
+    const int32_t input_a,
+    const int32_t input_b) {
+        assert(m != NULL);
+        m->_cfg.input_a = input_a;
+        m->_cfg.input_b = input_b;
+}
+
+void hx711_model_advance(
+    hx711_model_t* const m,
+    const uint64_t t) {
+
+        assert(m != NULL);
+        assert(t >= m->_now);
+
+        if(!m->_powered) {
+            m->_now = t;
+            return;
+        }
+
+        const uint64_t deadline = m->_clock_high_since +
+            HX711_MODEL_POWER_DOWN_US * 1000;
+        const bool power_down = m->_clock && t > deadline;
+        const uint64_t limit = power_down ? deadline : t;
+
+        while(m->_next_conv <= limit) {
+            m->_now = m->_next_conv;
+            hx711_model__convert(m);
+            m->_next_conv += m->_cfg.period_ns;
+        }
+
+        if(power_down) {
+            m->_powered = false;
+            m->_ready = false;
+            m->_pulses = 0;
+            ++m->_power_downs;
+        }
+
+        m->_now = t;
+
+}
+
+void hx711_model_set_clock(
+    hx711_model_t* const m,
+    const uint64_t t,
+    const bool high) {
+
+        hx711_model_advance(m, t);
+
+        if(high == m->_clock) {
+            return;
+        }
+
+        m->_clock = high;
+        m->_clock_edge = t;
+
+        if(!high) {
+
+            //a falling edge while powered down resets the chip
+            if(!m->_powered) {
+                m->_powered = true;
+                m->_gain = hx711_model_gain_128;
+                m->_pulses = 0;
+                m->_ready = false;
+                m->_next_conv = t + m->_cfg.settling_ns;
+            }
+
+            return;
+
+        }
+
+        m->_clock_high_since = t;
+
+        //pulses are only counted from the start of a read
+        if(!m->_ready && m->_pulses == 0) {
+            return;
+        }
+
+        if(m->_pulses == UINT8_MAX) {
+            ++m->_extra_pulses;
+            return;
+        }
+
+        ++m->_pulses;
+
+        if(m->_pulses == HX711_MODEL_READ_BITS + 1) {
+            m->_ready = false;
+            ++m->_reads;
+        }
+        else if(m->_pulses > HX711_MODEL_READ_BITS + 3) {
+            ++m->_extra_pulses;
+        }
+
+}
+
+bool hx711_model_get_dout(const hx711_model_t* const m) {
+
+    assert(m != NULL);
+
+    if(!m->_powered) {
+        return true;
+    }
+
+    if(m->_pulses > 0 && m->_pulses <= HX711_MODEL_READ_BITS) {
+        return (m->_data >> (HX711_MODEL_READ_BITS - m->_pulses)) & 1;
+    }
+
+    return !m->_ready;
+
+}
+
+bool hx711_model_is_powered(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_powered;
+}
+
+hx711_model_gain_t hx711_model_get_gain(const hx711_model_t* const m) {
+    assert(m != NULL);
+    if(m->_pulses > HX711_MODEL_READ_BITS) {
+        return hx711_model__pulses_to_gain(m->_pulses);
+    }
+    return m->_gain;
+}
+
+uint64_t hx711_model_get_next_conversion(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_powered ? m->_next_conv : UINT64_MAX;
+}
+
+int32_t hx711_model_get_expected(
+    const hx711_model_t* const m,
+    const hx711_model_gain_t gain) {
+
+        assert(m != NULL);
+
+        switch(gain) {
+            case hx711_model_gain_32:
+                return hx711_model__clamp(m->_cfg.input_b);
+            case hx711_model_gain_64:
+                return hx711_model__clamp(m->_cfg.input_a / 2);
+            case hx711_model_gain_128:
+            default:
+                return hx711_model__clamp(m->_cfg.input_a);
+        }
+
+}
+
+uint32_t hx711_model_get_conversions(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_conversions;
+}
+
+uint32_t hx711_model_get_overwritten(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_overwritten;
+}
+
+uint32_t hx711_model_get_collisions(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_collisions;
+}
+
+uint32_t hx711_model_get_reads(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_reads;
+}
+
+uint32_t hx711_model_get_short_reads(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_short_reads;
+}
+
+uint32_t hx711_model_get_extra_pulses(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_extra_pulses;
+}
+
+uint32_t hx711_model_get_power_downs(const hx711_model_t* const m) {
+    assert(m != NULL);
+    return m->_power_downs;
+}
@@ -0,0 +1,280 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Behavioural model of an HX711 for host-side tests and
+ * tools. It follows the datasheet as far as a driver can see
+ * it through PD_SCK and DOUT:
+ * 
+ *  - a conversion completes every period, offset by phase;
+ *    DOUT goes low and stays low until the data is read
+ * 
+ *  - each rising edge of PD_SCK shifts out the next bit, most
+ *    significant first; pulse 25 sends DOUT high again and
+ *    25, 26 or 27 pulses select channel A/128, B/32 or A/64
+ *    for the next conversion
+ * 
+ *  - PD_SCK held high for more than HX711_MODEL_POWER_DOWN_US
+ *    powers the chip down; on returning low it resets to
+ *    channel A/128 and the first conversion comes after the
+ *    settling time
+ * 
+ * Time is in nanoseconds and must not go backwards. Nothing
+ * here depends on the Pico SDK.
+ */
+
+#ifndef HX711_MODEL_H_CFC9BFB7_CC24_4FED_97F6_5EAE9EB8C6B6
+#define HX711_MODEL_H_CFC9BFB7_CC24_4FED_97F6_5EAE9EB8C6B6
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Same as HX711_POWER_DOWN_TIMEOUT.
+ */
+#define HX711_MODEL_POWER_DOWN_US       UINT64_C(60)
+
+#define HX711_MODEL_READ_BITS           UINT8_C(24)
+
+/**
+ * @brief Same order as hx711_gain_t.
+ */
+typedef enum {
+    hx711_model_gain_128 = 0,
+    hx711_model_gain_32,
+    hx711_model_gain_64
+} hx711_model_gain_t;
+
+typedef struct {
+
+    /**
+     * @brief Time between conversions, eg. 12.5ms at 80 SPS.
+     */
+    uint64_t period_ns;
+
+    /**
+     * @brief When the first conversion completes after time 0.
+     * Different phases for each chip model chips which are
+     * not synchronised.
+     */
+    uint64_t phase_ns;
+
+    /**
+     * @brief Time from powering up to the first conversion,
+     * eg. 400ms at 10 SPS, 50ms at 80 SPS.
+     */
+    uint64_t settling_ns;
+
+    /**
+     * @brief Channel A input, in counts at gain 128. Gain 64
+     * gives half of it.
+     */
+    int32_t input_a;
+
+    /**
+     * @brief Channel B input, in counts at gain 32.
+     */
+    int32_t input_b;
+
+    /**
+     * @brief Uniform noise of +/- noise counts added to each
+     * conversion.
+     */
+    uint32_t noise;
+
+    uint32_t seed;
+
+} hx711_model_config_t;
+
+typedef struct {
+
+    hx711_model_config_t _cfg;
+
+    uint64_t _now;
+    uint64_t _next_conv;
+    uint64_t _clock_high_since;
+    uint64_t _clock_edge;
+    uint32_t _rand;
+
+    uint32_t _data;
+    uint8_t _pulses;
+
+    hx711_model_gain_t _gain;
+    bool _clock;
+    bool _powered;
+    bool _ready;
+
+    uint32_t _conversions;
+    uint32_t _overwritten;
+    uint32_t _collisions;
+    uint32_t _reads;
+    uint32_t _short_reads;
+    uint32_t _extra_pulses;
+    uint32_t _power_downs;
+
+} hx711_model_t;
+
+/**
+ * @brief Fills cfg for a chip at the given rate (10 or 80)
+ * with no noise and a phase of 0.
+ * 
+ * @param cfg 
+ * @param sps 
+ */
+void hx711_model_get_default_config(
+    hx711_model_config_t* const cfg,
+    const unsigned sps);
+
+/**
+ * @brief Powers up the model at time 0 with PD_SCK low and
+ * channel A/128 selected. The first conversion completes at
+ * cfg->phase_ns.
+ * 
+ * @param m 
+ * @param cfg 
+ */
+void hx711_model_init(
+    hx711_model_t* const m,
+    const hx711_model_config_t* const cfg);
+
+/**
+ * @brief Changes the inputs from the next conversion.
+ * 
+ * @param m 
+ * @param input_a 
+ * @param input_b 
+ */
+void hx711_model_set_input(
+    hx711_model_t* const m,
+    const int32_t input_a,
+    const int32_t input_b);
+
+/**
+ * @brief Moves the model on to time t, completing any
+ * conversions and powering down if PD_SCK has been high too
+ * long.
+ * 
+ * @param m 
+ * @param t 
+ */
+void hx711_model_advance(
+    hx711_model_t* const m,
+    const uint64_t t);
+
+/**
+ * @brief Moves the model on to time t and sets PD_SCK.
+ * 
+ * @param m 
+ * @param t 
+ * @param high 
+ */
+void hx711_model_set_clock(
+    hx711_model_t* const m,
+    const uint64_t t,
+    const bool high);
+
+/**
+ * @brief Level of DOUT at the current time. Low means a
+ * conversion is ready, or the current bit is 0.
+ * 
+ * @param m 
+ * @return true 
+ * @return false 
+ */
+bool hx711_model_get_dout(const hx711_model_t* const m);
+
+bool hx711_model_is_powered(const hx711_model_t* const m);
+
+/**
+ * @brief Gain that will be used for the next conversion.
+ * 
+ * @param m 
+ * @return hx711_model_gain_t 
+ */
+hx711_model_gain_t hx711_model_get_gain(const hx711_model_t* const m);
+
+/**
+ * @brief When the next conversion completes, or UINT64_MAX
+ * while powered down.
+ * 
+ * @param m 
+ * @return uint64_t 
+ */
+uint64_t hx711_model_get_next_conversion(const hx711_model_t* const m);
+
+/**
+ * @brief The 24 bit value the model would produce for the
+ * given gain with no noise, to check against what was read.
+ * 
+ * @param m 
+ * @param gain 
+ * @return int32_t 
+ */
+int32_t hx711_model_get_expected(
+    const hx711_model_t* const m,
+    const hx711_model_gain_t gain);
+
+/**
+ * @brief Conversions completed.
+ */
+uint32_t hx711_model_get_conversions(const hx711_model_t* const m);
+
+/**
+ * @brief Conversions replaced by a newer one before they were
+ * read.
+ */
+uint32_t hx711_model_get_overwritten(const hx711_model_t* const m);
+
+/**
+ * @brief Conversions lost because a read was in progress when
+ * they completed.
+ */
+uint32_t hx711_model_get_collisions(const hx711_model_t* const m);
+
+/**
+ * @brief Reads of 25 to 27 pulses.
+ */
+uint32_t hx711_model_get_reads(const hx711_model_t* const m);
+
+/**
+ * @brief Reads which stopped before the 25th pulse. The
+ * previous gain is kept.
+ */
+uint32_t hx711_model_get_short_reads(const hx711_model_t* const m);
+
+/**
+ * @brief Pulses beyond the 27th, which the datasheet does not
+ * allow.
+ */
+uint32_t hx711_model_get_extra_pulses(const hx711_model_t* const m);
+
+uint32_t hx711_model_get_power_downs(const hx711_model_t* const m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,556 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Runs hx711_model_t chips on a PC: check steps one model
+ * through power down, gain selection and conversion timing
+ * by hand, and run reads many chips end to end through the
+ * library's own hx711_multi_t.
+ * 
+ * run builds src/hx711_multi.c against tools/hx711_shim.h,
+ * which runs the real hx711_multi_awaiter and
+ * hx711_multi_reader PIO programs in simulated time, moves
+ * their frames by DMA and calls the driver's PIO and DMA IRQ
+ * handlers. Every chip shares the clock on GPIO 0 and has its
+ * data pin from GPIO 1 up. The RP2040 has 30 GPIOs, so at
+ * most 29 chips can be read this way, one fewer than
+ * HX711_MULTI_MAX_CHIPS; a board with 32 chips needs a second
+ * hx711_multi_t. Each value is checked against what its model
+ * was given, and the raw frames can be written out as a
+ * hx711_replay_rec_t recording to feed through
+ * tools/hx711_replay.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -Itools/shim -o hx711_model_sim \
+ *      tools/hx711_model_sim.c tools/hx711_model.c \
+ *      tools/hx711_shim.c src/common.c src/hx711_multi.c \
+ *      src/hx711.c src/hx711_alarm.c src/hx711_glitch.c \
+ *      src/hx711_notch.c src/hx711_stability.c src/util.c \
+ *      src/hx711_replay.c -lm
+ * 
+ * Usage:
+ *  hx711_model_sim check
+ *  hx711_model_sim [-r sps] [-g gain] [-n noise] [-p phase_us]
+ *      [-m mode] [-o file] run chips seconds
+ * 
+ *  -r  10 or 80 (default 80)
+ *  -g  0 = A/128, 1 = B/32, 2 = A/64, as hx711_gain_t
+ *  -n  +/- noise counts on every conversion
+ *  -p  spread the chips' phases over this many microseconds
+ *  -m  get (hx711_multi_get_values), async
+ *      (hx711_multi_async_start and a frame pool) or
+ *      continuous (hx711_multi_async_start_continuous, the
+ *      default)
+ *  -o  write a recording of the raw frames; not with -m get
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hx711_model.h"
+#include "hx711_shim.h"
+#include "../include/common.h"
+#include "../include/hx711_decode.h"
+#include "../include/hx711_multi.h"
+#include "../include/hx711_replay.h"
+
+#define CLOCK_PIN       0
+#define DATA_PIN_BASE   1
+
+//every data pin above the clock pin
+#define MAX_CHIPS       (NUM_BANK0_GPIOS - DATA_PIN_BASE)
+
+//hx711_multi_reader.pio T3 and T4
+#define T3_NS           200
+#define T4_NS           200
+
+static const uint8_t CLOCK_PULSES[] = { 25, 26, 27 };
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool file_write(
+    void* ctx,
+    const void* buf,
+    size_t len) {
+        return fwrite(buf, 1, len, (FILE*)ctx) == len;
+}
+
+static void set_clock(
+    hx711_model_t* const ms,
+    const size_t len,
+    const uint64_t t,
+    const bool high) {
+        for(size_t i = 0; i < len; ++i) {
+            hx711_model_set_clock(&ms[i], t, high);
+        }
+}
+
+/**
+ * @brief One read of len chips starting at *t: 24 data pulses,
+ * sampling every DOUT while the clock is high, then the rest
+ * of pulses. *t is left after the last pulse.
+ */
+static void read_frame(
+    hx711_model_t* const ms,
+    const size_t len,
+    uint64_t* const t,
+    const uint8_t pulses,
+    uint32_t* const pinvals) {
+
+        for(uint8_t p = 0; p < pulses; ++p) {
+
+            set_clock(ms, len, *t, true);
+            *t += T3_NS;
+
+            if(p < HX711_MODEL_READ_BITS) {
+                uint32_t word = 0;
+                for(size_t i = 0; i < len; ++i) {
+                    word |= (uint32_t)hx711_model_get_dout(&ms[i]) << i;
+                }
+                pinvals[p] = word;
+            }
+
+            set_clock(ms, len, *t, false);
+            *t += T4_NS;
+
+        }
+
+}
+
+static unsigned failures;
+
+static void expect(
+    const bool ok,
+    const char* const what) {
+        printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+        failures += !ok;
+}
+
+static int32_t read_one(
+    hx711_model_t* const m,
+    uint64_t* const t,
+    const uint8_t pulses) {
+        uint32_t pinvals[HX711_MODEL_READ_BITS];
+        int32_t val;
+        read_frame(m, 1, t, pulses, pinvals);
+        hx711_decode_pinvals(pinvals, &val, 1);
+        return val;
+}
+
+static int check(void) {
+
+    hx711_model_config_t cfg;
+    hx711_model_t m;
+    uint64_t t;
+
+    hx711_model_get_default_config(&cfg, 80);
+    cfg.phase_ns = 1000000;
+    cfg.input_a = -123456;
+    cfg.input_b = 4567;
+    hx711_model_init(&m, &cfg);
+
+    hx711_model_advance(&m, cfg.phase_ns - 1);
+    expect(hx711_model_get_dout(&m), "DOUT high before the first conversion");
+    hx711_model_advance(&m, cfg.phase_ns);
+    expect(!hx711_model_get_dout(&m), "DOUT low at the first conversion");
+
+    t = cfg.phase_ns + 1000;
+    expect(read_one(&m, &t, 25) == -123456, "25 pulses read channel A/128");
+    expect(hx711_model_get_dout(&m), "DOUT high after the 25th pulse");
+    expect(hx711_model_get_reads(&m) == 1, "one read counted");
+
+    //select B/32 for the next conversion
+    hx711_model_advance(&m, cfg.phase_ns + cfg.period_ns);
+    t = cfg.phase_ns + cfg.period_ns + 1000;
+    expect(read_one(&m, &t, 26) == -123456, "26 pulses still read the old gain");
+    expect(hx711_model_get_gain(&m) == hx711_model_gain_32, "26 pulses select B/32");
+
+    t = cfg.phase_ns + 2 * cfg.period_ns + 1000;
+    hx711_model_advance(&m, t);
+    expect(read_one(&m, &t, 27) == 4567, "next conversion is channel B");
+
+    t = cfg.phase_ns + 3 * cfg.period_ns + 1000;
+    hx711_model_advance(&m, t);
+    expect(read_one(&m, &t, 25) == -123456 / 2, "27 pulses select A/64");
+
+    //two conversions go unread
+    t = cfg.phase_ns + 5 * cfg.period_ns + 1000;
+    hx711_model_advance(&m, t);
+    expect(hx711_model_get_overwritten(&m) == 1, "an unread conversion is overwritten");
+    expect(read_one(&m, &t, 26) == -123456, "the newest conversion is read");
+
+    //59us high is not enough to power down
+    hx711_model_set_clock(&m, t, true);
+    hx711_model_set_clock(&m, t + 59000, false);
+    expect(hx711_model_is_powered(&m), "59us high keeps the chip powered");
+
+    //61us high is
+    t += 100000;
+    hx711_model_set_clock(&m, t, true);
+    hx711_model_advance(&m, t + 61000);
+    expect(!hx711_model_is_powered(&m), "61us high powers the chip down");
+    expect(hx711_model_get_dout(&m), "DOUT high while powered down");
+    expect(hx711_model_get_power_downs(&m) == 1, "one power down counted");
+
+    //a conversion while powered down does not happen
+    const uint32_t conversions = hx711_model_get_conversions(&m);
+    t += 100000000;
+    hx711_model_advance(&m, t);
+    expect(hx711_model_get_conversions(&m) == conversions, "no conversions while powered down");
+
+    hx711_model_set_clock(&m, t, false);
+    expect(hx711_model_is_powered(&m), "clock low powers the chip up");
+    expect(hx711_model_get_gain(&m) == hx711_model_gain_128, "power up resets to A/128");
+    expect(hx711_model_get_next_conversion(&m) == t + cfg.settling_ns,
+        "first conversion after the settling time");
+
+    hx711_model_advance(&m, t + cfg.settling_ns - 1);
+    expect(hx711_model_get_dout(&m), "DOUT high while settling");
+    t += cfg.settling_ns + 1000;
+    hx711_model_advance(&m, t);
+    expect(read_one(&m, &t, 25) == -123456, "A/128 after power up");
+
+    //power down part way through a read
+    t = hx711_model_get_next_conversion(&m) + 1000;
+    hx711_model_advance(&m, t);
+    hx711_model_set_clock(&m, t, true);
+    hx711_model_set_clock(&m, t + T3_NS, false);
+    t += 1000;
+    hx711_model_set_clock(&m, t, true);
+    hx711_model_advance(&m, t + 100000);
+    expect(!hx711_model_is_powered(&m), "power down during a read");
+    t += 100000;
+    hx711_model_set_clock(&m, t, false);
+    t += cfg.settling_ns;
+    hx711_model_advance(&m, t);
+    expect(read_one(&m, &t, 25) == -123456, "a full read after recovering");
+
+    //a read still going when the next conversion completes
+    //keeps the old data and loses the new one
+    hx711_model_set_input(&m, 1000, 0);
+    t = hx711_model_get_next_conversion(&m) + cfg.period_ns - 2000;
+    hx711_model_set_clock(&m, t, true);
+    hx711_model_set_clock(&m, t + T3_NS, false);
+    t += 4000;
+    hx711_model_advance(&m, t);
+    expect(hx711_model_get_collisions(&m) == 1, "a conversion during a read is lost");
+    expect(hx711_model_get_overwritten(&m) == 1, "and is not counted as overwritten");
+    uint32_t rest[HX711_MODEL_READ_BITS];
+    read_frame(&m, 1, &t, 24, rest);
+    expect(hx711_model_get_dout(&m), "the read completes");
+
+    t = hx711_model_get_next_conversion(&m) + 1000;
+    hx711_model_advance(&m, t);
+    expect(read_one(&m, &t, 25) == 1000, "the next conversion has the new input");
+
+    //values clamp to 24 bits
+    hx711_model_set_input(&m, INT32_MAX, INT32_MIN);
+    t = hx711_model_get_next_conversion(&m);
+    hx711_model_advance(&m, t);
+    t += 1000;
+    expect(read_one(&m, &t, 25) == 0x7fffff, "inputs clamp to the 24 bit range");
+
+    printf("%u failure(s)\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
+
+typedef enum {
+    RUN_MODE_GET,
+    RUN_MODE_ASYNC,
+    RUN_MODE_CONTINUOUS
+} run_mode_t;
+
+static const char* const RUN_MODE_NAMES[] = { "get", "async", "continuous" };
+
+typedef struct {
+    hx711_model_t* ms;
+    size_t chips;
+    uint32_t noise;
+    uint64_t end;
+    hx711_replay_rec_t* rec;
+    hx711_model_gain_t gain;
+    unsigned long frames;
+    unsigned long mismatches;
+    bool failed;
+} run_t;
+
+/**
+ * @brief Check one frame of values, and record its raw frame
+ * if frame is not NULL. Returns false once the run is over.
+ */
+static bool run_frame(
+    run_t* const r,
+    const uint32_t* const frame,
+    const int32_t* const values) {
+
+        for(size_t i = 0; i < r->chips; ++i) {
+            const int64_t diff = (int64_t)values[i] -
+                hx711_model_get_expected(&r->ms[i], r->gain);
+            r->mismatches += diff > (int64_t)r->noise || diff < -(int64_t)r->noise;
+        }
+
+        if(r->rec != NULL && frame != NULL &&
+            !hx711_replay_rec_frame(r->rec, time_us_32(), frame)) {
+                r->failed = true;
+                return false;
+        }
+
+        ++r->frames;
+
+        return hx711_shim_get_time_ns() < r->end;
+
+}
+
+static bool run_frame_cb(
+    hx711_multi_t* const hxm,
+    const uint32_t* const frame,
+    const int32_t* const values,
+    void* const ctx) {
+        (void)hxm;
+        return run_frame((run_t*)ctx, frame, values);
+}
+
+static int run(
+    const size_t chips,
+    const double seconds,
+    const unsigned sps,
+    const unsigned gain,
+    const uint32_t noise,
+    const uint64_t phase_us,
+    const run_mode_t mode,
+    const char* const path) {
+
+        if(chips == 0 || chips > MAX_CHIPS) {
+            fprintf(stderr, "chips must be 1 to %u: GPIO %u is the clock and the "
+                "RP2040 has %u GPIOs\n", MAX_CHIPS, CLOCK_PIN, NUM_BANK0_GPIOS);
+            return EXIT_FAILURE;
+        }
+
+        if((sps != 10 && sps != 80) || gain > 2) {
+            fprintf(stderr, "rate must be 10 or 80 and gain 0 to 2\n");
+            return EXIT_FAILURE;
+        }
+
+        if(mode == RUN_MODE_GET && path != NULL) {
+            fprintf(stderr, "hx711_multi_get_values does not give raw frames to record\n");
+            return EXIT_FAILURE;
+        }
+
+        static hx711_model_t ms[MAX_CHIPS];
+        hx711_model_config_t cfg;
+        hx711_replay_rec_t rec;
+        FILE* fp = NULL;
+
+        hx711_model_get_default_config(&cfg, sps);
+        cfg.noise = noise;
+
+        for(size_t i = 0; i < chips; ++i) {
+            cfg.phase_ns = cfg.settling_ns + phase_us * 1000 * i / chips;
+            cfg.input_a = 100000 * (int32_t)(i + 1) * (i % 2 ? -1 : 1);
+            cfg.input_b = cfg.input_a / 4;
+            cfg.seed = (uint32_t)i + 1;
+            hx711_model_init(&ms[i], &cfg);
+            hx711_shim_attach(&ms[i], CLOCK_PIN, DATA_PIN_BASE + (uint)i);
+        }
+
+        if(path != NULL) {
+            fp = fopen(path, "wb");
+            if(fp == NULL) {
+                perror(path);
+                return EXIT_FAILURE;
+            }
+            if(!hx711_replay_rec_init(&rec, HX711_REPLAY_KIND_MULTI, (uint8_t)chips, file_write, fp)) {
+                fclose(fp);
+                return EXIT_FAILURE;
+            }
+        }
+
+        hx711_multi_config_t hxmcfg;
+        hx711_multi_t hxm;
+
+        hx711_multi_get_default_config(&hxmcfg);
+        hxmcfg.clock_pin = CLOCK_PIN;
+        hxmcfg.data_pin_base = DATA_PIN_BASE;
+        hxmcfg.chips_len = chips;
+
+        hx711_multi_init(&hxm, &hxmcfg);
+
+        static hx711_multi_frame_t pool[2];
+        hx711_multi_set_frame_pool(&hxm, pool, 2);
+
+        run_t r = {
+            .ms = ms,
+            .chips = chips,
+            .noise = noise,
+            .end = (uint64_t)(seconds * 1e9),
+            .rec = fp != NULL ? &rec : NULL,
+            //the reader reads the first conversion at A/128
+            //and selects the gain, but the DMA only takes the
+            //conversion after the one which raised the IRQ
+            .gain = (hx711_model_gain_t)gain
+        };
+
+        int32_t values[MAX_CHIPS];
+
+        const double start = now_s();
+
+        hx711_multi_power_up(&hxm, (hx711_gain_t)gain);
+
+        switch(mode) {
+            case RUN_MODE_GET:
+                do {
+                    hx711_multi_get_values(&hxm, values);
+                } while(run_frame(&r, NULL, values));
+                break;
+
+            case RUN_MODE_ASYNC:
+                for(bool more = true; more;) {
+                    hx711_multi_async_start(&hxm);
+                    while(!hx711_multi_async_done(&hxm)) {
+                        tight_loop_contents();
+                    }
+                    const uint32_t* const frame = hx711_multi_async_take_frame(&hxm);
+                    hx711_multi_async_get_values(&hxm, values);
+                    more = run_frame(&r, frame, values);
+                    hx711_multi_release_frame(&hxm, frame);
+                }
+                break;
+
+            case RUN_MODE_CONTINUOUS:
+                hx711_multi_async_start_continuous(&hxm, run_frame_cb, &r);
+                while(!hx711_multi_async_done(&hxm)) {
+                    tight_loop_contents();
+                }
+                break;
+        }
+
+        const double elapsed = now_s() - start;
+        const double simulated = hx711_shim_get_time_ns() * 1e-9;
+
+        hx711_multi_power_down(&hxm);
+        hx711_multi_close(&hxm);
+        hx711_shim_sync_models();
+
+        unsigned long conversions = 0;
+        unsigned long overwritten = 0;
+        unsigned long collisions = 0;
+        unsigned long short_reads = 0;
+        unsigned long extra_pulses = 0;
+
+        for(size_t i = 0; i < chips; ++i) {
+            conversions += hx711_model_get_conversions(&ms[i]);
+            overwritten += hx711_model_get_overwritten(&ms[i]);
+            collisions += hx711_model_get_collisions(&ms[i]);
+            short_reads += hx711_model_get_short_reads(&ms[i]);
+            extra_pulses += hx711_model_get_extra_pulses(&ms[i]);
+        }
+
+        printf("chips:           %zu at %u SPS, %u clock pulses\n", chips, sps, CLOCK_PULSES[gain]);
+        printf("mode:            %s\n", RUN_MODE_NAMES[mode]);
+        printf("simulated:       %.3f s\n", simulated);
+        printf("frames:          %lu (%.2f per simulated second)\n", r.frames, r.frames / simulated);
+        printf("conversions:     %lu\n", conversions);
+        printf("overwritten:     %lu\n", overwritten);
+        printf("collisions:      %lu\n", collisions);
+        printf("short reads:     %lu\n", short_reads);
+        printf("extra pulses:    %lu\n", extra_pulses);
+        printf("mismatches:      %lu\n", r.mismatches);
+        printf("host frames/s:   %.0f\n", r.frames / elapsed);
+        printf("host x realtime: %.1f\n", simulated / elapsed);
+
+        if(fp != NULL && fclose(fp) != 0) {
+            return EXIT_FAILURE;
+        }
+
+        return !r.failed && r.mismatches == 0 && r.frames > 0 &&
+            collisions == 0 && short_reads == 0 && extra_pulses == 0 ?
+                EXIT_SUCCESS : EXIT_FAILURE;
+
+}
+
+int main(int argc, char** argv) {
+
+    unsigned sps = 80;
+    unsigned gain = 0;
+    uint32_t noise = 0;
+    uint64_t phase_us = 0;
+    run_mode_t mode = RUN_MODE_CONTINUOUS;
+    const char* path = NULL;
+    int opt;
+
+    while((opt = getopt(argc, argv, "r:g:n:p:m:o:")) != -1) {
+        switch(opt) {
+            case 'm':
+                for(mode = 0; mode < count_of(RUN_MODE_NAMES); ++mode) {
+                    if(strcmp(optarg, RUN_MODE_NAMES[mode]) == 0) {
+                        break;
+                    }
+                }
+                if(mode == count_of(RUN_MODE_NAMES)) {
+                    goto usage;
+                }
+                break;
+            case 'r': sps = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'g': gain = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'n': noise = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'p': phase_us = strtoull(optarg, NULL, 0); break;
+            case 'o': path = optarg; break;
+            default: goto usage;
+        }
+    }
+
+    if(optind < argc && strcmp(argv[optind], "check") == 0) {
+        return check();
+    }
+
+    if(optind + 3 == argc && strcmp(argv[optind], "run") == 0) {
+        return run(
+            strtoul(argv[optind + 1], NULL, 0),
+            strtod(argv[optind + 2], NULL),
+            sps,
+            gain,
+            noise,
+            phase_us,
+            mode,
+            path);
+    }
+
+usage:
+    fprintf(stderr,
+        "usage: %s check | [-r sps] [-g gain] [-n noise] [-p phase_us] [-m mode] [-o file] run chips seconds\n",
+        argv[0]);
+    return EXIT_FAILURE;
+
+}
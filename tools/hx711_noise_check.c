@@ -0,0 +1,339 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side check of the noise accumulator. Sequences of
+ * values are fed through hx711_noise_add and the report is
+ * compared with the same statistics computed in double
+ * precision from the stored values (two-pass mean and
+ * variance):
+ * 
+ *  noise           Gaussian noise at mid scale and at both
+ *                  ends of the 24 bit range
+ *  reference       a first value far from the rest, so every
+ *                  sum is taken relative to an outlier
+ *  constant        no noise gives zero variance and the full
+ *                  24 bits
+ *  multi           hx711_noise_add_multi matches
+ *                  hx711_noise_add chip by chip
+ *  short           fewer than 2 values gives no report
+ *  overflow        full scale swings stop accumulating before
+ *                  the sum of squares wraps, and the report
+ *                  still covers the values taken
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_noise_check tools/hx711_noise_check.c \
+ *      src/hx711_noise.c -lm
+ * 
+ * Usage:
+ *  hx711_noise_check
+ * 
+ * Exits with 0 if every check passes.
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/hx711_noise.h"
+
+#define PI              3.14159265358979323846
+
+#define MIN_VALUE       INT32_C(-0x800000)
+#define MAX_VALUE       INT32_C(0x7fffff)
+
+#define MAX_SAMPLES     200000
+#define CHIPS           4
+
+//report fields are floats
+#define REL_TOLERANCE   1e-5
+
+static unsigned failures = 0;
+
+static int32_t samples[MAX_SAMPLES];
+
+static uint32_t seed = 1;
+
+static void expect(
+    const bool ok,
+    const char* const fmt,
+    ...) {
+
+        va_list args;
+
+        va_start(args, fmt);
+        printf("%s  ", ok ? "ok  " : "FAIL");
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+
+        failures += !ok;
+
+}
+
+static double uniform(void) {
+    //xorshift32
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed + 0.5) / 4294967296.0;
+}
+
+static int32_t clamp(const double v) {
+    if(v < MIN_VALUE) {
+        return MIN_VALUE;
+    }
+    if(v > MAX_VALUE) {
+        return MAX_VALUE;
+    }
+    return (int32_t)lround(v);
+}
+
+static int32_t gaussian(
+    const double mean,
+    const double sd) {
+        //Box-Muller
+        const double r = sqrt(-2.0 * log(uniform()));
+        return clamp(mean + sd * r * cos(2.0 * PI * uniform()));
+}
+
+static bool near(
+    const double got,
+    const double want,
+    const double abs_tolerance) {
+        return fabs(got - want) <= abs_tolerance + fabs(want) * REL_TOLERANCE;
+}
+
+/**
+ * @brief Compare a report with the statistics of samples[0]
+ * to samples[len - 1] computed in double precision.
+ */
+static void check_report(
+    const char* const name,
+    const hx711_noise_report_t* const r,
+    const size_t len) {
+
+        double sum = 0;
+        int32_t min = INT32_MAX;
+        int32_t max = INT32_MIN;
+
+        for(size_t i = 0; i < len; ++i) {
+            sum += samples[i];
+            min = samples[i] < min ? samples[i] : min;
+            max = samples[i] > max ? samples[i] : max;
+        }
+
+        const double mean = sum / (double)len;
+        double ss = 0;
+
+        for(size_t i = 0; i < len; ++i) {
+            ss += (samples[i] - mean) * (samples[i] - mean);
+        }
+
+        const double variance = ss / (double)(len - 1);
+        const double rms = sqrt(variance);
+        const double p2p = (double)max - min;
+        const double ebits = rms > 0 ? fmin(log2(16777216.0 / rms), 24.0) : 24.0;
+        const double nfbits = p2p > 0 ? fmin(log2(16777216.0 / p2p), 24.0) : 24.0;
+
+        expect(r->count == len, "%s: count %u (want %zu)", name, r->count, len);
+        expect(r->min == min && r->max == max,
+            "%s: min %d max %d (want %d %d)", name, r->min, r->max, min, max);
+        expect(r->peak_to_peak == (uint32_t)p2p,
+            "%s: peak-to-peak %u (want %.0f)", name, r->peak_to_peak, p2p);
+        expect(near(r->mean, mean, 0.5),
+            "%s: mean %.3f (want %.3f)", name, r->mean, mean);
+        expect(near(r->variance, variance, 1e-3),
+            "%s: variance %.3f (want %.3f)", name, r->variance, variance);
+        expect(near(r->rms, rms, 1e-3),
+            "%s: rms %.4f (want %.4f)", name, r->rms, rms);
+        expect(near(r->effective_bits, ebits, 1e-4),
+            "%s: effective bits %.4f (want %.4f)", name, r->effective_bits, ebits);
+        expect(near(r->noise_free_bits, nfbits, 1e-4),
+            "%s: noise-free bits %.4f (want %.4f)", name, r->noise_free_bits, nfbits);
+
+}
+
+static void check_noise(
+    const char* const name,
+    const double mean,
+    const double sd,
+    const size_t len) {
+
+        hx711_noise_t n;
+        hx711_noise_report_t r;
+
+        hx711_noise_init(&n);
+
+        for(size_t i = 0; i < len; ++i) {
+            samples[i] = gaussian(mean, sd);
+            hx711_noise_add(&n, samples[i]);
+        }
+
+        expect(hx711_noise_get_report(&n, &r), "%s: report", name);
+        expect(!r.overflow, "%s: no overflow", name);
+        check_report(name, &r, len);
+
+}
+
+static void check_reference(void) {
+
+    hx711_noise_t n;
+    hx711_noise_report_t r;
+
+    hx711_noise_init(&n);
+
+    samples[0] = MIN_VALUE;
+    hx711_noise_add(&n, samples[0]);
+
+    for(size_t i = 1; i < 10000; ++i) {
+        samples[i] = gaussian(7000000.0, 40.0);
+        hx711_noise_add(&n, samples[i]);
+    }
+
+    hx711_noise_get_report(&n, &r);
+    check_report("outlying reference", &r, 10000);
+
+}
+
+static void check_constant(void) {
+
+    hx711_noise_t n;
+    hx711_noise_report_t r;
+
+    hx711_noise_init(&n);
+
+    for(size_t i = 0; i < 1000; ++i) {
+        samples[i] = -123456;
+        hx711_noise_add(&n, samples[i]);
+    }
+
+    hx711_noise_get_report(&n, &r);
+    check_report("constant", &r, 1000);
+    expect(r.variance == 0.0f && r.effective_bits == 24.0f && r.noise_free_bits == 24.0f,
+        "constant: zero variance and 24 bits");
+
+}
+
+static void check_multi(void) {
+
+    hx711_noise_t single[CHIPS];
+    hx711_noise_t multi[CHIPS];
+
+    for(size_t c = 0; c < CHIPS; ++c) {
+        hx711_noise_init(&single[c]);
+        hx711_noise_init(&multi[c]);
+    }
+
+    for(size_t i = 0; i < 5000; ++i) {
+        int32_t frame[CHIPS];
+        for(size_t c = 0; c < CHIPS; ++c) {
+            frame[c] = gaussian(100000.0 * (double)c, 10.0 + (double)c);
+            hx711_noise_add(&single[c], frame[c]);
+        }
+        hx711_noise_add_multi(multi, frame, CHIPS);
+    }
+
+    bool same = true;
+
+    for(size_t c = 0; c < CHIPS; ++c) {
+        hx711_noise_report_t a;
+        hx711_noise_report_t b;
+        hx711_noise_get_report(&single[c], &a);
+        hx711_noise_get_report(&multi[c], &b);
+        same = same &&
+            a.count == b.count &&
+            a.min == b.min &&
+            a.max == b.max &&
+            a.mean == b.mean &&
+            a.variance == b.variance;
+    }
+
+    expect(same, "add_multi matches add for %d chips", CHIPS);
+
+}
+
+static void check_short(void) {
+
+    hx711_noise_t n;
+    hx711_noise_report_t r;
+
+    hx711_noise_init(&n);
+    expect(!hx711_noise_get_report(&n, &r), "no values: no report");
+
+    hx711_noise_add(&n, 42);
+    expect(!hx711_noise_get_report(&n, &r), "one value: no report");
+
+    hx711_noise_add(&n, 44);
+    expect(hx711_noise_get_report(&n, &r) && r.variance == 2.0f,
+        "two values: variance 2");
+
+}
+
+static void check_overflow(void) {
+
+    hx711_noise_t n;
+    hx711_noise_report_t r;
+
+    hx711_noise_init(&n);
+
+    //relative to the first value, every other squared
+    //deviation is (2^24 - 1)^2, a little under 2^48, so the sum
+    //of squares fills after about 2^16 of them
+    size_t len = 0;
+
+    for(size_t i = 0; i < MAX_SAMPLES; ++i) {
+        const int32_t v = (i & 1) ? MAX_VALUE : MIN_VALUE;
+        hx711_noise_add(&n, v);
+        hx711_noise_get_report(&n, &r);
+        if(i > 0 && r.overflow) {
+            break;
+        }
+        samples[len++] = v;
+    }
+
+    expect(r.overflow, "full scale swings: overflow after %zu values", len);
+    expect(len > 130000, "full scale swings: at least 130000 values taken");
+    check_report("full scale swings", &r, len);
+
+}
+
+int main(void) {
+
+    check_noise("mid scale", 0.0, 250.0, MAX_SAMPLES);
+    check_noise("near full scale", 8388000.0, 60.0, MAX_SAMPLES);
+    check_noise("near negative full scale", -8388000.0, 60.0, MAX_SAMPLES);
+    check_noise("large noise", 1000000.0, 500000.0, MAX_SAMPLES);
+    check_reference();
+    check_constant();
+    check_multi();
+    check_short();
+    check_overflow();
+
+    printf("%u failure(s)\n", failures);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
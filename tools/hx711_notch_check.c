@@ -0,0 +1,403 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side check of the mains hum filters. Hum (at the
+ * nominal mains frequency and off it) and a load step are fed
+ * through hx711_notch_filter, and the output is compared with
+ * what the designed coefficients predict:
+ * 
+ *  coefficients    HX711_NOTCH_COEFFS_80 and
+ *                  hx711_notch_init_custom against the biquad
+ *                  design (Q = 2) in double precision
+ *  attenuation     the hum left in the output against the
+ *                  magnitude response of the scaled integer
+ *                  coefficients at the aliased frequency, and
+ *                  at least 60dB at the nominal frequency
+ *  step            the integer filter against the same biquad
+ *                  in double precision, sample by sample;
+ *                  settling within the time set by the pole
+ *                  radius; a DC gain of 1
+ *  comb            at 10 SPS, the 2.5Hz and 5Hz nulls and a
+ *                  step settling in HX711_NOTCH_COMB_LEN samples
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_notch_check tools/hx711_notch_check.c \
+ *      src/hx711_notch.c -lm
+ * 
+ * Usage:
+ *  hx711_notch_check
+ * 
+ * Exits with 0 if every check passes.
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/hx711_notch.h"
+
+#define PI              3.14159265358979323846
+#define Q               2.0
+
+//counts
+#define HUM_AMPLITUDE   100000
+#define STEP            1000000
+#define OFFSET          -250000
+#define SETTLE_COUNTS   2
+
+//seconds of hum to let the filter settle, then to measure
+#define HUM_SETTLE_S    5
+#define HUM_MEASURE_S   20
+
+#define MAX_SAMPLES     4096
+#define STEP_AT         10
+#define STEP_LEN        200
+
+static unsigned failures = 0;
+
+static void expect(
+    const bool ok,
+    const char* const fmt,
+    ...) {
+
+        va_list args;
+
+        va_start(args, fmt);
+        printf("%s  ", ok ? "ok  " : "FAIL");
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+
+        failures += !ok;
+
+}
+
+static double fold(
+    const double sps,
+    const double hum_hz) {
+
+        double alias = fmod(hum_hz, sps);
+
+        if(alias > sps / 2.0) {
+            alias = sps - alias;
+        }
+
+        return alias;
+
+}
+
+static double scaled(const int32_t c) {
+    return (double)c / (double)(UINT32_C(1) << HX711_NOTCH_COEFF_BITS);
+}
+
+/**
+ * @brief |H(e^jw)| of the scaled integer coefficients.
+ */
+static double magnitude(
+    const hx711_notch_coeffs_t* const c,
+    const double w) {
+
+        const double nr = scaled(c->b0) + scaled(c->b1) * cos(w) + scaled(c->b2) * cos(2.0 * w);
+        const double ni = -scaled(c->b1) * sin(w) - scaled(c->b2) * sin(2.0 * w);
+        const double dr = 1.0 + scaled(c->a1) * cos(w) + scaled(c->a2) * cos(2.0 * w);
+        const double di = -scaled(c->a1) * sin(w) - scaled(c->a2) * sin(2.0 * w);
+
+        return sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+
+}
+
+/**
+ * @brief Amplitude of the component of y at w (radians per
+ * sample), by projecting onto a sine and cosine after removing
+ * the mean.
+ */
+static double amplitude(
+    const int32_t* const y,
+    const size_t len,
+    const double w) {
+
+        double mean = 0.0;
+        double s = 0.0;
+        double c = 0.0;
+
+        for(size_t i = 0; i < len; ++i) {
+            mean += y[i];
+        }
+
+        mean /= (double)len;
+
+        for(size_t i = 0; i < len; ++i) {
+            s += (y[i] - mean) * sin(w * (double)i);
+            c += (y[i] - mean) * cos(w * (double)i);
+        }
+
+        return 2.0 * sqrt(s * s + c * c) / (double)len;
+
+}
+
+static double db(const double ratio) {
+    return 20.0 * log10(fmax(ratio, 1e-9));
+}
+
+static void check_coeffs(
+    const char* const name,
+    const hx711_notch_coeffs_t* const c,
+    const double sps,
+    const double hum_hz,
+    const long tolerance) {
+
+        //the same design as src/hx711_notch.c, in double
+        const double scale = (double)(UINT32_C(1) << HX711_NOTCH_COEFF_BITS);
+        const double w = 2.0 * PI * fold(sps, hum_hz) / sps;
+        const double alpha = sin(w) / (2.0 * Q);
+        const double a0 = 1.0 + alpha;
+
+        const long b0 = lround(scale / a0);
+        const long b1 = lround(scale * -2.0 * cos(w) / a0);
+        const long a2 = lround(scale * (1.0 - alpha) / a0);
+
+        expect(
+            labs(c->b0 - b0) <= tolerance &&
+            labs(c->b1 - b1) <= tolerance &&
+            labs(c->b2 - b0) <= tolerance &&
+            labs(c->a1 - b1) <= tolerance &&
+            labs(c->a2 - a2) <= tolerance,
+            "%s coefficients within %ld of the design (b0 %ld, b1 %ld, a2 %ld)",
+            name, tolerance, b0, b1, a2);
+
+}
+
+static void check_hum(
+    const char* const name,
+    const hx711_notch_t* const proto,
+    const double sps,
+    const double hum_hz,
+    const bool nominal) {
+
+        static int32_t y[MAX_SAMPLES];
+
+        hx711_notch_t n = *proto;
+        const size_t settle = (size_t)(HUM_SETTLE_S * sps);
+        const size_t len = (size_t)(HUM_MEASURE_S * sps);
+        const double w = 2.0 * PI * fold(sps, hum_hz) / sps;
+
+        hx711_notch_reset(&n);
+
+        for(size_t i = 0; i < settle + len; ++i) {
+
+            const int32_t x = OFFSET + (int32_t)lround(
+                HUM_AMPLITUDE * sin(2.0 * PI * hum_hz * (double)i / sps + 0.3));
+            const int32_t out = hx711_notch_filter(&n, x);
+
+            if(i >= settle) {
+                y[i - settle] = out;
+            }
+
+        }
+
+        const double measured = amplitude(y, len, w);
+        const double predicted = HUM_AMPLITUDE * magnitude(&n._coeffs, w);
+
+        //rounding the input and each output is periodic with the
+        //hum, so up to a couple of counts of it can land on w
+        bool ok = fabs(measured - predicted) <= 2.0 + predicted * 0.01;
+
+        if(nominal) {
+            ok = ok && measured <= HUM_AMPLITUDE / 1000.0;
+        }
+
+        expect(ok,
+            "%s %.1fHz hum at %.1f SPS: %.1fdB (design %.1fdB)",
+            name, hum_hz, sps,
+            db(measured / HUM_AMPLITUDE),
+            db(predicted / HUM_AMPLITUDE));
+
+}
+
+static void check_step(
+    const char* const name,
+    const hx711_notch_t* const proto) {
+
+        hx711_notch_t n = *proto;
+        const hx711_notch_coeffs_t* const c = &n._coeffs;
+        const int32_t target = OFFSET + STEP;
+
+        //the same coefficients in double, primed at steady
+        //state as the library does
+        double x1 = OFFSET, x2 = OFFSET, y1 = OFFSET, y2 = OFFSET;
+        double worst = 0.0;
+        size_t settled = 0;
+        int32_t last = 0;
+
+        hx711_notch_reset(&n);
+
+        for(size_t i = 0; i < STEP_LEN; ++i) {
+
+            const int32_t x = i < STEP_AT ? OFFSET : target;
+            const int32_t y = hx711_notch_filter(&n, x);
+            const double ref =
+                scaled(c->b0) * x + scaled(c->b1) * x1 + scaled(c->b2) * x2 -
+                scaled(c->a1) * y1 - scaled(c->a2) * y2;
+
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = ref;
+
+            worst = fmax(worst, fabs(y - ref));
+
+            if(labs((long)y - target) > SETTLE_COUNTS) {
+                settled = i + 1 - STEP_AT;
+            }
+
+            last = y;
+
+        }
+
+        //the error decays as r^n, where r = sqrt(a2) is the pole
+        //radius; allow a few samples for the initial overshoot
+        const double r = sqrt(scaled(c->a2));
+        const size_t allowed = (size_t)ceil(
+            log((double)SETTLE_COUNTS / STEP) / log(r)) + 4;
+
+        expect(worst <= 4.0,
+            "%s step follows the design to within %.2f counts",
+            name, worst);
+
+        expect(settled <= allowed,
+            "%s step settles to %d counts in %zu samples (pole radius %.3f allows %zu)",
+            name, SETTLE_COUNTS, settled, r, allowed);
+
+        expect(labs((long)last - target) <= 1,
+            "%s step ends at %ld (target %ld)",
+            name, (long)last, (long)target);
+
+}
+
+static void check_comb(void) {
+
+    static const double beats[] = { 2.5, 5.0 };
+    static int32_t y[MAX_SAMPLES];
+
+    const size_t len = HUM_MEASURE_S * 10;
+    hx711_notch_t n;
+
+    hx711_notch_init(&n, 10, hx711_mains_50);
+
+    //at 10 SPS mains aliases to DC, and what is left is a beat
+    //which the comb's nulls remove
+    for(size_t b = 0; b < sizeof(beats) / sizeof(beats[0]); ++b) {
+
+        const double w = 2.0 * PI * beats[b] / 10.0;
+
+        hx711_notch_reset(&n);
+
+        for(size_t i = 0; i < HX711_NOTCH_COMB_LEN + len; ++i) {
+
+            const int32_t x = OFFSET + (int32_t)lround(
+                HUM_AMPLITUDE * sin(w * (double)i + 0.3));
+            const int32_t out = hx711_notch_filter(&n, x);
+
+            if(i >= HX711_NOTCH_COMB_LEN) {
+                y[i - HX711_NOTCH_COMB_LEN] = out;
+            }
+
+        }
+
+        const double measured = amplitude(y, len, w);
+
+        expect(measured <= 1.0,
+            "comb %.1fHz beat at 10 SPS: %.1fdB",
+            beats[b], db(measured / HUM_AMPLITUDE));
+
+    }
+
+    hx711_notch_reset(&n);
+
+    size_t settled = 0;
+
+    for(size_t i = 0; i < STEP_AT + HX711_NOTCH_COMB_LEN * 2; ++i) {
+        const int32_t x = i < STEP_AT ? OFFSET : OFFSET + STEP;
+        if(hx711_notch_filter(&n, x) != x) {
+            settled = i + 1 - STEP_AT;
+        }
+    }
+
+    expect(settled == HX711_NOTCH_COMB_LEN - 1,
+        "comb step settles exactly in %zu samples (expected %d)",
+        settled + 1, HX711_NOTCH_COMB_LEN);
+
+}
+
+int main(void) {
+
+    static const struct {
+        const char* name;
+        hx711_mains_t mains;
+        double hum_hz;
+    } rates[] = {
+        { "80 SPS 50Hz", hx711_mains_50, 50.0 },
+        { "80 SPS 60Hz", hx711_mains_60, 60.0 }
+    };
+
+    hx711_notch_t n;
+
+    for(size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) {
+
+        const double hum = rates[i].hum_hz;
+
+        hx711_notch_init(&n, 80, rates[i].mains);
+
+        check_coeffs(rates[i].name, &HX711_NOTCH_COEFFS_80[rates[i].mains], 80.0, hum, 1);
+        check_hum(rates[i].name, &n, 80.0, hum, true);
+        check_hum(rates[i].name, &n, 80.0, hum - 0.5, false);
+        check_hum(rates[i].name, &n, 80.0, hum + 0.5, false);
+        check_hum(rates[i].name, &n, 80.0, hum * 0.5, false);
+        check_step(rates[i].name, &n);
+
+    }
+
+    //an HX711 clocked from a crystal a little off nominal; the
+    //coefficients are computed in float, so allow for rounding
+    hx711_notch_init_custom(&n, 80.0f, 50.0f, (float)Q);
+    check_coeffs("custom 80 SPS 50Hz", &n._coeffs, 80.0, 50.0, 64);
+
+    expect(hx711_notch_init_custom(&n, 77.3f, 50.0f, (float)Q),
+        "custom 77.3 SPS 50Hz places a notch");
+    check_coeffs("custom 77.3 SPS 50Hz", &n._coeffs, 77.3, 50.0, 64);
+    check_hum("custom 77.3 SPS 50Hz", &n, 77.3, 50.0, true);
+    check_step("custom 77.3 SPS 50Hz", &n);
+
+    expect(!hx711_notch_init_custom(&n, 10.0f, 50.0f, (float)Q),
+        "custom 10 SPS 50Hz falls back to the comb");
+
+    check_comb();
+
+    printf("%u failure(s)\n", failures);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
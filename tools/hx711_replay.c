@@ -0,0 +1,307 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side tool for recordings made with hx711_replay_rec_t.
+ * It prints a recording, or replays it as fast as possible
+ * through decoding and the glitch and mains hum filters to
+ * measure their cost and to check a change to them against
+ * real data. synth writes a recording of simulated chips to
+ * try it without hardware.
+ * 
+ * hx711_multi_pinvals_to_values needs the Pico SDK, so frames
+ * are decoded here with a copy of its loop (same bit order
+ * and sign extension). On the device, replay a recording
+ * through the library's own decoder with hx711_replay_src_t.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_replay tools/hx711_replay.c \
+ *      src/hx711_replay.c src/hx711_glitch.c src/hx711_notch.c -lm
+ * 
+ * Usage:
+ *  hx711_replay dump file
+ *  hx711_replay bench file [passes]
+ *  hx711_replay synth file chips frames
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/hx711_decode.h"
+#include "../include/hx711_glitch.h"
+#include "../include/hx711_notch.h"
+#include "../include/hx711_replay.h"
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint8_t* read_file(
+    const char* const path,
+    size_t* const len) {
+
+        FILE* const fp = fopen(path, "rb");
+        uint8_t* data = NULL;
+        size_t cap = 0;
+
+        *len = 0;
+
+        if(fp == NULL) {
+            perror(path);
+            return NULL;
+        }
+
+        for(;;) {
+            if(*len == cap) {
+                cap = cap ? cap * 2 : 65536;
+                uint8_t* const p = realloc(data, cap);
+                if(p == NULL) {
+                    free(data);
+                    fclose(fp);
+                    return NULL;
+                }
+                data = p;
+            }
+            const size_t n = fread(&data[*len], 1, cap - *len, fp);
+            if(n == 0) {
+                break;
+            }
+            *len += n;
+        }
+
+        fclose(fp);
+        return data;
+
+}
+
+static bool file_write(
+    void* ctx,
+    const void* buf,
+    size_t len) {
+        return fwrite(buf, 1, len, (FILE*)ctx) == len;
+}
+
+static int dump(hx711_replay_src_t* const src) {
+
+    const size_t chips = hx711_replay_src_get_chips_len(src);
+    uint32_t timestamp;
+    uint32_t pinvals[HX711_REPLAY_FRAME_WORDS];
+    uint32_t raw;
+    int32_t values[32];
+
+    if(hx711_replay_src_get_kind(src) == HX711_REPLAY_KIND_SINGLE) {
+        while(hx711_replay_src_next_raw(src, &timestamp, &raw)) {
+            printf("%" PRIu32 " %" PRId32 "\n", timestamp, HX711_SIGN_EXTEND(raw));
+        }
+        return EXIT_SUCCESS;
+    }
+
+    while(hx711_replay_src_next_frame(src, &timestamp, pinvals)) {
+        hx711_decode_pinvals(pinvals, values, chips);
+        printf("%" PRIu32, timestamp);
+        for(size_t i = 0; i < chips; ++i) {
+            printf(" %" PRId32, values[i]);
+        }
+        putchar('\n');
+    }
+
+    return EXIT_SUCCESS;
+
+}
+
+static int bench(
+    hx711_replay_src_t* const src,
+    const unsigned long passes) {
+
+        if(hx711_replay_src_get_kind(src) != HX711_REPLAY_KIND_MULTI) {
+            fprintf(stderr, "bench needs a multi recording\n");
+            return EXIT_FAILURE;
+        }
+
+        const size_t chips = hx711_replay_src_get_chips_len(src);
+        hx711_glitch_config_t gcfg;
+        hx711_glitch_t gs[32];
+        hx711_notch_t ns[32];
+        uint32_t timestamp;
+        uint32_t pinvals[HX711_REPLAY_FRAME_WORDS];
+        int32_t values[32];
+        unsigned long frames = 0;
+        unsigned long glitches = 0;
+        int64_t sink = 0;
+
+        hx711_glitch_get_default_config(&gcfg);
+
+        for(size_t i = 0; i < chips; ++i) {
+            hx711_glitch_init(&gs[i], &gcfg);
+            hx711_notch_init(&ns[i], 80, hx711_mains_50);
+        }
+
+        const double start = now_s();
+
+        for(unsigned long p = 0; p < passes; ++p) {
+
+            hx711_replay_src_rewind(src);
+
+            while(hx711_replay_src_next_frame(src, &timestamp, pinvals)) {
+
+                hx711_decode_pinvals(pinvals, values, chips);
+                hx711_glitch_filter_multi(gs, values, chips);
+
+                for(size_t i = 0; i < chips; ++i) {
+                    glitches += (hx711_glitch_get_quality(&gs[i]) & HX711_QUALITY_GLITCH) != 0;
+                }
+
+                hx711_notch_filter_multi(ns, values, chips);
+
+                sink += values[0];
+                ++frames;
+
+            }
+
+        }
+
+        const double elapsed = now_s() - start;
+
+        if(frames == 0) {
+            fprintf(stderr, "no frames\n");
+            return EXIT_FAILURE;
+        }
+
+        printf("frames:          %lu x %zu chips\n", frames, chips);
+        printf("glitches:        %lu\n", glitches);
+        printf("frames/s:        %.0f\n", frames / elapsed);
+        printf("ns per chip:     %.2f\n", elapsed * 1e9 / ((double)frames * chips));
+
+        //stop the loop being optimised away
+        if(sink == 42) {
+            putchar('\n');
+        }
+
+        return EXIT_SUCCESS;
+
+}
+
+static int synth(
+    const char* const path,
+    const size_t chips,
+    const unsigned long frames) {
+
+        if(chips == 0 || chips > 32) {
+            fprintf(stderr, "chips must be 1 to 32\n");
+            return EXIT_FAILURE;
+        }
+
+        FILE* const fp = fopen(path, "wb");
+        hx711_replay_rec_t rec;
+        uint32_t seed = 1;
+
+        if(fp == NULL) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+
+        if(!hx711_replay_rec_init(&rec, HX711_REPLAY_KIND_MULTI, (uint8_t)chips, file_write, fp)) {
+            fclose(fp);
+            return EXIT_FAILURE;
+        }
+
+        for(unsigned long f = 0; f < frames; ++f) {
+
+            uint32_t pinvals[HX711_REPLAY_FRAME_WORDS] = { 0 };
+
+            for(size_t i = 0; i < chips; ++i) {
+
+                seed = seed * 1664525u + 1013904223u;
+
+                //a steady load per chip, a few hundred counts of
+                //noise and the odd spike
+                int32_t val = 100000 * (int32_t)(i + 1) +
+                    (int32_t)(seed >> 23) - 256;
+
+                if(seed % 997 == 0) {
+                    val += 4000000;
+                }
+
+                const uint32_t raw = (uint32_t)val & 0xffffff;
+
+                for(size_t b = 0; b < HX711_REPLAY_FRAME_WORDS; ++b) {
+                    pinvals[b] |= ((raw >> (HX711_REPLAY_FRAME_WORDS - 1 - b)) & 1) << i;
+                }
+
+            }
+
+            //80 SPS
+            if(!hx711_replay_rec_frame(&rec, (uint32_t)(f * 12500), pinvals)) {
+                fclose(fp);
+                return EXIT_FAILURE;
+            }
+
+        }
+
+        return fclose(fp) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
+
+int main(int argc, char** argv) {
+
+    if(argc >= 5 && strcmp(argv[1], "synth") == 0) {
+        return synth(argv[2], strtoul(argv[3], NULL, 0), strtoul(argv[4], NULL, 0));
+    }
+
+    if(argc < 3 || (strcmp(argv[1], "dump") != 0 && strcmp(argv[1], "bench") != 0)) {
+        fprintf(stderr,
+            "usage: %s dump file | bench file [passes] | synth file chips frames\n",
+            argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t len;
+    uint8_t* const data = read_file(argv[2], &len);
+    hx711_replay_src_t src;
+    int ret;
+
+    if(data == NULL || !hx711_replay_src_init(&src, data, len)) {
+        fprintf(stderr, "%s: not a recording\n", argv[2]);
+        free(data);
+        return EXIT_FAILURE;
+    }
+
+    if(strcmp(argv[1], "dump") == 0) {
+        ret = dump(&src);
+    }
+    else {
+        ret = bench(&src, argc > 3 ? strtoul(argv[3], NULL, 0) : 100);
+    }
+
+    free(data);
+    return ret;
+
+}
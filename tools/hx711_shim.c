@@ -0,0 +1,1941 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hx711_model.h"
+#include "hx711_shim.h"
+
+#define HX711_SHIM_SYS_HZ               UINT32_C(125000000)
+#define HX711_SHIM_FIFO_DEPTH           4u
+#define HX711_SHIM_NEVER                UINT64_MAX
+#define HX711_SHIM_DREQ_FORCE           0x3fu
+
+//handlers run back to back without time moving before an IRQ
+//is taken to be stuck
+#define HX711_SHIM_MAX_IRQ_RUNS         1000u
+
+typedef enum {
+    hx711_shim__run_ok = 0,
+    hx711_shim__run_wait,   //waiting on a pin or IRQ flag
+    hx711_shim__run_fifo,   //waiting on the CPU
+    hx711_shim__run_idle    //looping without effect
+} hx711_shim__run_t;
+
+/**
+ * @brief Everything a state machine's next pass round its
+ * wrap loop depends on, other than its input pins. Two equal
+ * snapshots at the wrap target with nothing changed in
+ * between mean the loop will go on repeating.
+ */
+typedef struct {
+    uint32_t pc;
+    uint32_t x;
+    uint32_t y;
+    uint32_t isr;
+    uint32_t osr;
+    uint32_t isr_count;
+    uint32_t osr_count;
+    uint32_t rx_len;
+    uint32_t tx_len;
+    uint32_t irq;
+    uint32_t out;
+    uint32_t oe;
+    uint32_t effects;
+} hx711_shim__snap_t;
+
+typedef struct {
+    uint32_t words[2 * HX711_SHIM_FIFO_DEPTH];
+    uint head;
+    uint len;
+} hx711_shim__fifo_t;
+
+typedef struct {
+    bool claimed;
+    pio_sm_config cfg;
+    uint pc;
+    uint32_t x;
+    uint32_t y;
+    uint32_t isr;
+    uint32_t osr;
+    uint isr_count;
+    uint osr_count;
+    bool irq_waiting;
+    hx711_shim__fifo_t tx;
+    hx711_shim__fifo_t rx;
+    hx711_shim__run_t state;
+    uint64_t time;
+    uint32_t effects;       //pins, IRQ flags or FIFOs changed
+    hx711_shim__snap_t snap;
+    bool snap_valid;
+} hx711_shim__sm_t;
+
+typedef struct {
+    uint32_t used;
+    uint32_t out;
+    uint32_t oe;
+    uint32_t inte[2];
+    hx711_shim__sm_t sm[NUM_PIO_STATE_MACHINES];
+} hx711_shim__pio_t;
+
+typedef struct {
+    hx711_model_t* m;
+    uint clock_pin;
+    uint data_pin;
+    uint64_t time;
+} hx711_shim__chip_t;
+
+typedef struct {
+    bool claimed;
+    bool busy;
+    dma_channel_config cfg;
+    uint32_t reload;
+} hx711_shim__dma_t;
+
+pio_hw_t hx711_shim_pio_hw[NUM_PIOS];
+
+static systick_hw_t hx711_shim__systick;
+systick_hw_t* const systick_hw = &hx711_shim__systick;
+
+static dma_hw_t hx711_shim__dma_hw;
+dma_hw_t* const dma_hw = &hx711_shim__dma_hw;
+
+static uint64_t hx711_shim__now = 0;
+static hx711_shim__pio_t hx711_shim__pios[NUM_PIOS];
+static hx711_shim__chip_t hx711_shim__chips[HX711_SHIM_MAX_MODELS];
+static hx711_shim__chip_t* hx711_shim__data_pin_chips[NUM_BANK0_GPIOS];
+static uint hx711_shim__chip_count = 0;
+
+static enum gpio_function hx711_shim__gpio_func[NUM_BANK0_GPIOS];
+static uint32_t hx711_shim__sio_out = 0;
+static uint32_t hx711_shim__sio_oe = 0;
+
+static hx711_shim__dma_t hx711_shim__dmas[NUM_DMA_CHANNELS];
+static uint32_t hx711_shim__dma_intr = 0;
+static uint32_t hx711_shim__dma_inte[2];
+
+static irq_handler_t hx711_shim__irq_handlers[NUM_IRQS];
+static irq_handler_t hx711_shim__shared_handlers[NUM_IRQS][HX711_SHIM_MAX_SHARED_HANDLERS];
+static uint32_t hx711_shim__irq_enabled = 0;
+static uint32_t hx711_shim__primask = 0;
+static bool hx711_shim__in_isr = false;
+
+//time
+
+static uint64_t hx711_shim__max(const uint64_t a, const uint64_t b) {
+    return a < b ? b : a;
+}
+
+static hx711_shim__pio_t* hx711_shim__get_pio(PIO const pio) {
+    return &hx711_shim__pios[pio_get_index(pio)];
+}
+
+static hx711_shim__sm_t* hx711_shim__get_sm(
+    PIO const pio,
+    const uint sm) {
+        check_sm_param(sm);
+        return &hx711_shim__get_pio(pio)->sm[sm];
+}
+
+static bool hx711_shim__sm_is_enabled(
+    const uint p,
+    const uint sm) {
+        return (hx711_shim_pio_hw[p].ctrl & (1u << (PIO_CTRL_SM_ENABLE_LSB + sm))) != 0;
+}
+
+static uint64_t hx711_shim__cycle_ns(const hx711_shim__sm_t* const s) {
+    const double div = s->cfg.clkdiv < 1.0f ? 1.0 : s->cfg.clkdiv;
+    return (uint64_t)(div * 1e9 / HX711_SHIM_SYS_HZ + 0.5);
+}
+
+//pins
+
+static hx711_shim__chip_t* hx711_shim__chip_on_data_pin(const uint gpio) {
+    return gpio < NUM_BANK0_GPIOS ? hx711_shim__data_pin_chips[gpio] : NULL;
+}
+
+static void hx711_shim__chip_advance(
+    hx711_shim__chip_t* const c,
+    const uint64_t t) {
+        //state machines may be up to an instruction ahead of
+        //the CPU; never take a model backwards
+        c->time = hx711_shim__max(c->time, t);
+        hx711_model_advance(c->m, c->time);
+}
+
+/**
+ * @brief Level of a pin at time t: whatever its function
+ * drives, or the attached model's DOUT for an input.
+ */
+static bool hx711_shim__pin_level(
+    const uint gpio,
+    const uint64_t t) {
+
+        const uint32_t bit = 1u << gpio;
+
+        switch(hx711_shim__gpio_func[gpio]) {
+            case GPIO_FUNC_SIO:
+                if(hx711_shim__sio_oe & bit) {
+                    return (hx711_shim__sio_out & bit) != 0;
+                }
+                break;
+            case GPIO_FUNC_PIO0:
+            case GPIO_FUNC_PIO1: {
+                const hx711_shim__pio_t* const p =
+                    &hx711_shim__pios[hx711_shim__gpio_func[gpio] - GPIO_FUNC_PIO0];
+                if(p->oe & bit) {
+                    return (p->out & bit) != 0;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        hx711_shim__chip_t* const c = hx711_shim__chip_on_data_pin(gpio);
+
+        if(c == NULL) {
+            return false;
+        }
+
+        hx711_shim__chip_advance(c, t);
+
+        return hx711_model_get_dout(c->m);
+
+}
+
+/**
+ * @brief Have a state machine skipped ahead while waiting on a
+ * pin or IRQ flag, or while idling, look again at time t.
+ */
+static void hx711_shim__wake_sm(
+    hx711_shim__sm_t* const s,
+    const uint64_t t) {
+        s->snap_valid = false;
+        if((s->state == hx711_shim__run_wait || s->state == hx711_shim__run_idle) &&
+            s->time > t) {
+                s->time = t + hx711_shim__cycle_ns(s);
+        }
+}
+
+static void hx711_shim__wake(const uint64_t t) {
+    for(uint p = 0; p < NUM_PIOS; ++p) {
+        for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+            hx711_shim__wake_sm(&hx711_shim__pios[p].sm[sm], t);
+        }
+    }
+}
+
+/**
+ * @brief Pass any change of pin levels at time t on to the
+ * models, and have state machines which could see it look
+ * again.
+ */
+static void hx711_shim__pins_changed(const uint64_t t) {
+
+    for(uint i = 0; i < hx711_shim__chip_count; ++i) {
+        hx711_shim__chip_t* const c = &hx711_shim__chips[i];
+        const bool level = hx711_shim__pin_level(c->clock_pin, t);
+        c->time = hx711_shim__max(c->time, t);
+        hx711_model_set_clock(c->m, c->time, level);
+    }
+
+    hx711_shim__wake(t);
+
+}
+
+/**
+ * @brief Earliest time after t at which a pin could change
+ * without a state machine or the CPU doing anything: the next
+ * conversion of the model driving it.
+ */
+static uint64_t hx711_shim__pin_next_change(
+    const uint gpio,
+    const uint64_t t) {
+
+        hx711_shim__chip_t* const c = hx711_shim__chip_on_data_pin(gpio);
+
+        if(c == NULL) {
+            return HX711_SHIM_NEVER;
+        }
+
+        hx711_shim__chip_advance(c, t);
+
+        return hx711_model_get_next_conversion(c->m);
+
+}
+
+/**
+ * @brief Earliest time after t at which any attached model
+ * could change its DOUT by itself.
+ */
+static uint64_t hx711_shim__models_next_change(const uint64_t t) {
+    uint64_t next = HX711_SHIM_NEVER;
+    for(uint i = 0; i < hx711_shim__chip_count; ++i) {
+        next = MIN(next, hx711_shim__pin_next_change(hx711_shim__chips[i].data_pin, t));
+    }
+    return next;
+}
+
+/**
+ * @brief Returns whether any pin changed.
+ */
+static bool hx711_shim__write_pins(
+    hx711_shim__pio_t* const p,
+    const uint base,
+    const uint count,
+    const uint32_t value,
+    const bool dirs,
+    const uint64_t t) {
+
+        uint32_t* const reg = dirs ? &p->oe : &p->out;
+        const uint32_t old = *reg;
+
+        for(uint i = 0; i < count; ++i) {
+            const uint32_t bit = 1u << ((base + i) % 32);
+            if((value >> i) & 1) {
+                *reg |= bit;
+            }
+            else {
+                *reg &= ~bit;
+            }
+        }
+
+        if(*reg == old) {
+            return false;
+        }
+
+        hx711_shim__pins_changed(t);
+
+        return true;
+
+}
+
+//fifos
+
+static uint hx711_shim__fifo_depth(
+    const hx711_shim__sm_t* const s,
+    const bool tx) {
+        switch(s->cfg.fifo_join) {
+            case PIO_FIFO_JOIN_TX:
+                return tx ? 2 * HX711_SHIM_FIFO_DEPTH : 0;
+            case PIO_FIFO_JOIN_RX:
+                return tx ? 0 : 2 * HX711_SHIM_FIFO_DEPTH;
+            default:
+                return HX711_SHIM_FIFO_DEPTH;
+        }
+}
+
+static bool hx711_shim__fifo_push(
+    hx711_shim__fifo_t* const f,
+    const uint depth,
+    const uint32_t word) {
+        if(f->len >= depth) {
+            return false;
+        }
+        f->words[(f->head + f->len++) % count_of(f->words)] = word;
+        return true;
+}
+
+static bool hx711_shim__fifo_pop(
+    hx711_shim__fifo_t* const f,
+    uint32_t* const word) {
+        if(f->len == 0) {
+            return false;
+        }
+        *word = f->words[f->head];
+        f->head = (f->head + 1) % count_of(f->words);
+        --f->len;
+        return true;
+}
+
+/**
+ * @brief Take a word from a state machine's RX FIFO, as the
+ * CPU or a DMA channel reading RXF does.
+ */
+static bool hx711_shim__rx_pop(
+    hx711_shim__sm_t* const s,
+    uint32_t* const word) {
+
+        if(!hx711_shim__fifo_pop(&s->rx, word)) {
+            return false;
+        }
+
+        if(s->state == hx711_shim__run_fifo) {
+            s->state = hx711_shim__run_ok;
+            s->time = hx711_shim__max(s->time, hx711_shim__now);
+        }
+
+        hx711_shim__wake_sm(s, hx711_shim__now);
+
+        return true;
+
+}
+
+static void hx711_shim__dma_pump(void);
+
+//state machines
+
+/**
+ * @brief Value of a source; for pins, only the first bits
+ * from in_base are read.
+ */
+static uint32_t hx711_shim__read_src(
+    hx711_shim__sm_t* const s,
+    const uint src,
+    const uint bits) {
+        switch(src) {
+            case 0: {
+                uint32_t v = 0;
+                for(uint i = 0; i < bits; ++i) {
+                    const uint gpio = (s->cfg.in_base + i) % 32;
+                    if(gpio < NUM_BANK0_GPIOS && hx711_shim__pin_level(gpio, s->time)) {
+                        v |= 1u << i;
+                    }
+                }
+                return v;
+            }
+            case 1: return s->x;
+            case 2: return s->y;
+            case 3: return 0;
+            case 6: return s->isr;
+            case 7: return s->osr;
+            default: return 0;
+        }
+}
+
+static uint32_t hx711_shim__mask(const uint bits) {
+    return bits >= 32 ? UINT32_MAX : (UINT32_C(1) << bits) - 1;
+}
+
+static void hx711_shim__set_rxstall(
+    const uint p,
+    const uint sm) {
+        hx711_shim_pio_hw[p].fdebug |= 1u << (PIO_FDEBUG_RXSTALL_LSB + sm);
+}
+
+static bool hx711_shim__push(hx711_shim__sm_t* const s) {
+
+        if(!hx711_shim__fifo_push(&s->rx, hx711_shim__fifo_depth(s, false), s->isr)) {
+            return false;
+        }
+
+        ++s->effects;
+
+        //a channel paced by this FIFO takes the word now
+        hx711_shim__dma_pump();
+
+        return true;
+
+}
+
+static void hx711_shim__sm_write_pins(
+    hx711_shim__pio_t* const pio,
+    hx711_shim__sm_t* const s,
+    const uint base,
+    const uint count,
+    const uint32_t value,
+    const bool dirs) {
+        if(hx711_shim__write_pins(pio, base, count, value, dirs, s->time)) {
+            ++s->effects;
+        }
+}
+
+/**
+ * @brief Set a PIO's IRQ flags from a state machine, and have
+ * any other waiting on them look again.
+ */
+static void hx711_shim__sm_set_irq(
+    const uint p,
+    hx711_shim__sm_t* const s,
+    const uint32_t irq) {
+        if(hx711_shim_pio_hw[p].irq != irq) {
+            hx711_shim_pio_hw[p].irq = irq;
+            ++s->effects;
+            hx711_shim__wake(s->time);
+        }
+}
+
+/**
+ * @brief Execute one instruction. Returns whether it
+ * completed; if not, s->state says what it is waiting on.
+ */
+static bool hx711_shim__exec(
+    const uint p,
+    const uint sm,
+    const uint16_t instr,
+    bool* const jumped,
+    uint* const delay) {
+
+        hx711_shim__pio_t* const pio = &hx711_shim__pios[p];
+        hx711_shim__sm_t* const s = &pio->sm[sm];
+
+        const uint op = instr >> 13;
+        const uint arg1 = (instr >> 5) & 7;
+        const uint arg2 = instr & 0x1f;
+
+        //delay and side-set share bits 12 to 8
+        const uint ssBits = s->cfg.sideset_bits;
+        const uint field = (instr >> 8) & 0x1f;
+        const uint delayBits = 5 - ssBits;
+
+        *delay = field & hx711_shim__mask(delayBits);
+        *jumped = false;
+
+        if(ssBits > 0) {
+            const uint valueBits = s->cfg.sideset_optional ? ssBits - 1 : ssBits;
+            const bool enabled = !s->cfg.sideset_optional || ((field >> 4) & 1);
+            if(enabled && valueBits > 0) {
+                hx711_shim__sm_write_pins(
+                    pio,
+                    s,
+                    s->cfg.sideset_base,
+                    valueBits,
+                    (field >> delayBits) & hx711_shim__mask(valueBits),
+                    s->cfg.sideset_pindirs);
+            }
+        }
+
+        s->state = hx711_shim__run_ok;
+
+        switch(op) {
+
+            case 0: { //jmp
+                bool cond;
+                switch(arg1) {
+                    case 0: cond = true; break;
+                    case 1: cond = s->x == 0; break;
+                    case 2: cond = s->x-- != 0; break;
+                    case 3: cond = s->y == 0; break;
+                    case 4: cond = s->y-- != 0; break;
+                    case 5: cond = s->x != s->y; break;
+                    case 6: cond = hx711_shim__pin_level(s->cfg.jmp_pin, s->time); break;
+                    default: cond = s->osr_count < s->cfg.pull_threshold; break;
+                }
+                if(cond) {
+                    s->pc = arg2;
+                    *jumped = true;
+                }
+                return true;
+            }
+
+            case 1: { //wait
+                const bool pol = (instr >> 7) & 1;
+                const uint src = (instr >> 5) & 3;
+                bool level;
+                if(src == 2) {
+                    const uint flag = (arg2 & 0x10) ? ((arg2 & 0x4) | ((arg2 + sm) & 3)) : (arg2 & 7);
+                    level = (hx711_shim_pio_hw[p].irq >> flag) & 1;
+                    if(level == pol && pol) {
+                        hx711_shim__sm_set_irq(p, s, hx711_shim_pio_hw[p].irq & ~(1u << flag));
+                    }
+                }
+                else {
+                    const uint gpio = src == 0 ? arg2 : (s->cfg.in_base + arg2) % 32;
+                    level = hx711_shim__pin_level(gpio, s->time);
+                }
+                if(level != pol) {
+                    s->state = hx711_shim__run_wait;
+                    return false;
+                }
+                return true;
+            }
+
+            case 2: { //in
+                const uint n = arg2 == 0 ? 32 : arg2;
+                if(s->cfg.autopush &&
+                    MIN(s->isr_count + n, 32) >= s->cfg.push_threshold &&
+                    s->rx.len >= hx711_shim__fifo_depth(s, false)) {
+                        hx711_shim__set_rxstall(p, sm);
+                        s->state = hx711_shim__run_fifo;
+                        return false;
+                }
+                const uint32_t data = hx711_shim__read_src(s, arg1, n) & hx711_shim__mask(n);
+                if(n == 32) {
+                    s->isr = data;
+                }
+                else if(s->cfg.in_shift_right) {
+                    s->isr = (s->isr >> n) | (data << (32 - n));
+                }
+                else {
+                    s->isr = (s->isr << n) | data;
+                }
+                s->isr_count = MIN(s->isr_count + n, 32);
+                if(s->cfg.autopush && s->isr_count >= s->cfg.push_threshold) {
+                    hx711_shim__push(s);
+                    s->isr = 0;
+                    s->isr_count = 0;
+                }
+                return true;
+            }
+
+            case 3: { //out
+                const uint n = arg2 == 0 ? 32 : arg2;
+                if(s->cfg.autopull && s->osr_count >= s->cfg.pull_threshold) {
+                    if(!hx711_shim__fifo_pop(&s->tx, &s->osr)) {
+                        s->state = hx711_shim__run_fifo;
+                        return false;
+                    }
+                    ++s->effects;
+                    s->osr_count = 0;
+                }
+                uint32_t data;
+                if(n == 32) {
+                    data = s->osr;
+                    s->osr = 0;
+                }
+                else if(s->cfg.out_shift_right) {
+                    data = s->osr & hx711_shim__mask(n);
+                    s->osr >>= n;
+                }
+                else {
+                    data = s->osr >> (32 - n);
+                    s->osr <<= n;
+                }
+                s->osr_count = MIN(s->osr_count + n, 32);
+                switch(arg1) {
+                    case 0: hx711_shim__sm_write_pins(pio, s, s->cfg.out_base, s->cfg.out_count, data, false); break;
+                    case 1: s->x = data; break;
+                    case 2: s->y = data; break;
+                    case 4: hx711_shim__sm_write_pins(pio, s, s->cfg.out_base, s->cfg.out_count, data, true); break;
+                    case 5: s->pc = data & 0x1f; *jumped = true; break;
+                    case 6: s->isr = data; s->isr_count = n; break;
+                    default: break;
+                }
+                return true;
+            }
+
+            case 4: { //push/pull
+                const bool cond = (instr >> 6) & 1;
+                const bool block = (instr >> 5) & 1;
+                if((instr >> 7) & 1) {
+                    if(cond && s->osr_count < s->cfg.pull_threshold) {
+                        return true;
+                    }
+                    if(hx711_shim__fifo_pop(&s->tx, &s->osr)) {
+                        ++s->effects;
+                    }
+                    else if(block) {
+                        s->state = hx711_shim__run_fifo;
+                        return false;
+                    }
+                    else {
+                        s->osr = s->x;
+                    }
+                    s->osr_count = 0;
+                }
+                else {
+                    if(cond && s->isr_count < s->cfg.push_threshold) {
+                        return true;
+                    }
+                    if(!hx711_shim__push(s)) {
+                        hx711_shim__set_rxstall(p, sm);
+                        if(block) {
+                            s->state = hx711_shim__run_fifo;
+                            return false;
+                        }
+                    }
+                    s->isr = 0;
+                    s->isr_count = 0;
+                }
+                return true;
+            }
+
+            case 5: { //mov
+                uint32_t v = hx711_shim__read_src(s, instr & 7, 32);
+                switch((instr >> 3) & 3) {
+                    case 1: v = ~v; break;
+                    case 2: {
+                        uint32_t r = 0;
+                        for(uint i = 0; i < 32; ++i) {
+                            r |= ((v >> i) & 1) << (31 - i);
+                        }
+                        v = r;
+                        break;
+                    }
+                    default: break;
+                }
+                switch(arg1) {
+                    case 0: hx711_shim__sm_write_pins(pio, s, s->cfg.out_base, s->cfg.out_count, v, false); break;
+                    case 1: s->x = v; break;
+                    case 2: s->y = v; break;
+                    case 5: s->pc = v & 0x1f; *jumped = true; break;
+                    case 6: s->isr = v; s->isr_count = 0; break;
+                    case 7: s->osr = v; s->osr_count = 0; break;
+                    default: break;
+                }
+                return true;
+            }
+
+            case 6: { //irq
+                const uint flag = (arg2 & 0x10) ? ((arg2 & 0x4) | ((arg2 + sm) & 3)) : (arg2 & 7);
+                const uint32_t bit = 1u << flag;
+                if((instr >> 6) & 1) {
+                    hx711_shim__sm_set_irq(p, s, hx711_shim_pio_hw[p].irq & ~bit);
+                    return true;
+                }
+                if(!s->irq_waiting) {
+                    hx711_shim__sm_set_irq(p, s, hx711_shim_pio_hw[p].irq | bit);
+                    if(!((instr >> 5) & 1)) {
+                        return true;
+                    }
+                    s->irq_waiting = true;
+                }
+                if(hx711_shim_pio_hw[p].irq & bit) {
+                    s->state = hx711_shim__run_wait;
+                    return false;
+                }
+                s->irq_waiting = false;
+                return true;
+            }
+
+            default: { //set
+                switch(arg1) {
+                    case 0: hx711_shim__sm_write_pins(pio, s, s->cfg.set_base, s->cfg.set_count, arg2, false); break;
+                    case 1: s->x = arg2; break;
+                    case 2: s->y = arg2; break;
+                    case 4: hx711_shim__sm_write_pins(pio, s, s->cfg.set_base, s->cfg.set_count, arg2, true); break;
+                    default: break;
+                }
+                return true;
+            }
+
+        }
+
+}
+
+/**
+ * @brief Called each time a state machine gets back to its
+ * wrap target. If nothing has changed since it was last there,
+ * it will only go on doing the same until one of its inputs
+ * changes, so skip it ahead to when a model could next change
+ * a pin. Anything else it could see wakes it sooner.
+ */
+static void hx711_shim__check_idle(
+    const uint p,
+    hx711_shim__sm_t* const s) {
+
+        const hx711_shim__pio_t* const pio = &hx711_shim__pios[p];
+
+        const hx711_shim__snap_t snap = {
+            .pc = s->pc,
+            .x = s->x,
+            .y = s->y,
+            .isr = s->isr,
+            .osr = s->osr,
+            .isr_count = s->isr_count,
+            .osr_count = s->osr_count,
+            .rx_len = s->rx.len,
+            .tx_len = s->tx.len,
+            .irq = hx711_shim_pio_hw[p].irq,
+            .out = pio->out,
+            .oe = pio->oe,
+            .effects = s->effects
+        };
+
+        if(s->snap_valid && memcmp(&snap, &s->snap, sizeof(snap)) == 0) {
+            s->state = hx711_shim__run_idle;
+            s->time = hx711_shim__max(s->time, hx711_shim__models_next_change(s->time));
+            return;
+        }
+
+        s->snap = snap;
+        s->snap_valid = true;
+
+}
+
+/**
+ * @brief Run one instruction of an enabled state machine at
+ * its own time, and move its time on.
+ */
+static void hx711_shim__step(
+    const uint p,
+    const uint sm,
+    const uint64_t until) {
+
+        hx711_shim__sm_t* const s = &hx711_shim__pios[p].sm[sm];
+        const uint64_t cycle = hx711_shim__cycle_ns(s);
+        bool jumped;
+        uint delay;
+
+        const uint16_t instr = (uint16_t)hx711_shim_pio_hw[p].instr_mem[s->pc];
+
+        if(hx711_shim__exec(p, sm, instr, &jumped, &delay)) {
+            if(!jumped) {
+                s->pc = s->pc == s->cfg.wrap ? s->cfg.wrap_target : (s->pc + 1) % PIO_INSTRUCTION_COUNT;
+            }
+            s->time += cycle * (1 + delay);
+            if(s->pc == s->cfg.wrap_target) {
+                hx711_shim__check_idle(p, s);
+            }
+            return;
+        }
+
+        //stalled. Only the CPU can unblock a FIFO, only another
+        //state machine or the CPU can change an IRQ flag, and a
+        //pin held by a model only changes at its next
+        //conversion (or when something else drives it). All of
+        //those wake it in hx711_shim__wake, so skip ahead
+        uint64_t next = s->time + cycle;
+
+        if(s->state == hx711_shim__run_fifo) {
+            next = hx711_shim__max(next, until);
+        }
+        else if(((instr >> 13) == 1) && ((instr >> 5) & 3) != 2) {
+            const uint gpio = ((instr >> 5) & 3) == 0
+                ? (instr & 0x1f)
+                : (s->cfg.in_base + (instr & 0x1f)) % 32;
+            const uint64_t change = hx711_shim__pin_next_change(gpio, s->time);
+            next = hx711_shim__max(next, MIN(change, hx711_shim__max(until, next)));
+        }
+        else {
+            next = hx711_shim__max(next, until);
+        }
+
+        s->time = next;
+
+}
+
+//interrupts
+
+/**
+ * @brief A PIO's raw interrupt sources, as its INTR register.
+ */
+static uint32_t hx711_shim__pio_intr(const uint p) {
+
+    uint32_t intr = (hx711_shim_pio_hw[p].irq & 0xfu) << pis_interrupt0;
+
+    for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+        const hx711_shim__sm_t* const s = &hx711_shim__pios[p].sm[sm];
+        if(s->rx.len > 0) {
+            intr |= 1u << (pis_sm0_rx_fifo_not_empty + sm);
+        }
+        if(s->tx.len < hx711_shim__fifo_depth(s, true)) {
+            intr |= 1u << (pis_sm0_tx_fifo_not_full + sm);
+        }
+    }
+
+    return intr;
+
+}
+
+static bool hx711_shim__irq_is_raised(const uint num) {
+    switch(num) {
+        case PIO0_IRQ_0:
+        case PIO0_IRQ_1:
+        case PIO1_IRQ_0:
+        case PIO1_IRQ_1: {
+            const uint p = (num - PIO0_IRQ_0) / 2;
+            const uint idx = (num - PIO0_IRQ_0) % 2;
+            return (hx711_shim__pio_intr(p) & hx711_shim__pios[p].inte[idx]) != 0;
+        }
+        case DMA_IRQ_0:
+        case DMA_IRQ_1:
+            return (hx711_shim__dma_intr & hx711_shim__dma_inte[num - DMA_IRQ_0]) != 0;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Call the handlers of every enabled IRQ which is
+ * raised, lowest number first, until none are. Handlers do not
+ * nest.
+ */
+static void hx711_shim__dispatch_irqs(void) {
+
+    if(hx711_shim__primask != 0 || hx711_shim__in_isr) {
+        return;
+    }
+
+    for(uint runs = 0;; ++runs) {
+
+        uint32_t pending = hx711_shim__irq_enabled;
+
+        while(pending != 0 && !hx711_shim__irq_is_raised((uint)__builtin_ctz(pending))) {
+            pending &= pending - 1;
+        }
+
+        if(pending == 0) {
+            return;
+        }
+
+        const uint num = (uint)__builtin_ctz(pending);
+
+        if(runs == HX711_SHIM_MAX_IRQ_RUNS) {
+            fprintf(stderr, "shim: IRQ %u is never lowered\n", num);
+            abort();
+        }
+
+        bool handled = false;
+
+        hx711_shim__in_isr = true;
+
+        if(hx711_shim__irq_handlers[num] != NULL) {
+            hx711_shim__irq_handlers[num]();
+            handled = true;
+        }
+
+        for(uint i = 0; i < HX711_SHIM_MAX_SHARED_HANDLERS; ++i) {
+            if(hx711_shim__shared_handlers[num][i] != NULL) {
+                hx711_shim__shared_handlers[num][i]();
+                handled = true;
+            }
+        }
+
+        hx711_shim__in_isr = false;
+
+        if(!handled) {
+            fprintf(stderr, "shim: IRQ %u has no handler\n", num);
+            abort();
+        }
+
+    }
+
+}
+
+/**
+ * @brief Run every enabled state machine, in time order, up
+ * to time t, taking IRQs as they are raised.
+ */
+static void hx711_shim__run(const uint64_t t) {
+
+    hx711_shim__dispatch_irqs();
+
+    for(;;) {
+
+        hx711_shim__sm_t* first = NULL;
+        uint fp = 0;
+        uint fsm = 0;
+
+        for(uint p = 0; p < NUM_PIOS; ++p) {
+            for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+                hx711_shim__sm_t* const s = &hx711_shim__pios[p].sm[sm];
+                if(hx711_shim__sm_is_enabled(p, sm) && s->time <= t &&
+                    (first == NULL || s->time < first->time)) {
+                        first = s;
+                        fp = p;
+                        fsm = sm;
+                }
+            }
+        }
+
+        if(first == NULL) {
+            break;
+        }
+
+        //so handlers called after this step see its time
+        hx711_shim__now = hx711_shim__max(hx711_shim__now, first->time);
+
+        hx711_shim__step(fp, fsm, t);
+        hx711_shim__dispatch_irqs();
+
+    }
+
+    hx711_shim__now = hx711_shim__max(hx711_shim__now, t);
+
+}
+
+/**
+ * @brief Time of the next thing any state machine will do.
+ */
+static uint64_t hx711_shim__next_event(void) {
+    uint64_t next = HX711_SHIM_NEVER;
+    for(uint p = 0; p < NUM_PIOS; ++p) {
+        for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+            const hx711_shim__sm_t* const s = &hx711_shim__pios[p].sm[sm];
+            if(hx711_shim__sm_is_enabled(p, sm) && s->state != hx711_shim__run_fifo) {
+                next = MIN(next, s->time);
+            }
+        }
+    }
+    return next;
+}
+
+static void hx711_shim__advance(const uint64_t ns) {
+    hx711_shim__run(hx711_shim__now + ns);
+}
+
+//pico/platform.h
+
+void tight_loop_contents(void) {
+    hx711_shim__advance(HX711_SHIM_POLL_NS);
+}
+
+uint get_core_num(void) {
+    return 0;
+}
+
+//hardware/sync.h
+
+uint32_t save_and_disable_interrupts(void) {
+    const uint32_t status = hx711_shim__primask;
+    hx711_shim__primask = 1;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    hx711_shim__primask = status;
+    //anything raised while they were off is taken now
+    hx711_shim__dispatch_irqs();
+}
+
+//pico/mutex.h
+
+void mutex_init(mutex_t* mtx) {
+    mtx->initd = true;
+    mtx->owned = false;
+}
+
+void mutex_enter_blocking(mutex_t* mtx) {
+    //one thread, so a second enter is a deadlock
+    assert(mtx->initd);
+    assert(!mtx->owned);
+    mtx->owned = true;
+}
+
+void mutex_exit(mutex_t* mtx) {
+    assert(mtx->owned);
+    mtx->owned = false;
+}
+
+bool mutex_is_initialized(mutex_t* mtx) {
+    return mtx->initd;
+}
+
+//pico/time.h
+
+absolute_time_t get_absolute_time(void) {
+    return hx711_shim__now / 1000;
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+    return get_absolute_time() + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return get_absolute_time() + (uint64_t)ms * 1000;
+}
+
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+bool is_nil_time(absolute_time_t t) {
+    return t == 0;
+}
+
+bool time_reached(absolute_time_t t) {
+    hx711_shim__advance(HX711_SHIM_POLL_NS);
+    return get_absolute_time() >= t;
+}
+
+void sleep_us(uint64_t us) {
+    hx711_shim__advance(us * 1000);
+}
+
+void sleep_ms(uint32_t ms) {
+    hx711_shim__advance((uint64_t)ms * 1000000);
+}
+
+void busy_wait_us_32(uint32_t us) {
+    sleep_us(us);
+}
+
+void busy_wait_us(uint64_t us) {
+    sleep_us(us);
+}
+
+void busy_wait_ms(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)get_absolute_time();
+}
+
+uint64_t time_us_64(void) {
+    return get_absolute_time();
+}
+
+//pico/stdio.h
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+//tusb.h
+
+bool tud_cdc_connected(void) {
+    return true;
+}
+
+//hardware/clocks.h
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clk_index == clk_sys ? HX711_SHIM_SYS_HZ : UINT32_C(12000000);
+}
+
+//hardware/gpio.h
+
+void gpio_init(uint gpio) {
+    check_gpio_param(gpio);
+    hx711_shim__sio_oe &= ~(1u << gpio);
+    hx711_shim__sio_out &= ~(1u << gpio);
+    hx711_shim__gpio_func[gpio] = GPIO_FUNC_SIO;
+    hx711_shim__pins_changed(hx711_shim__now);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    check_gpio_param(gpio);
+    hx711_shim__gpio_func[gpio] = fn;
+    hx711_shim__pins_changed(hx711_shim__now);
+}
+
+enum gpio_function gpio_get_function(uint gpio) {
+    check_gpio_param(gpio);
+    return hx711_shim__gpio_func[gpio];
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    check_gpio_param(gpio);
+    if(out) {
+        hx711_shim__sio_oe |= 1u << gpio;
+    }
+    else {
+        hx711_shim__sio_oe &= ~(1u << gpio);
+    }
+    hx711_shim__pins_changed(hx711_shim__now);
+}
+
+void gpio_put(uint gpio, bool value) {
+    check_gpio_param(gpio);
+    if(value) {
+        gpio_set_mask(1u << gpio);
+    }
+    else {
+        gpio_clr_mask(1u << gpio);
+    }
+}
+
+void gpio_set_mask(uint32_t mask) {
+    hx711_shim__sio_out |= mask;
+    hx711_shim__pins_changed(hx711_shim__now);
+}
+
+void gpio_clr_mask(uint32_t mask) {
+    hx711_shim__sio_out &= ~mask;
+    hx711_shim__pins_changed(hx711_shim__now);
+}
+
+bool gpio_get(uint gpio) {
+    check_gpio_param(gpio);
+    return hx711_shim__pin_level(gpio, hx711_shim__now);
+}
+
+void gpio_set_input_enabled(uint gpio, bool enabled) {
+    check_gpio_param(gpio);
+    (void)enabled;
+}
+
+void gpio_pull_up(uint gpio) {
+    check_gpio_param(gpio);
+}
+
+void gpio_pull_down(uint gpio) {
+    check_gpio_param(gpio);
+}
+
+void gpio_disable_pulls(uint gpio) {
+    check_gpio_param(gpio);
+}
+
+//hardware/pio.h
+
+uint pio_get_index(PIO pio) {
+    check_pio_param(pio);
+    return pio == pio1 ? 1 : 0;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    check_sm_param(sm);
+    return pio_get_index(pio) * 8 + (is_tx ? 0 : 4) + sm;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio == pio1 ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+static int hx711_shim__find_offset(
+    PIO pio,
+    const pio_program_t* program) {
+
+        const hx711_shim__pio_t* const p = hx711_shim__get_pio(pio);
+        const uint32_t mask = hx711_shim__mask(program->length);
+
+        if(program->origin >= 0) {
+            return (p->used & (mask << program->origin)) == 0 ? program->origin : -1;
+        }
+
+        //the SDK fills from the top down
+        for(int offset = PIO_INSTRUCTION_COUNT - program->length; offset >= 0; --offset) {
+            if((p->used & (mask << offset)) == 0) {
+                return offset;
+            }
+        }
+
+        return -1;
+
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t* program) {
+    return hx711_shim__find_offset(pio, program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+
+    const int offset = hx711_shim__find_offset(pio, program);
+
+    if(offset < 0) {
+        fprintf(stderr, "shim: no program space\n");
+        abort();
+    }
+
+    hx711_shim__pio_t* const p = hx711_shim__get_pio(pio);
+
+    for(uint i = 0; i < program->length; ++i) {
+        uint16_t instr = program->instructions[i];
+        //jmp targets are relative to the program
+        if((instr >> 13) == 0) {
+            instr = (uint16_t)(instr + offset);
+        }
+        pio->instr_mem[offset + i] = instr;
+    }
+
+    p->used |= hx711_shim__mask(program->length) << offset;
+
+    return (uint)offset;
+
+}
+
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset) {
+    hx711_shim__get_pio(pio)->used &= ~(hx711_shim__mask(program->length) << loaded_offset);
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+    hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    assert(!s->claimed);
+    s->claimed = true;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+        if(!pio_sm_is_claimed(pio, sm)) {
+            pio_sm_claim(pio, sm);
+            return (int)sm;
+        }
+    }
+    if(required) {
+        fprintf(stderr, "shim: no free state machine\n");
+        abort();
+    }
+    return -1;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    hx711_shim__get_sm(pio, sm)->claimed = false;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm) {
+    return hx711_shim__get_sm(pio, sm)->claimed;
+}
+
+pio_sm_config pio_get_default_sm_config(void) {
+    return (pio_sm_config){
+        .clkdiv = 1.0f,
+        .wrap_target = 0,
+        .wrap = PIO_INSTRUCTION_COUNT - 1,
+        .out_count = 32,
+        .push_threshold = 32,
+        .pull_threshold = 32,
+        .in_shift_right = true,
+        .out_shift_right = true
+    };
+}
+
+void sm_config_set_wrap(pio_sm_config* c, uint wrap_target, uint wrap) {
+    c->wrap_target = wrap_target;
+    c->wrap = wrap;
+}
+
+void sm_config_set_sideset(pio_sm_config* c, uint bit_count, bool optional, bool pindirs) {
+    assert(bit_count <= 5);
+    c->sideset_bits = bit_count;
+    c->sideset_optional = optional;
+    c->sideset_pindirs = pindirs;
+}
+
+void sm_config_set_sideset_pins(pio_sm_config* c, uint sideset_base) {
+    c->sideset_base = sideset_base;
+}
+
+void sm_config_set_clkdiv(pio_sm_config* c, float div) {
+    c->clkdiv = div;
+}
+
+void sm_config_set_set_pins(pio_sm_config* c, uint set_base, uint set_count) {
+    c->set_base = set_base;
+    c->set_count = set_count;
+}
+
+void sm_config_set_out_pins(pio_sm_config* c, uint out_base, uint out_count) {
+    c->out_base = out_base;
+    c->out_count = out_count;
+}
+
+void sm_config_set_in_pins(pio_sm_config* c, uint in_base) {
+    c->in_base = in_base;
+}
+
+void sm_config_set_jmp_pin(pio_sm_config* c, uint pin) {
+    c->jmp_pin = pin;
+}
+
+void sm_config_set_in_shift(pio_sm_config* c, bool shift_right, bool autopush, uint push_threshold) {
+    c->in_shift_right = shift_right;
+    c->autopush = autopush;
+    c->push_threshold = push_threshold == 0 ? 32 : push_threshold;
+}
+
+void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = pull_threshold == 0 ? 32 : pull_threshold;
+}
+
+void sm_config_set_fifo_join(pio_sm_config* c, enum pio_fifo_join join) {
+    c->fifo_join = join;
+}
+
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config) {
+    hx711_shim__get_sm(pio, sm)->cfg = *config;
+}
+
+void pio_sm_restart(PIO pio, uint sm) {
+    hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    s->isr = 0;
+    s->isr_count = 0;
+    s->osr = 0;
+    //an empty OSR, as after reset
+    s->osr_count = 32;
+    s->irq_waiting = false;
+    s->state = hx711_shim__run_ok;
+    s->snap_valid = false;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config) {
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_set_config(pio, sm, config);
+    pio_sm_clear_fifos(pio, sm);
+    hx711_shim_pio_hw[pio_get_index(pio)].fdebug &= ~(1u << (PIO_FDEBUG_RXSTALL_LSB + sm));
+    pio_sm_restart(pio, sm);
+    hx711_shim__get_sm(pio, sm)->pc = initial_pc;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    pio_set_sm_mask_enabled(pio, 1u << sm, enabled);
+}
+
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled) {
+    for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+        if(mask & (1u << sm)) {
+            //an enabled state machine starts from now, even if
+            //it was last skipped ahead while idle
+            hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+            if(s->state == hx711_shim__run_idle) {
+                s->state = hx711_shim__run_ok;
+                s->time = hx711_shim__now;
+            }
+            s->time = hx711_shim__max(s->time, hx711_shim__now);
+            s->snap_valid = false;
+        }
+    }
+    if(enabled) {
+        pio->ctrl |= mask << PIO_CTRL_SM_ENABLE_LSB;
+    }
+    else {
+        pio->ctrl &= ~(mask << PIO_CTRL_SM_ENABLE_LSB);
+    }
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr) {
+
+    hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    const uint p = pio_get_index(pio);
+    bool jumped;
+    uint delay;
+
+    //runs now, whether or not the state machine is enabled;
+    //a stalled exec is dropped rather than latched
+    hx711_shim__wake_sm(s, hx711_shim__now);
+    s->time = hx711_shim__max(s->time, hx711_shim__now);
+    hx711_shim__exec(p, sm, (uint16_t)instr, &jumped, &delay);
+    s->state = hx711_shim__run_ok;
+
+}
+
+void pio_sm_set_out_pins(PIO pio, uint sm, uint out_base, uint out_count) {
+    sm_config_set_out_pins(&hx711_shim__get_sm(pio, sm)->cfg, out_base, out_count);
+}
+
+void pio_sm_set_set_pins(PIO pio, uint sm, uint set_base, uint set_count) {
+    sm_config_set_set_pins(&hx711_shim__get_sm(pio, sm)->cfg, set_base, set_count);
+}
+
+void pio_sm_set_in_pins(PIO pio, uint sm, uint in_base) {
+    sm_config_set_in_pins(&hx711_shim__get_sm(pio, sm)->cfg, in_base);
+}
+
+void pio_sm_set_sideset_pins(PIO pio, uint sm, uint sideset_base) {
+    sm_config_set_sideset_pins(&hx711_shim__get_sm(pio, sm)->cfg, sideset_base);
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    check_sm_param(sm);
+    hx711_shim__write_pins(
+        hx711_shim__get_pio(pio),
+        pin_base,
+        pin_count,
+        is_out ? UINT32_MAX : 0,
+        true,
+        hx711_shim__now);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask) {
+    check_sm_param(sm);
+    hx711_shim__pio_t* const p = hx711_shim__get_pio(pio);
+    const uint32_t old = p->out;
+    p->out = (p->out & ~pin_mask) | (pin_values & pin_mask);
+    if(p->out != old) {
+        hx711_shim__pins_changed(hx711_shim__now);
+    }
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) {
+    check_sm_param(sm);
+    hx711_shim__pio_t* const p = hx711_shim__get_pio(pio);
+    const uint32_t old = p->oe;
+    p->oe = (p->oe & ~pin_mask) | (pin_dirs & pin_mask);
+    if(p->oe != old) {
+        hx711_shim__pins_changed(hx711_shim__now);
+    }
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) {
+    hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    s->tx.len = 0;
+    s->rx.len = 0;
+    hx711_shim__wake_sm(s, hx711_shim__now);
+}
+
+void pio_sm_drain_tx_fifo(PIO pio, uint sm) {
+    //as the SDK does it, so the OSR ends up the same
+    const uint instr = hx711_shim__get_sm(pio, sm)->cfg.autopull
+        ? pio_encode_out(pio_null, 32)
+        : pio_encode_pull(false, false);
+    while(!pio_sm_is_tx_fifo_empty(pio, sm)) {
+        pio_sm_exec(pio, sm, instr);
+    }
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+    hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    //a put to a full FIFO is lost, as on hardware
+    hx711_shim__fifo_push(&s->tx, hx711_shim__fifo_depth(s, true), data);
+    if(s->state == hx711_shim__run_fifo) {
+        s->state = hx711_shim__run_ok;
+        s->time = hx711_shim__max(s->time, hx711_shim__now);
+    }
+    hx711_shim__wake_sm(s, hx711_shim__now);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    while(pio_sm_is_tx_fifo_full(pio, sm)) {
+        const uint64_t next = hx711_shim__next_event();
+        if(next == HX711_SHIM_NEVER) {
+            fprintf(stderr, "shim: TX FIFO will never drain\n");
+            abort();
+        }
+        hx711_shim__run(next);
+    }
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    uint32_t word = 0;
+    hx711_shim__rx_pop(hx711_shim__get_sm(pio, sm), &word);
+    return word;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    while(pio_sm_is_rx_fifo_empty(pio, sm)) {
+        const uint64_t next = hx711_shim__next_event();
+        if(next == HX711_SHIM_NEVER) {
+            fprintf(stderr, "shim: RX FIFO will never fill\n");
+            abort();
+        }
+        hx711_shim__run(next);
+    }
+    return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    return hx711_shim__get_sm(pio, sm)->rx.len == 0;
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm) {
+    const hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    return s->rx.len >= hx711_shim__fifo_depth(s, false);
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    return hx711_shim__get_sm(pio, sm)->tx.len == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    const hx711_shim__sm_t* const s = hx711_shim__get_sm(pio, sm);
+    return s->tx.len >= hx711_shim__fifo_depth(s, true);
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) {
+    return hx711_shim__get_sm(pio, sm)->rx.len;
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) {
+    return hx711_shim__get_sm(pio, sm)->tx.len;
+}
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num) {
+    assert(pio_interrupt_num < 8);
+    return (pio->irq >> pio_interrupt_num) & 1;
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num) {
+    assert(pio_interrupt_num < 8);
+    pio->irq &= ~(1u << pio_interrupt_num);
+    hx711_shim__wake(hx711_shim__now);
+}
+
+void pio_set_irqn_source_enabled(PIO pio, uint irq_index, enum pio_interrupt_source source, bool enabled) {
+    assert(irq_index < 2);
+    assert((uint)source <= pis_interrupt3);
+    uint32_t* const inte = &hx711_shim__get_pio(pio)->inte[irq_index];
+    if(enabled) {
+        *inte |= 1u << source;
+    }
+    else {
+        *inte &= ~(1u << source);
+    }
+    hx711_shim__dispatch_irqs();
+}
+
+//hardware/pio_instructions.h
+
+uint pio_encode_push(bool if_full, bool block) {
+    return 0x8000u | ((uint)if_full << 6) | ((uint)block << 5);
+}
+
+uint pio_encode_pull(bool if_empty, bool block) {
+    return 0x8080u | ((uint)if_empty << 6) | ((uint)block << 5);
+}
+
+uint pio_encode_in(enum pio_src_dest src, uint count) {
+    return 0x4000u | ((uint)src << 5) | (count & 0x1f);
+}
+
+uint pio_encode_out(enum pio_src_dest dest, uint count) {
+    return 0x6000u | ((uint)dest << 5) | (count & 0x1f);
+}
+
+uint pio_encode_set(enum pio_src_dest dest, uint value) {
+    return 0xe000u | ((uint)dest << 5) | (value & 0x1f);
+}
+
+uint pio_encode_jmp(uint addr) {
+    return addr & 0x1f;
+}
+
+//hardware/dma.h
+
+/**
+ * @brief Move whatever a busy channel can: each word waiting
+ * in the PIO RX FIFO it is paced by, or everything at once if
+ * it is unpaced. Raises its interrupt when done.
+ */
+static void hx711_shim__dma_run(const uint channel) {
+
+    hx711_shim__dma_t* const d = &hx711_shim__dmas[channel];
+    dma_channel_hw_t* const hw = &dma_hw->ch[channel];
+    const uint size = 1u << d->cfg.size;
+
+    while(d->busy && hw->transfer_count > 0) {
+
+        uint32_t word = 0;
+
+        if(d->cfg.dreq == HX711_SHIM_DREQ_FORCE) {
+            memcpy(&word, (const void*)hw->read_addr, size);
+        }
+        else if(d->cfg.dreq < NUM_PIOS * 8 && (d->cfg.dreq & 4)) {
+            const uint p = d->cfg.dreq / 8;
+            const uint sm = d->cfg.dreq % 4;
+            assert(hw->read_addr == &hx711_shim_pio_hw[p].rxf[sm]);
+            if(!hx711_shim__rx_pop(&hx711_shim__pios[p].sm[sm], &word)) {
+                break;
+            }
+        }
+        else {
+            fprintf(stderr, "shim: DMA DREQ %u is not simulated\n", d->cfg.dreq);
+            abort();
+        }
+
+        memcpy((void*)hw->write_addr, &word, size);
+
+        if(d->cfg.read_increment) {
+            hw->read_addr = (const volatile uint8_t*)hw->read_addr + size;
+        }
+
+        if(d->cfg.write_increment) {
+            hw->write_addr = (volatile uint8_t*)hw->write_addr + size;
+        }
+
+        --hw->transfer_count;
+
+    }
+
+    if(d->busy && hw->transfer_count == 0) {
+        d->busy = false;
+        if(!d->cfg.irq_quiet) {
+            hx711_shim__dma_intr |= 1u << channel;
+        }
+    }
+
+}
+
+static void hx711_shim__dma_pump(void) {
+    for(uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if(hx711_shim__dmas[ch].busy) {
+            hx711_shim__dma_run(ch);
+        }
+    }
+}
+
+static void hx711_shim__dma_trigger(const uint channel) {
+    hx711_shim__dma_t* const d = &hx711_shim__dmas[channel];
+    dma_hw->ch[channel].transfer_count = d->reload;
+    d->busy = d->cfg.enable;
+    hx711_shim__dma_run(channel);
+    hx711_shim__dispatch_irqs();
+}
+
+void dma_channel_claim(uint channel) {
+    check_dma_channel_param(channel);
+    assert(!hx711_shim__dmas[channel].claimed);
+    hx711_shim__dmas[channel].claimed = true;
+}
+
+int dma_claim_unused_channel(bool required) {
+    for(uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if(!hx711_shim__dmas[ch].claimed) {
+            dma_channel_claim(ch);
+            return (int)ch;
+        }
+    }
+    if(required) {
+        fprintf(stderr, "shim: no free DMA channel\n");
+        abort();
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    check_dma_channel_param(channel);
+    hx711_shim__dmas[channel].claimed = false;
+}
+
+bool dma_channel_is_claimed(uint channel) {
+    check_dma_channel_param(channel);
+    return hx711_shim__dmas[channel].claimed;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    check_dma_channel_param(channel);
+    return (dma_channel_config){
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = 0x3f,
+        .irq_quiet = false,
+        .enable = true
+    };
+}
+
+dma_channel_config dma_get_channel_config(uint channel) {
+    check_dma_channel_param(channel);
+    return hx711_shim__dmas[channel].cfg;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->write_increment = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->dreq = dreq;
+}
+
+void channel_config_set_irq_quiet(dma_channel_config* c, bool irq_quiet) {
+    c->irq_quiet = irq_quiet;
+}
+
+void channel_config_set_enable(dma_channel_config* c, bool enable) {
+    c->enable = enable;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr, const volatile void* read_addr, uint transfer_count, bool trigger) {
+    dma_channel_set_config(channel, config, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, trigger);
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger) {
+    check_dma_channel_param(channel);
+    hx711_shim__dmas[channel].cfg = *config;
+    if(trigger) {
+        hx711_shim__dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger) {
+    check_dma_channel_param(channel);
+    dma_hw->ch[channel].read_addr = read_addr;
+    if(trigger) {
+        hx711_shim__dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger) {
+    check_dma_channel_param(channel);
+    dma_hw->ch[channel].write_addr = write_addr;
+    if(trigger) {
+        hx711_shim__dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    check_dma_channel_param(channel);
+    //as on hardware, this is the count the next trigger loads;
+    //reads of the register give what is left
+    hx711_shim__dmas[channel].reload = trans_count;
+    if(!hx711_shim__dmas[channel].busy) {
+        dma_hw->ch[channel].transfer_count = trans_count;
+    }
+    if(trigger) {
+        hx711_shim__dma_trigger(channel);
+    }
+}
+
+void dma_channel_start(uint channel) {
+    check_dma_channel_param(channel);
+    hx711_shim__dma_trigger(channel);
+}
+
+void dma_channel_abort(uint channel) {
+    check_dma_channel_param(channel);
+    hx711_shim__dmas[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    check_dma_channel_param(channel);
+    return hx711_shim__dmas[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while(dma_channel_is_busy(channel)) {
+        const uint64_t next = hx711_shim__next_event();
+        if(next == HX711_SHIM_NEVER) {
+            fprintf(stderr, "shim: DMA channel %u will never finish\n", channel);
+            abort();
+        }
+        hx711_shim__run(next);
+    }
+}
+
+void dma_irqn_set_channel_enabled(uint irq_index, uint channel, bool enabled) {
+    assert(irq_index < 2);
+    check_dma_channel_param(channel);
+    if(enabled) {
+        hx711_shim__dma_inte[irq_index] |= 1u << channel;
+    }
+    else {
+        hx711_shim__dma_inte[irq_index] &= ~(1u << channel);
+    }
+    hx711_shim__dispatch_irqs();
+}
+
+bool dma_irqn_get_channel_status(uint irq_index, uint channel) {
+    assert(irq_index < 2);
+    check_dma_channel_param(channel);
+    return ((hx711_shim__dma_intr & hx711_shim__dma_inte[irq_index]) >> channel) & 1;
+}
+
+void dma_irqn_acknowledge_channel(uint irq_index, uint channel) {
+    assert(irq_index < 2);
+    check_dma_channel_param(channel);
+    hx711_shim__dma_intr &= ~(1u << channel);
+}
+
+//hardware/irq.h
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    check_irq_param(num);
+    assert(hx711_shim__irq_handlers[num] == NULL ||
+        hx711_shim__irq_handlers[num] == handler);
+    hx711_shim__irq_handlers[num] = handler;
+}
+
+irq_handler_t irq_get_exclusive_handler(uint num) {
+    check_irq_param(num);
+    return hx711_shim__irq_handlers[num];
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    check_irq_param(num);
+    assert(hx711_shim__irq_handlers[num] == NULL);
+    (void)order_priority;
+    for(uint i = 0; i < HX711_SHIM_MAX_SHARED_HANDLERS; ++i) {
+        if(hx711_shim__shared_handlers[num][i] == NULL) {
+            hx711_shim__shared_handlers[num][i] = handler;
+            return;
+        }
+    }
+    fprintf(stderr, "shim: no room for another shared handler on IRQ %u\n", num);
+    abort();
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    check_irq_param(num);
+    if(hx711_shim__irq_handlers[num] == handler) {
+        hx711_shim__irq_handlers[num] = NULL;
+    }
+    for(uint i = 0; i < HX711_SHIM_MAX_SHARED_HANDLERS; ++i) {
+        if(hx711_shim__shared_handlers[num][i] == handler) {
+            hx711_shim__shared_handlers[num][i] = NULL;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    check_irq_param(num);
+    if(enabled) {
+        hx711_shim__irq_enabled |= 1u << num;
+    }
+    else {
+        hx711_shim__irq_enabled &= ~(1u << num);
+    }
+    hx711_shim__dispatch_irqs();
+}
+
+bool irq_is_enabled(uint num) {
+    check_irq_param(num);
+    return (hx711_shim__irq_enabled >> num) & 1;
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+    check_irq_param(num);
+    (void)hardware_priority;
+}
+
+void irq_clear(uint num) {
+    check_irq_param(num);
+}
+
+//shim control
+
+void hx711_shim_attach(
+    hx711_model_t* const m,
+    const uint clock_pin,
+    const uint data_pin) {
+
+        assert(m != NULL);
+        check_gpio_param(clock_pin);
+        check_gpio_param(data_pin);
+        assert(hx711_shim__chip_count < HX711_SHIM_MAX_MODELS);
+        assert(hx711_shim__chip_on_data_pin(data_pin) == NULL);
+
+        hx711_shim__chips[hx711_shim__chip_count] = (hx711_shim__chip_t){
+            .m = m,
+            .clock_pin = clock_pin,
+            .data_pin = data_pin,
+            .time = 0
+        };
+
+        hx711_shim__data_pin_chips[data_pin] = &hx711_shim__chips[hx711_shim__chip_count++];
+
+        hx711_shim__pins_changed(hx711_shim__now);
+
+}
+
+uint64_t hx711_shim_get_time_ns(void) {
+    return hx711_shim__now;
+}
+
+bool hx711_shim_get_pin(const uint gpio) {
+    check_gpio_param(gpio);
+    return hx711_shim__pin_level(gpio, hx711_shim__now);
+}
+
+void hx711_shim_sync_models(void) {
+    for(uint i = 0; i < hx711_shim__chip_count; ++i) {
+        hx711_shim__chip_advance(&hx711_shim__chips[i], hx711_shim__now);
+    }
+}
@@ -0,0 +1,548 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host stand-in for the parts of the Pico SDK the library
+ * uses, so src/hx711.c, src/hx711_multi.c and src/util.c can
+ * be built and run on a PC against hx711_model_t chips (see
+ * tools/hx711_check.c, tools/hx711_model_sim.c and
+ * tests/profile.c). PICO_ON_DEVICE is 0, as in the SDK's own
+ * host builds.
+ * 
+ * The headers under tools/shim/ have the SDK's names and all
+ * include this one; put tools/shim first on the include path.
+ * 
+ * - GPIOs are muxed as on the RP2040: a pin follows SIO
+ *   (gpio_put) or the PIO it was handed to with
+ *   pio_gpio_init, never both
+ * 
+ * - PIO state machines run their programs instruction by
+ *   instruction from instr_mem, with side-set, delays, FIFOs,
+ *   autopush, IRQ flags between state machines and the clock
+ *   divider, clocking attached models through the pins they
+ *   drive. A state machine which goes round its wrap loop
+ *   without changing anything (eg. hx711_multi_awaiter.pio
+ *   polling data pins which are all high) is skipped ahead to
+ *   the next conversion, or until a pin, IRQ flag or FIFO it
+ *   could see changes
+ * 
+ * - DMA channels paced by a PIO RX FIFO move each word as it
+ *   is pushed, and unpaced ones move everything when
+ *   triggered; other DREQs abort
+ * 
+ * - PIO and DMA IRQs are level sensitive, as on the RP2040.
+ *   Their exclusive or shared handlers are called as soon as
+ *   an enabled source is raised, unless interrupts are off
+ *   (save_and_disable_interrupts) or a handler is already
+ *   running
+ * 
+ * - time is simulated and only moves when the code waits:
+ *   sleeps, blocking FIFO reads, time_reached and
+ *   tight_loop_contents. Handlers take no time
+ * 
+ * - register structs are plain memory; writes to them (eg.
+ *   write-1-to-clear of FDEBUG) have no side effects, and
+ *   SysTick does not count, so util_cycle_counter_elapsed
+ *   is always 0
+ * 
+ * - stdio_init_all and tud_cdc_connected succeed at once;
+ *   printf goes to the host's stdout
+ */
+
+#ifndef HX711_SHIM_H_91EA5D36_B69B_49F6_B89A_6D033C25B7BB
+#define HX711_SHIM_H_91EA5D36_B69B_49F6_B89A_6D033C25B7BB
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hx711_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+//pico/platform.h
+
+#define PICO_ON_DEVICE                  0
+
+#define NUM_CORES                       2u
+#define NUM_PIOS                        2u
+#define NUM_PIO_STATE_MACHINES          4u
+#define PIO_INSTRUCTION_COUNT           32u
+#define NUM_DMA_CHANNELS                12u
+#define NUM_BANK0_GPIOS                 30u
+#define NUM_IRQS                        32u
+
+#define __not_in_flash_func(func_name)  func_name
+#define __isr
+#define __force_inline                  inline __attribute__((always_inline))
+
+#define count_of(a)                     (sizeof(a) / sizeof((a)[0]))
+
+#ifndef MIN
+    #define MIN(a, b)                   ((b) < (a) ? (b) : (a))
+#endif
+
+#ifndef MAX
+    #define MAX(a, b)                   ((a) < (b) ? (b) : (a))
+#endif
+
+#define check_gpio_param(gpio)          assert((gpio) < NUM_BANK0_GPIOS)
+#define check_sm_param(sm)              assert((sm) < NUM_PIO_STATE_MACHINES)
+#define check_pio_param(pio)            assert((pio) == pio0 || (pio) == pio1)
+#define check_irq_param(num)            assert((num) < NUM_IRQS)
+#define check_dma_channel_param(ch)     assert((ch) < NUM_DMA_CHANNELS)
+
+/**
+ * @brief Moves simulated time on by HX711_SHIM_POLL_NS so
+ * polling loops end.
+ */
+void tight_loop_contents(void);
+
+uint get_core_num(void);
+
+#define __compiler_memory_barrier()     do { } while(0)
+#define __dmb()                         do { } while(0)
+
+//hardware/regs
+
+enum {
+    PIO0_IRQ_0 = 7,
+    PIO0_IRQ_1 = 8,
+    PIO1_IRQ_0 = 9,
+    PIO1_IRQ_1 = 10,
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12
+};
+
+#define PIO_CTRL_SM_ENABLE_LSB          0u
+#define PIO_FDEBUG_RXSTALL_LSB          0u
+
+#define M0PLUS_SYST_CSR_ENABLE_BITS     0x00000001u
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS  0x00000004u
+#define M0PLUS_SYST_RVR_BITS            0x00ffffffu
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t* const systick_hw;
+
+//hardware/sync.h
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+//pico/mutex.h
+
+typedef struct {
+    bool initd;
+    bool owned;
+} mutex_t;
+
+void mutex_init(mutex_t* mtx);
+void mutex_enter_blocking(mutex_t* mtx);
+void mutex_exit(mutex_t* mtx);
+bool mutex_is_initialized(mutex_t* mtx);
+
+//pico/time.h
+
+/**
+ * @brief Simulated time between polls by time_reached and
+ * tight_loop_contents.
+ */
+#define HX711_SHIM_POLL_NS              UINT64_C(1000)
+
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us);
+uint64_t to_us_since_boot(absolute_time_t t);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+bool is_nil_time(absolute_time_t t);
+
+/**
+ * @brief Moves simulated time on by HX711_SHIM_POLL_NS, then
+ * checks it against t.
+ */
+bool time_reached(absolute_time_t t);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us_32(uint32_t us);
+void busy_wait_us(uint64_t us);
+void busy_wait_ms(uint32_t ms);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+//pico/stdio.h
+
+bool stdio_init_all(void);
+
+//tusb.h
+
+bool tud_cdc_connected(void);
+
+//hardware/clocks.h
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc
+};
+
+/**
+ * @brief 125MHz for clk_sys, the SDK default.
+ */
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+//hardware/gpio.h
+
+enum gpio_function {
+    GPIO_FUNC_XIP = 0,
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8,
+    GPIO_FUNC_USB = 9,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+#define GPIO_OUT                        1
+#define GPIO_IN                         0
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+enum gpio_function gpio_get_function(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+void gpio_set_mask(uint32_t mask);
+void gpio_clr_mask(uint32_t mask);
+bool gpio_get(uint gpio);
+void gpio_set_input_enabled(uint gpio, bool enabled);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+
+//hardware/pio.h
+
+typedef struct {
+    volatile uint32_t ctrl;
+    volatile uint32_t fstat;
+    volatile uint32_t fdebug;
+    volatile uint32_t flevel;
+    volatile uint32_t irq;
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t instr_mem[PIO_INSTRUCTION_COUNT];
+} pio_hw_t;
+
+typedef pio_hw_t* PIO;
+
+extern pio_hw_t hx711_shim_pio_hw[NUM_PIOS];
+
+#define pio0                            (&hx711_shim_pio_hw[0])
+#define pio1                            (&hx711_shim_pio_hw[1])
+
+typedef struct pio_program {
+    const uint16_t* instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2
+};
+
+enum pio_interrupt_source {
+    pis_sm0_rx_fifo_not_empty = 0,
+    pis_sm1_rx_fifo_not_empty,
+    pis_sm2_rx_fifo_not_empty,
+    pis_sm3_rx_fifo_not_empty,
+    pis_sm0_tx_fifo_not_full,
+    pis_sm1_tx_fifo_not_full,
+    pis_sm2_tx_fifo_not_full,
+    pis_sm3_tx_fifo_not_full,
+    pis_interrupt0,
+    pis_interrupt1,
+    pis_interrupt2,
+    pis_interrupt3
+};
+
+enum pio_src_dest {
+    pio_pins = 0,
+    pio_x = 1,
+    pio_y = 2,
+    pio_null = 3,
+    pio_pindirs = 4,
+    pio_exec_mov = 4,
+    pio_status = 5,
+    pio_pc = 5,
+    pio_isr = 6,
+    pio_osr = 7,
+    pio_exec_out = 7
+};
+
+typedef struct {
+    float clkdiv;
+    uint wrap_target;
+    uint wrap;
+    uint sideset_bits;
+    bool sideset_optional;
+    bool sideset_pindirs;
+    uint sideset_base;
+    uint set_base;
+    uint set_count;
+    uint out_base;
+    uint out_count;
+    uint in_base;
+    uint jmp_pin;
+    bool in_shift_right;
+    bool autopush;
+    uint push_threshold;
+    bool out_shift_right;
+    bool autopull;
+    uint pull_threshold;
+    enum pio_fifo_join fifo_join;
+} pio_sm_config;
+
+uint pio_get_index(PIO pio);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+void pio_gpio_init(PIO pio, uint pin);
+
+uint pio_add_program(PIO pio, const pio_program_t* program);
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset);
+bool pio_can_add_program(PIO pio, const pio_program_t* program);
+
+void pio_sm_claim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_wrap(pio_sm_config* c, uint wrap_target, uint wrap);
+void sm_config_set_sideset(pio_sm_config* c, uint bit_count, bool optional, bool pindirs);
+void sm_config_set_sideset_pins(pio_sm_config* c, uint sideset_base);
+void sm_config_set_clkdiv(pio_sm_config* c, float div);
+void sm_config_set_set_pins(pio_sm_config* c, uint set_base, uint set_count);
+void sm_config_set_out_pins(pio_sm_config* c, uint out_base, uint out_count);
+void sm_config_set_in_pins(pio_sm_config* c, uint in_base);
+void sm_config_set_jmp_pin(pio_sm_config* c, uint pin);
+void sm_config_set_in_shift(pio_sm_config* c, bool shift_right, bool autopush, uint push_threshold);
+void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config* c, enum pio_fifo_join join);
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+
+void pio_sm_set_out_pins(PIO pio, uint sm, uint out_base, uint out_count);
+void pio_sm_set_set_pins(PIO pio, uint sm, uint set_base, uint set_count);
+void pio_sm_set_in_pins(PIO pio, uint sm, uint in_base);
+void pio_sm_set_sideset_pins(PIO pio, uint sm, uint sideset_base);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_drain_tx_fifo(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+
+/**
+ * @brief Runs the simulation until a word arrives; aborts if
+ * none ever can (eg. every chip is powered down).
+ */
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
+void pio_set_irqn_source_enabled(PIO pio, uint irq_index, enum pio_interrupt_source source, bool enabled);
+
+//hardware/pio_instructions.h
+
+uint pio_encode_push(bool if_full, bool block);
+uint pio_encode_pull(bool if_empty, bool block);
+uint pio_encode_in(enum pio_src_dest src, uint count);
+uint pio_encode_out(enum pio_src_dest dest, uint count);
+uint pio_encode_set(enum pio_src_dest dest, uint value);
+uint pio_encode_jmp(uint addr);
+
+//hardware/dma.h
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct {
+    volatile const void* read_addr;
+    volatile void* write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+} dma_hw_t;
+
+extern dma_hw_t* const dma_hw;
+
+typedef struct {
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    bool irq_quiet;
+    bool enable;
+} dma_channel_config;
+
+void dma_channel_claim(uint channel);
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+bool dma_channel_is_claimed(uint channel);
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+dma_channel_config dma_get_channel_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config* c, bool incr);
+void channel_config_set_write_increment(dma_channel_config* c, bool incr);
+void channel_config_set_dreq(dma_channel_config* c, uint dreq);
+void channel_config_set_irq_quiet(dma_channel_config* c, bool irq_quiet);
+void channel_config_set_enable(dma_channel_config* c, bool enable);
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr, const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+void dma_irqn_set_channel_enabled(uint irq_index, uint channel, bool enabled);
+bool dma_irqn_get_channel_status(uint irq_index, uint channel);
+void dma_irqn_acknowledge_channel(uint irq_index, uint channel);
+
+//hardware/irq.h
+
+typedef void (*irq_handler_t)(void);
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+/**
+ * @brief Most shared handlers on one IRQ.
+ */
+#define HX711_SHIM_MAX_SHARED_HANDLERS  4u
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+irq_handler_t irq_get_exclusive_handler(uint num);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+void irq_clear(uint num);
+
+//shim control
+
+/**
+ * @brief Most models which can be attached.
+ */
+#define HX711_SHIM_MAX_MODELS           32u
+
+/**
+ * @brief Wire a model to a pair of GPIOs: its PD_SCK follows
+ * clock_pin and its DOUT drives data_pin. The model's time 0
+ * is the shim's time 0.
+ * 
+ * @param m 
+ * @param clock_pin 
+ * @param data_pin 
+ */
+void hx711_shim_attach(
+    hx711_model_t* const m,
+    const uint clock_pin,
+    const uint data_pin);
+
+/**
+ * @brief Simulated time since start up.
+ * 
+ * @return uint64_t nanoseconds
+ */
+uint64_t hx711_shim_get_time_ns(void);
+
+/**
+ * @brief Level of a pin as the attached models see it.
+ * 
+ * @param gpio 
+ * @return true 
+ * @return false 
+ */
+bool hx711_shim_get_pin(const uint gpio);
+
+/**
+ * @brief Bring every attached model up to the current time.
+ * Models are otherwise only advanced when a pin they are wired
+ * to is touched, so call this before inspecting one.
+ */
+void hx711_shim_sync_models(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side decoder for the binary sample stream written by
+ * hx711_stream_t. It reads frames from a file, or a serial
+ * port (set it to raw mode first, eg. stty -F /dev/ttyACM0
+ * raw), and prints one line per frame: sequence number,
+ * timestamp and each value. Frames which fail their CRC and
+ * gaps in the sequence numbers are counted and reported at
+ * the end.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_stream_decode tools/hx711_stream_decode.c \
+ *      src/hx711_stream.c src/hx711_crc.c
+ * 
+ * Usage:
+ *  hx711_stream_decode [file]
+ * 
+ * Reads stdin if no file is given.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "../include/hx711_stream.h"
+
+int main(int argc, char** argv) {
+
+    FILE* const fp = argc > 1 ? fopen(argv[1], "rb") : stdin;
+
+    if(fp == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    uint8_t buf[HX711_STREAM_ENCODED_MAX(HX711_STREAM_MAX_CHIPS)];
+    size_t len = 0;
+    bool overflow = false;
+    bool first = true;
+    uint32_t expected = 0;
+    unsigned long frames = 0;
+    unsigned long bad = 0;
+    unsigned long lost = 0;
+    int c;
+
+    while((c = fgetc(fp)) != EOF) {
+
+        if(c != 0) {
+            //an over-long run can't be a frame; drop it and
+            //wait for the next delimiter
+            if(len < sizeof(buf)) {
+                buf[len++] = (uint8_t)c;
+            }
+            else {
+                overflow = true;
+            }
+            continue;
+        }
+
+        if(len == 0) {
+            continue;
+        }
+
+        uint32_t seq;
+        uint32_t timestamp;
+        int32_t values[HX711_STREAM_MAX_CHIPS];
+        size_t values_len;
+
+        if(overflow || !hx711_stream_decode(buf, len, &seq, &timestamp, values, &values_len)) {
+            ++bad;
+        }
+        else {
+
+            if(!first && seq != expected) {
+                lost += seq - expected;
+            }
+
+            first = false;
+            expected = seq + 1;
+            ++frames;
+
+            printf("%" PRIu32 " %" PRIu32, seq, timestamp);
+            for(size_t i = 0; i < values_len; ++i) {
+                printf(" %" PRId32, values[i]);
+            }
+            putchar('\n');
+
+        }
+
+        len = 0;
+        overflow = false;
+
+    }
+
+    fprintf(stderr, "%lu frames, %lu bad, %lu lost\n", frames, bad, lost);
+
+    if(fp != stdin) {
+        fclose(fp);
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,179 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side decoder for hx711_trace_record_t dumps.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -o hx711_trace_decode tools/hx711_trace_decode.c
+ * 
+ * Usage:
+ *  hx711_trace_decode [-g gap_us] [file]
+ * 
+ * Reads a raw dump of records (as copied out by hx711_trace_dump)
+ * from file, or stdin if no file is given, and prints a timeline.
+ * An async read which is started again before its DMA IRQ has
+ * been seen, or a gap of more than gap_us between consecutive
+ * records of the same instance, is marked as a stall.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/hx711_trace.h"
+
+#define INSTANCES 256
+
+#define EVENT_NAME(name, value) [value] = #name,
+
+static const char* const event_names[] = {
+    HX711_TRACE_EVENTS(EVENT_NAME)
+};
+
+#undef EVENT_NAME
+
+typedef struct {
+    bool seen;
+    bool waiting;
+    uint32_t last;
+    uint32_t start;
+} instance_state_t;
+
+static uint32_t read_le32(const uint8_t* const b) {
+    return (uint32_t)b[0] |
+        (uint32_t)b[1] << 8 |
+        (uint32_t)b[2] << 16 |
+        (uint32_t)b[3] << 24;
+}
+
+static const char* event_name(const uint8_t event) {
+    if(event < HX711_TRACE_EVENT_COUNT && event_names[event] != NULL) {
+        return event_names[event];
+    }
+    return "UNKNOWN";
+}
+
+int main(int argc, char** argv) {
+
+    uint32_t gap = 0;
+    const char* path = NULL;
+
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            gap = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else {
+            path = argv[i];
+        }
+    }
+
+    FILE* const in = path == NULL ? stdin : fopen(path, "rb");
+
+    if(in == NULL) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    static instance_state_t instances[INSTANCES];
+    uint8_t buf[sizeof(hx711_trace_record_t)];
+    bool first = true;
+    uint32_t origin = 0;
+    uint32_t prev = 0;
+    unsigned long stalls = 0;
+
+    printf("%12s %10s %4s %3s %-12s %6s\n",
+        "time_us", "delta_us", "pio", "sm", "event", "arg");
+
+    while(fread(buf, sizeof(buf), 1, in) == 1) {
+
+        const uint32_t ts = read_le32(&buf[0]);
+        const uint8_t event = buf[4];
+        const uint8_t inst = buf[5];
+        const uint16_t arg = (uint16_t)(buf[6] | buf[7] << 8);
+
+        if(first) {
+            origin = ts;
+            prev = ts;
+            first = false;
+        }
+
+        //unsigned subtraction handles the timer wrapping
+        printf("%12" PRIu32 " %10" PRIu32 " %4u %3u %-12s %6u",
+            ts - origin,
+            ts - prev,
+            inst >> 2,
+            inst & 3,
+            event_name(event),
+            arg);
+
+        instance_state_t* const st = &instances[inst];
+
+        if(gap > 0 && st->seen && ts - st->last > gap) {
+            printf("  <- stall: %" PRIu32 "us since previous event",
+                ts - st->last);
+            ++stalls;
+        }
+
+        switch(event) {
+            case HX711_TRACE_EVENT_ASYNC_START:
+                if(st->waiting) {
+                    printf("  <- stall: previous read started %" PRIu32 "us ago never completed",
+                        ts - st->start);
+                    ++stalls;
+                }
+                st->waiting = true;
+                st->start = ts;
+                break;
+            case HX711_TRACE_EVENT_DMA_IRQ:
+                if(st->waiting) {
+                    printf("  (read took %" PRIu32 "us)", ts - st->start);
+                }
+                st->waiting = false;
+                break;
+            case HX711_TRACE_EVENT_TIMEOUT:
+            case HX711_TRACE_EVENT_POWER_DOWN:
+                st->waiting = false;
+                break;
+            default:
+                break;
+        }
+
+        putchar('\n');
+
+        st->seen = true;
+        st->last = ts;
+        prev = ts;
+
+    }
+
+    if(in != stdin) {
+        fclose(in);
+    }
+
+    printf("%lu stall(s)\n", stalls);
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,178 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Host-side exhaustive check of the 24 bit two's complement
+ * conversion. HX711_SIGN_EXTEND and hx711_decode_twos_comp_batch
+ * (the bodies of hx711_get_twos_comp and
+ * hx711_get_twos_comp_batch) are compared with the mask, negate
+ * and add expression they replaced for every one of the 2^24
+ * values the HX711 can send. Any difference is an error.
+ * 
+ * The old expression masked with +HX711_MIN_VALUE, which as a
+ * uint32_t is 0xFF800000, so bits above the 24th were treated as
+ * sign bits and changed the result. The new conversion ignores
+ * them. The PIO programs never set those bits, so this is not a
+ * change for values read from a chip, but -a also walks all 2^32
+ * inputs and reports how many differ because of the upper bits,
+ * and checks that each of those matches the 24 bit value.
+ * 
+ * Build:
+ *  cc -std=c11 -O2 -Iinclude -o hx711_twos_comp_check tools/hx711_twos_comp_check.c
+ * 
+ * Usage:
+ *  hx711_twos_comp_check [-a]
+ * 
+ *  -a  also check every 32 bit input
+ * 
+ * Exits with 0 if every check passes.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/hx711_decode.h"
+
+#define MIN_VALUE INT32_C(-0x800000)
+#define MAX_VALUE INT32_C(0x7fffff)
+#define BATCH_LEN 4096u
+
+/**
+ * @brief The conversion as it was before HX711_SIGN_EXTEND.
+ * Kept out of line so the compiler cannot fold it into the new
+ * form.
+ */
+static __attribute__((noinline)) int32_t old_twos_comp(const uint32_t raw) {
+    return
+        (int32_t)(-(raw & +MIN_VALUE)) + 
+        (int32_t)(raw & MAX_VALUE);
+}
+
+static __attribute__((noinline)) int32_t new_twos_comp(const uint32_t raw) {
+    return HX711_SIGN_EXTEND(raw);
+}
+
+static bool check_24(void) {
+
+    static uint32_t raw[BATCH_LEN];
+    static int32_t out[BATCH_LEN];
+    static int32_t inPlace[BATCH_LEN];
+
+    uint32_t failed = 0;
+
+    for(uint32_t base = 0; base < (UINT32_C(1) << HX711_DECODE_BITS); base += BATCH_LEN) {
+
+        for(uint32_t i = 0; i < BATCH_LEN; ++i) {
+            raw[i] = base + i;
+        }
+
+        hx711_decode_twos_comp_batch(raw, out, BATCH_LEN);
+
+        //the batch function documents in-place conversion
+        memcpy(inPlace, raw, sizeof(raw));
+        hx711_decode_twos_comp_batch((const uint32_t*)inPlace, inPlace, BATCH_LEN);
+
+        for(uint32_t i = 0; i < BATCH_LEN; ++i) {
+
+            const int32_t expected = old_twos_comp(raw[i]);
+            const int32_t single = new_twos_comp(raw[i]);
+
+            if(single != expected || out[i] != expected || inPlace[i] != expected ||
+                expected < MIN_VALUE || expected > MAX_VALUE) {
+                    if(failed++ < 10) {
+                        printf(
+                            "FAIL 0x%06" PRIX32 ": old %" PRId32 " new %" PRId32
+                            " batch %" PRId32 " in place %" PRId32 "\n",
+                            raw[i], expected, single, out[i], inPlace[i]);
+                    }
+            }
+
+        }
+
+    }
+
+    printf("24 bit inputs: %s (%" PRIu32 " differ)\n", failed == 0 ? "pass" : "FAIL", failed);
+
+    return failed == 0;
+
+}
+
+static bool check_32(void) {
+
+    uint64_t differ = 0;
+    uint64_t failed = 0;
+    uint32_t raw = 0;
+
+    do {
+
+        const int32_t val = new_twos_comp(raw);
+
+        //upper bits must not change the result
+        if(val != new_twos_comp(raw & UINT32_C(0xFFFFFF))) {
+            if(failed++ < 10) {
+                printf("FAIL 0x%08" PRIX32 ": new %" PRId32 "\n", raw, val);
+            }
+        }
+
+        if(val != old_twos_comp(raw)) {
+            if(differ == 0) {
+                printf(
+                    "first upper bit difference 0x%08" PRIX32 ": old %" PRId32
+                    " new %" PRId32 "\n",
+                    raw, old_twos_comp(raw), val);
+            }
+            ++differ;
+        }
+
+    } while(++raw != 0);
+
+    printf(
+        "32 bit inputs: %s (%" PRIu64 " differ from the old conversion, all with bits above the 24th set)\n",
+        failed == 0 ? "pass" : "FAIL",
+        differ);
+
+    return failed == 0;
+
+}
+
+int main(int argc, char** argv) {
+
+    const bool all = argc > 1 && strcmp(argv[1], "-a") == 0;
+
+    if(argc > 2 || (argc == 2 && !all)) {
+        fprintf(stderr, "usage: %s [-a]\n", argv[0]);
+        return 2;
+    }
+
+    bool ok = check_24();
+
+    if(all) {
+        ok = check_32() && ok;
+    }
+
+    return ok ? 0 : 1;
+
+}
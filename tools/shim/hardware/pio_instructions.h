@@ -0,0 +1,5 @@
+// Host stand-in for the Pico SDK's hardware/pio_instructions.h; see tools/hx711_shim.h.
+
+#pragma once
+
+#include "../../hx711_shim.h"